@@ -0,0 +1,279 @@
+// Interleaved top-down iterative merge sort:  runs several independent
+// tdi2_merge_sort-style sorts in lockstep, to keep several cache misses in
+// flight at once.
+//
+// Author:  agent <agent@local>
+// Based on tdi2_merge_sort.c by Drew Eckhardt and Joe Zbiciak.
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#include "ami1_merge_sort.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "list_instrument.h"
+
+// Lists get at most one segment per this many nodes.  Shorter segments spend
+// more time switching between state machines than waiting on memory.
+#define MIN_SEGMENT (64)
+
+static int ami1_width = 16;
+
+// Sets the group width ami1_merge_sort uses.
+void ami1_merge_sort_set_width(const int width) {
+  ami1_width = width < 1 ? 1
+             : width > AMI1_MAX_WIDTH ? AMI1_MAX_WIDTH : width;
+}
+
+// The states of one segment's sort.  These follow the loops in
+// tdi2_merge_sort.  Only the states that touch a node end a step; the others
+// fall through to the next state right away.
+typedef enum {
+  SORT_PASS,     // Start the next pass over the segment, if it needs one.
+  SORT_PAIR,     // Start the next pair of sub-lists in this pass.
+  SORT_FIND_B,   // Walk across 'a' to find the start of 'b'.
+  SORT_MERGE,    // Merge 'b' into 'a'.
+  SORT_DRAIN_A,  // Push the remaining 'a' nodes.
+  SORT_DRAIN_B,  // Push the remaining 'b' nodes.
+  SORT_DONE      // The sorted segment is in 'rest'.
+} SortState;
+
+// The state of one segment's sort.  The fields other than 'state' and 'size'
+// are tdi2_merge_sort's local variables.
+typedef struct {
+  SortState state;
+  size_t size, increment;
+  ListNode *rest, *out_head, **out_tail;
+  ListNode *a, *b;
+  size_t ar, br, i;
+} SortLane;
+
+// The state of one merge of two sorted segments.
+typedef struct {
+  ListNode *a, *b;
+  ListNode *out_head, **out_tail;
+} MergeLane;
+
+// Takes the node at the head of 'src', appends it to the output, and
+// prefetches the node after it.
+static inline void take_node(ListNode **const src, ListNode ***const out_tail) {
+  ListNode *const node = *src;
+  **out_tail = node;
+  *out_tail = &node->next;
+  *src = node->next;
+  __builtin_prefetch(*src);
+  LIST_COUNT_LINK();
+  LIST_COUNT_VISIT();
+}
+
+// Advances a segment's sort by one node.  Returns false once the segment is
+// sorted.
+static inline bool sort_step(SortLane *const l,
+                             ListNodeCompareFxn *const cmp) {
+  for (;;) {
+    switch (l->state) {
+      case SORT_PASS:
+        if (l->increment >= l->size) {
+          l->state = SORT_DONE;
+          return false;
+        }
+        l->out_head = NULL;
+        l->out_tail = &l->out_head;
+        l->state = SORT_PAIR;
+        break;
+
+      case SORT_PAIR:
+        // End of the pass?  Start the next one.
+        if (!l->rest) {
+          l->increment *= 2;
+          l->rest = l->out_head;
+          l->state = SORT_PASS;
+          break;
+        }
+        l->a = l->b = l->rest;
+        l->ar = l->br = l->increment;
+        l->i = 0;
+        l->state = SORT_FIND_B;
+        break;
+
+      case SORT_FIND_B:
+        if (l->i < l->increment && l->b) {
+          l->b = l->b->next;
+          l->i++;
+          __builtin_prefetch(l->b);
+          LIST_COUNT_VISIT();
+          return true;
+        }
+        // If 'a' was shorter than increment, just append it.  That ends the
+        // pass.
+        if (!l->b) {
+          *l->out_tail = l->a;
+          l->rest = NULL;
+          LIST_COUNT_LINK();
+          l->state = SORT_PAIR;
+          break;
+        }
+        l->state = SORT_MERGE;
+        break;
+
+      case SORT_MERGE:
+        if (l->ar && l->br && l->b) {
+          if (cmp(l->a, l->b)) {
+            --l->ar;
+            take_node(&l->a, &l->out_tail);
+          } else {
+            --l->br;
+            take_node(&l->b, &l->out_tail);
+          }
+          return true;
+        }
+        l->state = SORT_DRAIN_A;
+        break;
+
+      case SORT_DRAIN_A:
+        if (l->ar) {
+          --l->ar;
+          take_node(&l->a, &l->out_tail);
+          return true;
+        }
+        l->state = SORT_DRAIN_B;
+        break;
+
+      case SORT_DRAIN_B:
+        // 'b' can end early.
+        if (l->br && l->b) {
+          --l->br;
+          take_node(&l->b, &l->out_tail);
+          return true;
+        }
+        // Terminate our partial list.  The final advance on 'b' left it
+        // pointing to the rest of the pass.
+        *l->out_tail = NULL;
+        l->rest = l->b;
+        LIST_COUNT_LINK();
+        l->state = SORT_PAIR;
+        break;
+
+      case SORT_DONE:
+        return false;
+    }
+  }
+}
+
+// Advances a merge by one node.  Returns false once the merge is done.
+static inline bool merge_step(MergeLane *const m,
+                              ListNodeCompareFxn *const cmp) {
+  if (m->a && m->b) {
+    take_node(cmp(m->a, m->b) ? &m->a : &m->b, &m->out_tail);
+    return true;
+  }
+
+  // Once we exhaust one list, append the other as-is to the merged list.
+  *m->out_tail = m->a ? m->a : m->b;
+  LIST_COUNT_LINK();
+  return false;
+}
+
+// Implements an interleaved merge sort on a singly linked list.  See the
+// header for details.
+ListNode *ami1_merge_sort_width(ListNode *const first,
+                                ListNodeCompareFxn *const cmp,
+                                int width) {
+  // Handle degenerate cases of an empty list or a single-node list.
+  if (!first || !LIST_VISIT_NEXT(first)) {
+    return first;
+  }
+
+  // Scan once to find our size, and pick the number of segments.
+  size_t size = 0;
+  for (ListNode *n = first; n; n = n->next) {
+    size++;
+    LIST_COUNT_VISIT();
+  }
+
+  width = width < 1 ? 1 : width > AMI1_MAX_WIDTH ? AMI1_MAX_WIDTH : width;
+  const size_t max_width = size / MIN_SEGMENT;
+  if ((size_t)width > max_width) {
+    width = max_width ? (int)max_width : 1;
+  }
+
+  // Cut the list into segments of nearly equal size.
+  SortLane sort_lane[AMI1_MAX_WIDTH];
+  int live[AMI1_MAX_WIDTH];
+  ListNode *node = first;
+  for (int w = 0; w < width; ++w) {
+    SortLane *const l = &sort_lane[w];
+    l->state = SORT_PASS;
+    l->size = size / width + ((size_t)w < size % width);
+    l->increment = 1;
+    l->rest = node;
+    for (size_t i = 1; i < l->size; ++i) {
+      node = node->next;
+      LIST_COUNT_VISIT();
+    }
+    ListNode *const next = node->next;
+    node->next = NULL;
+    node = next;
+    LIST_COUNT_VISIT();
+    LIST_COUNT_LINK();
+    live[w] = w;
+  }
+
+  // Step each segment's sort in turn until they're all done.  Drop each one
+  // from the rotation as it finishes.
+  int num_live = width;
+  while (num_live) {
+    for (int k = 0; k < num_live; ) {
+      if (sort_step(&sort_lane[live[k]], cmp)) {
+        k++;
+      } else {
+        live[k] = live[--num_live];
+      }
+    }
+  }
+
+  // Merge the sorted segments pairwise, interleaving each level's merges.
+  ListNode *seg[AMI1_MAX_WIDTH];
+  for (int w = 0; w < width; ++w) {
+    seg[w] = sort_lane[w].rest;
+  }
+
+  MergeLane merge_lane[AMI1_MAX_WIDTH / 2];
+  for (int segs = width; segs > 1; segs = (segs + 1) / 2) {
+    const int merges = segs / 2;
+    for (int m = 0; m < merges; ++m) {
+      MergeLane *const ml = &merge_lane[m];
+      ml->a = seg[2 * m];
+      ml->b = seg[2 * m + 1];
+      ml->out_head = NULL;
+      ml->out_tail = &ml->out_head;
+      live[m] = m;
+    }
+
+    num_live = merges;
+    while (num_live) {
+      for (int k = 0; k < num_live; ) {
+        if (merge_step(&merge_lane[live[k]], cmp)) {
+          k++;
+        } else {
+          live[k] = live[--num_live];
+        }
+      }
+    }
+
+    // Collect the merged segments.  An odd segment out carries over as-is.
+    for (int m = 0; m < merges; ++m) {
+      seg[m] = merge_lane[m].out_head;
+    }
+    if (segs & 1) {
+      seg[merges] = seg[segs - 1];
+    }
+  }
+
+  return seg[0];
+}
+
+// Same as above, using the group width set by ami1_merge_sort_set_width.
+ListNode *ami1_merge_sort(ListNode *const first,
+                          ListNodeCompareFxn *const cmp) {
+  return ami1_merge_sort_width(first, cmp, ami1_width);
+}
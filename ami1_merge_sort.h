@@ -0,0 +1,35 @@
+// Interleaved top-down iterative merge sort:  runs several independent
+// tdi2_merge_sort-style sorts in lockstep, to keep several cache misses in
+// flight at once.
+//
+// Author:  agent <agent@local>
+// Based on tdi2_merge_sort.c by Drew Eckhardt and Joe Zbiciak.
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#ifndef AMI1_MERGE_SORT_H_
+#define AMI1_MERGE_SORT_H_
+
+#include "list_node.h"
+#include "list_sort.h"
+
+// The largest group width ami1_merge_sort supports.
+#define AMI1_MAX_WIDTH (64)
+
+// Sets the group width, the number of interleaved merges, ami1_merge_sort
+// uses.  Clamped to [1, AMI1_MAX_WIDTH].  The default is 16.
+void ami1_merge_sort_set_width(int width);
+
+// Implements a merge sort on a singly linked list using Asynchronous Memory
+// Access Chaining (AMAC).  It cuts the list into 'width' segments, and sorts
+// each with tdi2_merge_sort's algorithm, written as a state machine that
+// advances one node per step.  A round-robin loop steps each segment's state
+// machine in turn.  Each step prefetches the next node its state machine will
+// touch, so by the time the loop comes back around, that node is in cache.
+// The sorted segments then get merged pairwise, with each level's merges
+// interleaved the same way.
+ListNode *ami1_merge_sort_width(ListNode *first, ListNodeCompareFxn *cmp,
+                                int width);
+
+// Same as above, using the group width set by ami1_merge_sort_set_width.
+ListNode *ami1_merge_sort(ListNode *first, ListNodeCompareFxn *cmp);
+
+#endif  // AMI1_MERGE_SORT_H_
@@ -0,0 +1,94 @@
+// Summarizes repeated timings of one sort at one size.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#include "bench_stats.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Student's t distribution's 97.5th percentile, for 1 through 30 degrees of
+// freedom.  That's the multiplier for a two-sided 95% confidence interval.
+static const double t_975[30] = {
+  12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+   2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+   2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+};
+
+// Returns the multiplier for a 95% confidence interval with 'dof' degrees of
+// freedom.  Past the table, 1.96 + 2.4 / dof stays within 0.003 of it.
+static double t_multiplier(const size_t dof) {
+  return dof <= 30 ? t_975[dof - 1] : 1.96 + 2.4 / dof;
+}
+
+// Computes the mean, standard deviation and confidence interval half-width.
+static void mean_and_ci(const double *const samples, const size_t n,
+                        double *const mean, double *const stddev,
+                        double *const ci) {
+  double sum = 0.;
+  for (size_t i = 0; i < n; ++i) {
+    sum += samples[i];
+  }
+  *mean = sum / n;
+
+  if (n < 2) {
+    *stddev = 0.;
+    *ci = INFINITY;
+    return;
+  }
+
+  double sum_sq = 0.;
+  for (size_t i = 0; i < n; ++i) {
+    const double diff = samples[i] - *mean;
+    sum_sq += diff * diff;
+  }
+  *stddev = sqrt(sum_sq / (n - 1));
+  *ci = t_multiplier(n - 1) * *stddev / sqrt(n);
+}
+
+static int compare_doubles(const void *const a, const void *const b) {
+  const double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+// Returns the 'p' quantile of 'n' sorted samples, interpolating between the
+// two nearest.
+static double quantile(const double *const sorted, const size_t n,
+                       const double p) {
+  const double pos = p * (n - 1);
+  const size_t lo = (size_t)pos;
+  if (lo + 1 >= n) {
+    return sorted[n - 1];
+  }
+  return sorted[lo] + (pos - lo) * (sorted[lo + 1] - sorted[lo]);
+}
+
+// Summarizes 'n' samples.
+BenchStats bench_stats_summarize(const double *const samples, const size_t n,
+                                 double *const scratch) {
+  BenchStats stats = { .samples = n };
+  if (!n) {
+    return stats;
+  }
+
+  mean_and_ci(samples, n, &stats.mean, &stats.stddev, &stats.ci);
+
+  memcpy(scratch, samples, n * sizeof(double));
+  qsort(scratch, n, sizeof(double), compare_doubles);
+  stats.min = scratch[0];
+  stats.median = quantile(scratch, n, 0.5);
+  stats.p90 = quantile(scratch, n, 0.9);
+  return stats;
+}
+
+// Returns true if the confidence interval is within 'target' of the mean.
+bool bench_stats_converged(const double *const samples, const size_t n,
+                           const double target) {
+  if (n < 2) {
+    return false;
+  }
+  double mean, stddev, ci;
+  mean_and_ci(samples, n, &mean, &stddev, &ci);
+  return ci <= target * mean;
+}
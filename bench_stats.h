@@ -0,0 +1,29 @@
+// Summarizes repeated timings of one sort at one size.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#ifndef BENCH_STATS_H_
+#define BENCH_STATS_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// A summary of a set of samples.
+typedef struct {
+  size_t samples;
+  double min, median, p90;
+  double mean, stddev;
+  double ci;  // Half-width of the 95% confidence interval of the mean.
+} BenchStats;
+
+// Summarizes 'n' samples.  'scratch' must hold 'n' doubles.  The samples
+// themselves are left as-is.
+BenchStats bench_stats_summarize(const double *samples, size_t n,
+                                 double *scratch);
+
+// Returns true if the 95% confidence interval of the mean of 'n' samples is
+// within 'target' times the mean, i.e. 'target' is a relative error.  Needs
+// at least two samples.
+bool bench_stats_converged(const double *samples, size_t n, double target);
+
+#endif  // BENCH_STATS_H_
@@ -0,0 +1,92 @@
+// A low-overhead timer for the benchmark:  the CPU's time stamp counter when
+// it ticks at a constant rate, and clock_gettime otherwise.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#include "bench_timer.h"
+
+#include <stdbool.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+# include <cpuid.h>
+# include <x86intrin.h>
+# define HAVE_TSC (1)
+#else
+# define HAVE_TSC (0)
+#endif
+
+// How long to calibrate the time stamp counter against CLOCK_MONOTONIC.
+#define CALIBRATE_SECONDS (0.05)
+
+static bool use_tsc = false;
+static double seconds_per_tick = 1e-9;
+
+// Returns CLOCK_MONOTONIC in nanoseconds.
+static uint64_t monotonic_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+#if HAVE_TSC
+// Reads the time stamp counter.  The fences keep the timed code from
+// drifting across the read in either direction.
+static inline uint64_t read_tsc(void) {
+  _mm_lfence();
+  const uint64_t tsc = __rdtsc();
+  _mm_lfence();
+  return tsc;
+}
+
+// Returns true if the CPU has an invariant time stamp counter.
+static bool has_invariant_tsc(void) {
+  unsigned eax, ebx, ecx, edx;
+  if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) {
+    return false;
+  }
+  return (edx >> 8) & 1;
+}
+#endif
+
+// Picks the timer, and calibrates the time stamp counter if we use it.
+void bench_timer_init(void) {
+#if HAVE_TSC
+  if (!has_invariant_tsc()) {
+    return;
+  }
+
+  const uint64_t ns0 = monotonic_ns();
+  const uint64_t tsc0 = read_tsc();
+  uint64_t ns1, tsc1;
+  do {
+    ns1 = monotonic_ns();
+    tsc1 = read_tsc();
+  } while (ns1 - ns0 < CALIBRATE_SECONDS * 1e9);
+
+  if (tsc1 > tsc0) {
+    seconds_per_tick = (ns1 - ns0) * 1e-9 / (tsc1 - tsc0);
+    use_tsc = true;
+  }
+#endif
+}
+
+// Returns the name of the timer in use.
+const char *bench_timer_name(void) {
+  return use_tsc ? "tsc" : "clock_gettime";
+}
+
+// Returns the current time, in ticks of the timer in use.
+uint64_t bench_timer_read(void) {
+#if HAVE_TSC
+  if (use_tsc) {
+    return read_tsc();
+  }
+#endif
+  return monotonic_ns();
+}
+
+// Converts a difference between two timer readings to seconds.
+double bench_timer_seconds(const uint64_t ticks) {
+  return ticks * seconds_per_tick;
+}
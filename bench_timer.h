@@ -0,0 +1,26 @@
+// A low-overhead timer for the benchmark:  the CPU's time stamp counter when
+// it ticks at a constant rate, and clock_gettime otherwise.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#ifndef BENCH_TIMER_H_
+#define BENCH_TIMER_H_
+
+#include <stdint.h>
+
+// Picks the timer.  It uses the time stamp counter if CPUID reports an
+// invariant TSC, one that ticks at a constant rate through frequency changes
+// and sleep states, and calibrates it against CLOCK_MONOTONIC.  Call it once
+// before reading the timer.
+void bench_timer_init(void);
+
+// Returns the name of the timer in use ("tsc" or "clock_gettime").
+const char *bench_timer_name(void);
+
+// Returns the current time, in ticks of the timer in use.
+uint64_t bench_timer_read(void);
+
+// Converts a difference between two timer readings to seconds.
+double bench_timer_seconds(uint64_t ticks);
+
+#endif  // BENCH_TIMER_H_
@@ -3,6 +3,8 @@
 // Author:  Joe Zbiciak <joe.zbiciak@leftturnonly.info>
 // SPDX-License-Identifier:  CC-BY-SA-4.0
 #include <inttypes.h>
+#include <math.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -10,11 +12,33 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <unistd.h>
 
+#include "ami1_merge_sort.h"
+#include "bench_stats.h"
+#include "bench_timer.h"
+#include "cache_flush.h"
+#include "fbi2_merge_sort.h"
+#include "fti2_merge_sort.h"
+#include "ftr2_merge_sort.h"
+#include "gsr1_gather_sort.h"
+#include "gsv1_gather_sort.h"
+#include "lbi2_merge_sort.h"
+#include "list_gen.h"
+#include "list_instrument.h"
+#include "list_leaf.h"
 #include "list_node.h"
 #include "list_sort.h"
 #include "list_types.h"
-#include "mt64.h"
+#include "ltr2_merge_sort.h"
+#include "lti2_merge_sort.h"
+#include "mbi1_merge_sort.h"
+#include "page_buf.h"
+#include "perf_counters.h"
+#include "pbi1_merge_sort.h"
+#include "ptq1_quick_sort.h"
+#include "simd_sort.h"
+#include "wbi1_merge_sort.h"
 
 // Returns the current time in seconds.
 static double now(void) {
@@ -23,65 +47,184 @@ static double now(void) {
   return ts.tv_sec + 1e-9 * ts.tv_nsec;
 }
 
-// Prints the set of sort names as column headings for a CSV.  The context
-// argument sets the label for the first column, to allow us to distinguish the
-// warmup pass from the main benchmark.
-static void print_csv_header(const char *context) {
-  fputs(context, stdout);
+// One sort under test.  Exactly one of 'fxn', 'key_fxn' and 'many_fxn' is
+// set.
+typedef struct {
+  const char *name;
+  ListSortFxn *fxn;
+  ListKeySortFxn *key_fxn;
+  ListSortManyFxn *many_fxn;
+} BenchSort;
+
+// The set of sorts under test:  everything in the sort registry, followed by
+// any sorts specific to the list node type being benchmarked, followed by the
+// key-aware sorts if the list node type has sort keys, followed by the
+// many-list sorts.  If 'baseline' is set, the results also report each sort's
+// speedup over that one.
+typedef struct {
+  size_t length;
+  BenchSort *entry;
+  const BenchSort *baseline;
+} BenchSorts;
+
+// Returns true if the benchmark should run 'entry' on the lists it generates.
+// The naive pivot QuickSorts only run on uniform lists.
+static bool use_sort(const SortRegistryEntry *const entry) {
+  return !entry->naive_pivot ||
+         list_gen_options().dist.kind == LIST_GEN_UNIFORM;
+}
+
+// Collects the sorts to benchmark for a given list node type.
+static BenchSorts collect_sorts(const ListNodeBenchOps *const lnb_ops) {
+  const SortRegistry *const typed = lnb_ops->typed_sorts;
+  const size_t typed_length = typed ? typed->length : 0;
+  const size_t key_length = lnb_ops->key ? key_sort_registry.length : 0;
+  const size_t length = sort_registry.length + typed_length + key_length +
+                        many_sort_registry.length;
+  BenchSorts sorts = {
+    .length = 0,
+    .entry = calloc(length, sizeof(BenchSort)),
+    .baseline = NULL
+  };
+
+  if (!sorts.entry) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    exit(1);
+  }
+
   for (size_t i = 0; i < sort_registry.length; ++i) {
-    printf(",%s", sort_registry.entry[i].name);
+    if (!use_sort(&sort_registry.entry[i])) {
+      continue;
+    }
+    const BenchSort bs = {
+      .name = sort_registry.entry[i].name,
+      .fxn = sort_registry.entry[i].fxn
+    };
+    sorts.entry[sorts.length++] = bs;
   }
-  putchar('\n');
-  fflush(stdout);
+  for (size_t i = 0; i < typed_length; ++i) {
+    if (!use_sort(&typed->entry[i])) {
+      continue;
+    }
+    const BenchSort bs = {
+      .name = typed->entry[i].name,
+      .fxn = typed->entry[i].fxn
+    };
+    sorts.entry[sorts.length++] = bs;
+  }
+  for (size_t i = 0; i < key_length; ++i) {
+    const BenchSort bs = {
+      .name = key_sort_registry.entry[i].name,
+      .key_fxn = key_sort_registry.entry[i].fxn
+    };
+    sorts.entry[sorts.length++] = bs;
+  }
+  for (size_t i = 0; i < many_sort_registry.length; ++i) {
+    const BenchSort bs = {
+      .name = many_sort_registry.entry[i].name,
+      .many_fxn = many_sort_registry.entry[i].fxn
+    };
+    sorts.entry[sorts.length++] = bs;
+  }
+
+  return sorts;
 }
 
-// Creates a randomized linked list of int64_t in the designated buffer, with
-// the specified seed.
-static ListNode *generate_list(
-    const ListNodeBenchOps *const lnb_ops,
-    void *const list_buf,
-    const size_t elems,
-    const uint64_t seed
-) {
-  static size_t *perm_buf = NULL;
-  static size_t perm_buf_size = 0;
-  if (elems > perm_buf_size) {
-    perm_buf = (size_t *)realloc(perm_buf, sizeof(size_t) * elems);
-    perm_buf_size = elems;
+// Looks up a sort by name.  Returns NULL if there's no such sort.
+static const BenchSort *find_sort(const BenchSorts *const sorts,
+                                  const char *const name) {
+  for (size_t i = 0; i < sorts->length; ++i) {
+    if (!strcmp(sorts->entry[i].name, name)) {
+      return &sorts->entry[i];
+    }
   }
+  return NULL;
+}
 
-  // The constant is intended to "temper" simple seeds like 1, 2, 3.
-  init_genrand64(seed ^ 0x0A1A2A3A4A5A6A7Aull);
+// The hardware performance counters, if the -c flag asked for them and the
+// system has them.
+static bool use_counters = false;
+static PerfCounters counters;
 
-  // Randomize the values.
-  for (size_t i = 0; i < elems; ++i) {
-    lnb_ops->randomize(lnb_ops->get(list_buf, i));
-  }
+// How the -C flag asked us to evict the lists for the cold-cache timings.
+// With CACHE_FLUSH_NONE, we only time the sorts warm.
+static CacheFlushMode flush_mode = { CACHE_FLUSH_NONE, false };
 
-  // Prepare to make a random permutation of nodes.
-  for (size_t i = 0; i < elems; ++i) {
-    perm_buf[i] = i;
+// Prints the column headings for the performance counters, if we have them,
+// and the work counts and passes, in instrumented builds.
+static void print_counter_and_work_headers(const BenchSorts *const sorts) {
+  if (use_counters) {
+    for (size_t i = 0; i < sorts->length; ++i) {
+      for (int e = 0; e < PERF_COUNTER_COUNT; ++e) {
+        if (perf_counters_has(&counters, e)) {
+          printf(",%s %s", sorts->entry[i].name, perf_counters_event_name(e));
+        }
+      }
+    }
   }
+  if (list_instrument_enabled()) {
+    for (size_t i = 0; i < sorts->length; ++i) {
+      const char *const name = sorts->entry[i].name;
+      printf(",%s compares/n lg n,%s links/n lg n,%s visits/n lg n",
+             name, name, name);
+    }
+    for (size_t i = 0; i < sorts->length; ++i) {
+      printf(",%s passes", sorts->entry[i].name);
+    }
+  }
+}
 
-  // Fisher-Yates shuffle the node order.
-  for (size_t i = 0; i < elems; ++i) {
-    size_t j = i + (elems - i) * genrand64_real2();
-    size_t t = perm_buf[i];
-    perm_buf[i] = perm_buf[j];
-    perm_buf[j] = t;
-  }
-
-  // String together the linked list.
-  ListNode *const first = lnb_ops->get(list_buf, perm_buf[0]);
-  ListNode *prev = first;
-  for (size_t i = 1; i < elems; ++i) {
-    ListNode *const curr = lnb_ops->get(list_buf, perm_buf[i]);
-    prev->next = curr;
-    prev = curr;
+// Prints the set of sort names as column headings for a CSV.  The context
+// argument sets the label for the first column, to allow us to distinguish the
+// warmup pass from the main benchmark.  The first set of columns holds each
+// sort's median time.  With a baseline, a second set holds the speedups.  Next
+// come each sort's minimum, 90th percentile and standard deviation, and the
+// number of samples behind them.  With a cold-cache mode, the next two sets
+// hold each sort's median cold time, and how much slower that is than its
+// warm time.  With performance counters, a column for
+// each available event follows for each sort.  Instrumented builds add each
+// sort's comparisons, link writes and node visits, divided by n log2 n, and
+// then each sort's passes over the list.
+static void print_csv_header(const char *context,
+                             const BenchSorts *const sorts) {
+  fputs(context, stdout);
+  for (size_t i = 0; i < sorts->length; ++i) {
+    printf(",%s", sorts->entry[i].name);
+  }
+  if (sorts->baseline) {
+    for (size_t i = 0; i < sorts->length; ++i) {
+      printf(",%s vs. %s", sorts->entry[i].name, sorts->baseline->name);
+    }
   }
-  prev->next = NULL;
+  for (size_t i = 0; i < sorts->length; ++i) {
+    const char *const name = sorts->entry[i].name;
+    printf(",%s min,%s p90,%s stddev,%s samples", name, name, name, name);
+  }
+  if (flush_mode.kind != CACHE_FLUSH_NONE) {
+    for (size_t i = 0; i < sorts->length; ++i) {
+      printf(",%s cold", sorts->entry[i].name);
+    }
+    for (size_t i = 0; i < sorts->length; ++i) {
+      printf(",%s cold - warm", sorts->entry[i].name);
+    }
+  }
+  print_counter_and_work_headers(sorts);
+  putchar('\n');
+  fflush(stdout);
+}
+
+// Records how the benchmark generates its lists, ahead of the CSV header.
+static void print_list_details(void) {
+  const ListGenOptions opts = list_gen_options();
+  char name[64];
 
-  return first;
+  printf("Generator,%s\n", list_gen_rng_name(opts.rng));
+  list_gen_dist_name(opts.dist, name, sizeof(name));
+  printf("Distribution,%s\n", name);
+  list_gen_placement_name(opts.placement, name, sizeof(name));
+  printf("Placement,%s\n", name);
+  list_gen_order_name(opts.order, name, sizeof(name));
+  printf("Order,%s\n", name);
 }
 
 // Returns 0 if incorrect; otherwise, returns a checksum of the list contents
@@ -121,89 +264,411 @@ static uint64_t check_list_correctness(
   return csum ? csum : 1;
 }
 
+// The most lists one timed batch sorts back-to-back, and the number of nodes
+// a batch aims to cover.  Sorts of tiny lists take about as long as reading
+// the timer, so each timer reading covers a batch of them.
+#define MAX_BATCH (64)
+#define BATCH_NODES (1024)
+
+// Small-list mode sorts up to this many lists per timer reading, covering up
+// to this many nodes in all.
+#define SMALL_MAX_LISTS (4096)
+#define SMALL_BATCH_NODES (1u << 18)
+
+// What one sort collected at one size, over repeated batches.
 typedef struct {
-  double time;
-  uint64_t csum;
-} BenchResult;
+  double *samples;   // Seconds per list, one for each batch.
+  size_t reps;       // Batches so far.
+  size_t lists;      // Lists sorted so far, over all of the batches.
+  double elapsed;    // Seconds spent so far, including generating lists.
+  bool done;         // Set once the sort has enough samples.
+  uint64_t csum;     // The latest batch's checksum, or 0 if it failed.
+  PerfCounts counts;         // Totals.  Only set when use_counters is.
+  ListInstrumentCounts work; // Totals.  Only set in instrumented builds.
+  BenchStats stats;          // Summarizes the samples, once they're done.
+} BenchRuns;
 
+// Each sort repeats at each size until its confidence interval is within
+// 'target' of its mean, or until it has spent 'budget' seconds there, but at
+// least 'min_reps' and at most 'max_reps' times.  Repetition r sorts the
+// lists with seeds 'seed_base' + r * batch through one less than the next
+// repetition's, so every sort sees the same lists.
 typedef struct {
   const ListNodeBenchOps *lnb_ops;
+  const BenchSorts *sorts;
   void *list_buf;
-  BenchResult *rslt_buf;
-  double *time_buf;
-  int seed_lo, seed_hi;     // Inclusive range.
+  size_t list_bytes;
+  ListGenBuf *gen_bufs;     // MAX_BATCH of them, one per list in a batch.
+  ListNode **lists;         // Room for SMALL_MAX_LISTS lists.
+  bool small;               // Small-list mode.  See run_small_list_mode.
+  BenchRuns *runs;          // One per sort.
+  BenchRuns *cold_runs;     // One per sort, for the cold-cache timings.
+  const CacheFlush *flush;  // Evicts the lists for the cold-cache timings.
+                            // NULL to only time the sorts warm.
+  double *scratch;          // Room for 'max_reps' samples.
+  uint64_t seed_base;
+  size_t min_reps, max_reps;
+  double target, budget;
+  FILE *dump;               // Receives the raw samples, if not NULL.
   size_t size_lo, size_hi;  // Inclusive range, in bytes.
 } BenchSweepDetails;
 
 
-// Invokes the sort function under test on an already-prepared list, returning
-// its total execution time and the checksum associated with its (hopefully)
-// sorted list.
-static BenchResult run_single_benchmark(
-    ListSortFxn *const sort,
-    const ListNodeBenchOps *const lnb_ops,
-    void *const list_buf,
+// Instrumented builds hand the sorts counting_compare, which counts calls to
+// the list node type's comparison function.
+static ListNodeCompareFxn *counted_compare;
+
+static bool counting_compare(const ListNode *const a, const ListNode *const b) {
+  LIST_COUNT_COMPARE();
+  return counted_compare(a, b);
+}
+
+// Returns the comparison function the sorts under test use.
+static inline ListNodeCompareFxn *sort_compare(
+    const ListNodeBenchOps *const lnb_ops) {
+  return list_instrument_enabled() ? counting_compare : lnb_ops->compare;
+}
+
+// Sorts a list with one of the sorts under test.
+static inline ListNode *run_sort(const BenchSort *const sort,
+                                 const ListNodeBenchOps *const lnb_ops,
+                                 ListNode *const in) {
+  ListNodeCompareFxn *const cmp = sort_compare(lnb_ops);
+  if (sort->many_fxn) {
+    ListNode *head = in;
+    sort->many_fxn(&head, 1, cmp);
+    return head;
+  }
+  return sort->key_fxn ? sort->key_fxn(in, lnb_ops->key, cmp)
+                       : sort->fxn(in, cmp);
+}
+
+// Sorts a batch of lists with one of the sorts under test, in one call if
+// it's a many-list sort.
+static inline void run_sort_batch(const BenchSort *const sort,
+                                  const ListNodeBenchOps *const lnb_ops,
+                                  ListNode **const lists, const size_t count) {
+  if (sort->many_fxn) {
+    sort->many_fxn(lists, count, sort_compare(lnb_ops));
+    return;
+  }
+  for (size_t k = 0; k < count; ++k) {
+    lists[k] = run_sort(sort, lnb_ops, lists[k]);
+  }
+}
+
+// Returns the number of lists to sort per timer reading at this size.  With
+// dense placement, each list in a batch needs its own slice of the list
+// buffer.  At least one list must fit; main() checks that for small-list mode,
+// and the size sweep stops at the buffer's size.
+static size_t batch_size(const BenchSweepDetails *const sweep,
+                         const size_t elems) {
+  const size_t max_lists = sweep->small ? SMALL_MAX_LISTS : MAX_BATCH;
+  const size_t nodes = sweep->small ? SMALL_BATCH_NODES : BATCH_NODES;
+  size_t batch = (nodes + elems - 1) / elems;
+  if (batch > max_lists) {
+    batch = max_lists;
+  }
+  const size_t fit = sweep->list_bytes / (elems * sweep->lnb_ops->size);
+  if (!fit) {
+    fprintf(stderr, "A list of %zu nodes doesn't fit in the %zu byte list "
+            "buffer.\n", elems, sweep->list_bytes);
+    exit(1);
+  }
+  return batch < fit ? batch : fit;
+}
+
+// Generates a batch of 'batch' lists of 'elems' nodes each.  In small-list
+// mode, it generates one long list and cuts it into pieces, so that one
+// ListGenBuf holds all of them, and their nodes mix in memory the way the
+// placement and order say.  Otherwise, each list gets its own ListGenBuf,
+// slice of the list buffer, and seed.
+static void generate_batch(
+    const BenchSweepDetails *const sweep,
     const size_t elems,
-    const int seed
+    const size_t batch,
+    const uint64_t seed
 ) {
-  ListNode *const in = generate_list(lnb_ops, list_buf, elems, seed);
-
-  const double t1 = now();
-  ListNode *const out = sort(in, lnb_ops->compare);
-  const double t2 = now();
+  const ListNodeBenchOps *const lnb_ops = sweep->lnb_ops;
+  char *const list_buf = sweep->list_buf;
+  ListNode **const list = sweep->lists;
 
-  const BenchResult test_result = {
-      .time = t2 - t1,
-      .csum = check_list_correctness(lnb_ops, out, elems)
-  };
+  if (!sweep->small) {
+    for (size_t k = 0; k < batch; ++k) {
+      list[k] = list_gen_generate(&sweep->gen_bufs[k], lnb_ops,
+                                  list_buf + k * elems * lnb_ops->size, elems,
+                                  seed + k);
+    }
+    return;
+  }
 
-  return test_result;
+  ListNode *node = list_gen_generate(&sweep->gen_bufs[0], lnb_ops, list_buf,
+                                     batch * elems, seed);
+  for (size_t k = 0; k < batch; ++k) {
+    list[k] = node;
+    for (size_t i = 1; i < elems; ++i) {
+      node = node->next;
+    }
+    ListNode *const next = node->next;
+    node->next = NULL;
+    node = next;
+  }
 }
 
-// Invokes each of the sort functions in the sort registry with the same size
-// input, iterating over a range of seed values for randomization.
-static void run_benchmark_suite_at_single_size(
+// Generates a batch of lists, and sorts them back-to-back with the sort under
+// test between two timer readings.  If 'cold' is set, it evicts the lists from
+// the caches first.  Adds the time per list to the sort's warm or cold
+// samples, along with its performance counts and, in instrumented builds, the
+// work it did.  Records a checksum of the (hopefully) sorted lists.
+static void run_batch_benchmark(
     const BenchSweepDetails *const sweep,
-    const size_t elems
+    const size_t sort_index,
+    const bool cold,
+    const size_t elems,
+    const size_t batch,
+    const uint64_t seed
 ) {
-  double *const time_buf = sweep->time_buf;
-  BenchResult *const rslt_buf = sweep->rslt_buf;
+  const BenchSort *const sort = &sweep->sorts->entry[sort_index];
+  BenchRuns *const runs = cold ? &sweep->cold_runs[sort_index]
+                               : &sweep->runs[sort_index];
+  const ListNodeBenchOps *const lnb_ops = sweep->lnb_ops;
+  ListNode **const list = sweep->lists;
 
-  printf("%zu", elems); fflush(stdout);
+  const uint64_t t0 = bench_timer_read();
+  generate_batch(sweep, elems, batch, seed);
+  if (cold) {
+    cache_flush_lists(sweep->flush, list, batch, lnb_ops->size);
+  }
 
-  for (size_t i = 0; i < sort_registry.length; ++i) {
-    time_buf[i] = 0.;
+  // Start the counters outside the timed region, so the system calls don't
+  // land in the time.
+  if (use_counters) {
+    perf_counters_start(&counters);
   }
+  list_instrument_reset();
+  const uint64_t t1 = bench_timer_read();
+  run_sort_batch(sort, lnb_ops, list, batch);
+  const uint64_t t2 = bench_timer_read();
 
-  for (int seed = sweep->seed_lo; seed <= sweep->seed_hi; ++seed) {
-    for (size_t i = 0; i < sort_registry.length; ++i) {
-      rslt_buf[i] = run_single_benchmark(sort_registry.entry[i].fxn,
-                                         sweep->lnb_ops, sweep->list_buf,
-                                         elems, seed);
-      time_buf[i] += rslt_buf[i].time;
+  const ListInstrumentCounts work = list_instrument_read();
+  runs->work.compares += work.compares;
+  runs->work.links += work.links;
+  runs->work.visits += work.visits;
+  runs->work.passes += work.passes;
+  if (use_counters) {
+    PerfCounts counts;
+    perf_counters_stop(&counters, &counts);
+    for (int e = 0; e < PERF_COUNTER_COUNT; ++e) {
+      runs->counts.count[e] += counts.count[e];
     }
+  }
 
-    // Now check that they all return the same checksum.
+  uint64_t csum = 0;
+  for (size_t k = 0; k < batch; ++k) {
+    const uint64_t list_csum = check_list_correctness(lnb_ops, list[k], elems);
+    if (!list_csum) {
+      csum = 0;
+      break;
+    }
+    csum = ((csum << 1) ^ (csum >> 1)) + list_csum;
+    csum = csum ? csum : 1;
+  }
+  runs->csum = csum;
+
+  const double time = bench_timer_seconds(t2 - t1) / batch;
+  if (sweep->dump) {
+    fprintf(sweep->dump, "%zu,%s,%s,%zu,%zu,%.9g\n", elems, sort->name,
+            cold ? "cold" : "warm", runs->reps, batch, time);
+  }
+  runs->samples[runs->reps++] = time;
+  runs->lists += batch;
+  runs->elapsed += bench_timer_seconds(bench_timer_read() - t0);
+}
+
+// Returns true once a sort has enough samples at this size.
+static bool done_repeating(const BenchSweepDetails *const sweep,
+                           const BenchRuns *const runs) {
+  if (runs->reps < sweep->min_reps) {
+    return false;
+  }
+  if (runs->reps >= sweep->max_reps ||
+      (sweep->budget > 0. && runs->elapsed >= sweep->budget)) {
+    return true;
+  }
+  return bench_stats_converged(runs->samples, runs->reps, sweep->target);
+}
+
+// Prints each sort's average comparisons, link writes and node visits per
+// sort, divided by n log2 n.  Leaves the columns empty when that's undefined.
+// Also leaves compares empty for the sorts that never call the comparison
+// function, and links and visits empty for the sorts that don't count them.
+static void print_work(const BenchRuns *const runs, const size_t length,
+                       const size_t elems) {
+  for (size_t i = 0; i < length; ++i) {
+    const ListInstrumentCounts *const work = &runs[i].work;
+    const double scale =
+        elems > 1 ? 1.0 / (runs[i].lists * elems * log2(elems)) : 0.;
+    if (!scale) {
+      fputs(",,,", stdout);
+      continue;
+    }
+    if (work->compares) {
+      printf(",%g", work->compares * scale);
+    } else {
+      putchar(',');
+    }
+    if (work->links || work->visits) {
+      printf(",%g,%g", work->links * scale, work->visits * scale);
+    } else {
+      fputs(",,", stdout);
+    }
+  }
+}
+
+// Prints each sort's average passes over each list.  Only wbi1, tdi2 and
+// bui2 count them, so the rest get empty columns.
+static void print_passes(const BenchRuns *const runs, const size_t length) {
+  for (size_t i = 0; i < length; ++i) {
+    if (runs[i].work.passes) {
+      printf(",%g", (double)runs[i].work.passes / runs[i].lists);
+    } else {
+      putchar(',');
+    }
+  }
+}
+
+// Prints each sort's average performance counts per list.
+static void print_counters(const BenchRuns *const runs, const size_t length) {
+  for (size_t i = 0; i < length; ++i) {
+    for (int e = 0; e < PERF_COUNTER_COUNT; ++e) {
+      if (perf_counters_has(&counters, e)) {
+        printf(",%.0f", runs[i].counts.count[e] / runs[i].lists);
+      }
+    }
+  }
+}
+
+// Invokes each of the sorts under test with the same size input, repeating
+// each with new seeds until it has enough samples, and summarizes the
+// samples.  With a cold-cache mode, each sort also repeats on the same lists
+// evicted from the caches, until it has enough cold samples too.  All of the
+// sorts still repeating sort the same lists in each repetition, and must
+// agree on their checksums.
+static void measure_at_single_size(
+    const BenchSweepDetails *const sweep,
+    const size_t elems,
+    const size_t batch
+) {
+  BenchRuns *const run_sets[2] = { sweep->runs, sweep->cold_runs };
+  const int num_sets = sweep->flush ? 2 : 1;
+  const BenchSorts *const sorts = sweep->sorts;
+
+  for (int set = 0; set < num_sets; ++set) {
+    for (size_t i = 0; i < sorts->length; ++i) {
+      double *const samples = run_sets[set][i].samples;
+      const BenchRuns zero = { .samples = samples };
+      run_sets[set][i] = zero;
+    }
+  }
+
+  size_t live = sorts->length * num_sets;
+  for (size_t rep = 0; live; ++rep) {
+    const uint64_t seed = sweep->seed_base + rep * batch;
+    const BenchRuns *first = NULL;
     bool ok = true;
-    for (size_t i = 1; i < sort_registry.length; ++i) {
-      if (rslt_buf[0].csum != rslt_buf[i].csum) {
-        ok = false;
+
+    for (size_t i = 0; i < sorts->length; ++i) {
+      for (int set = 0; set < num_sets; ++set) {
+        BenchRuns *const r = &run_sets[set][i];
+        if (r->done) {
+          continue;
+        }
+        run_batch_benchmark(sweep, i, set == 1, elems, batch, seed);
+        if (!r->csum || (first && first->csum != r->csum)) {
+          ok = false;
+        }
+        first = first ? first : r;
       }
     }
 
     if (!ok) {
       printf("\nFAIL");
-      for (size_t i = 0; i < sort_registry.length; ++i) {
-        printf(",%" PRIX64, rslt_buf[i].csum);
+      for (int set = 0; set < num_sets; ++set) {
+        for (size_t i = 0; i < sorts->length; ++i) {
+          if (run_sets[set][i].reps == rep + 1) {
+            printf(",%" PRIX64, run_sets[set][i].csum);
+          } else {
+            putchar(',');
+          }
+        }
       }
       putchar('\n');
       exit(1);
     }
+
+    for (int set = 0; set < num_sets; ++set) {
+      for (size_t i = 0; i < sorts->length; ++i) {
+        BenchRuns *const r = &run_sets[set][i];
+        if (!r->done && done_repeating(sweep, r)) {
+          r->done = true;
+          live--;
+        }
+      }
+    }
   }
 
-  const double seed_scale = 1.0 / (sweep->seed_hi - sweep->seed_lo + 1);
-  for (size_t i = 0; i < sort_registry.length; ++i) {
-    printf(",%g", time_buf[i] * seed_scale);
+  for (int set = 0; set < num_sets; ++set) {
+    for (size_t i = 0; i < sorts->length; ++i) {
+      BenchRuns *const r = &run_sets[set][i];
+      r->stats = bench_stats_summarize(r->samples, r->reps, sweep->scratch);
+    }
+  }
+}
+
+// Measures each of the sorts under test at one size, and prints a row of
+// results.
+static void run_benchmark_suite_at_single_size(
+    const BenchSweepDetails *const sweep,
+    const size_t elems
+) {
+  const BenchRuns *const runs = sweep->runs;
+  const BenchRuns *const cold_runs = sweep->cold_runs;
+  const BenchSorts *const sorts = sweep->sorts;
+
+  printf("%zu", elems); fflush(stdout);
+  measure_at_single_size(sweep, elems, batch_size(sweep, elems));
+
+  // The main columns hold the medians, which a stray slow run can't drag
+  // around the way it drags the mean.
+  for (size_t i = 0; i < sorts->length; ++i) {
+    printf(",%g", runs[i].stats.median);
+  }
+  if (sorts->baseline) {
+    const double baseline_time =
+        runs[sorts->baseline - sorts->entry].stats.median;
+    for (size_t i = 0; i < sorts->length; ++i) {
+      printf(",%g", baseline_time / runs[i].stats.median);
+    }
+  }
+  for (size_t i = 0; i < sorts->length; ++i) {
+    const BenchStats *const stats = &runs[i].stats;
+    printf(",%g,%g,%g,%zu", stats->min, stats->p90, stats->stddev,
+           stats->samples);
+  }
+  if (sweep->flush) {
+    for (size_t i = 0; i < sorts->length; ++i) {
+      printf(",%g", cold_runs[i].stats.median);
+    }
+    for (size_t i = 0; i < sorts->length; ++i) {
+      printf(",%g", cold_runs[i].stats.median - runs[i].stats.median);
+    }
+  }
+  if (use_counters) {
+    print_counters(runs, sorts->length);
+  }
+  if (list_instrument_enabled()) {
+    print_work(runs, sorts->length, elems);
+    print_passes(runs, sorts->length);
   }
   putchar('\n');
   fflush(stdout);
@@ -242,70 +707,843 @@ static void run_benchmark_suite_size_sweep(
   }
 }
 
-// Currently, 256MiB.
-#define MAX_POW2  (28)
-#define MAX_BYTES (1ull << MAX_POW2)
+// Small-list mode measures the per-call cost of sorting many short lists, as
+// in a program that sorts short lists millions of times per second.  At each
+// size up to 'max_elems' nodes, it cuts one long list into thousands of short
+// ones, and times sorting all of them back-to-back.  For each sort, it reports
+// the median time per sort and per node, in nanoseconds, followed by the
+// speedups over the baseline if there is one, and then the 90th percentile
+// time per sort and the number of samples.  With a cold-cache mode, the cold
+// times per sort and per node follow.
+static void run_small_list_mode(const BenchSweepDetails *const sweep,
+                                const size_t max_elems) {
+  const BenchSorts *const sorts = sweep->sorts;
+  const BenchRuns *const runs = sweep->runs;
+  const BenchRuns *const cold_runs = sweep->cold_runs;
+
+  fputs("Elems,Lists", stdout);
+  for (size_t i = 0; i < sorts->length; ++i) {
+    printf(",%s ns/sort", sorts->entry[i].name);
+  }
+  for (size_t i = 0; i < sorts->length; ++i) {
+    printf(",%s ns/node", sorts->entry[i].name);
+  }
+  if (sorts->baseline) {
+    for (size_t i = 0; i < sorts->length; ++i) {
+      printf(",%s vs. %s", sorts->entry[i].name, sorts->baseline->name);
+    }
+  }
+  for (size_t i = 0; i < sorts->length; ++i) {
+    const char *const name = sorts->entry[i].name;
+    printf(",%s p90 ns/sort,%s samples", name, name);
+  }
+  if (sweep->flush) {
+    for (size_t i = 0; i < sorts->length; ++i) {
+      printf(",%s cold ns/sort", sorts->entry[i].name);
+    }
+    for (size_t i = 0; i < sorts->length; ++i) {
+      printf(",%s cold ns/node", sorts->entry[i].name);
+    }
+  }
+  print_counter_and_work_headers(sorts);
+  putchar('\n');
+  fflush(stdout);
+
+  // Every size up to 8 nodes, and then 4 steps per power of 2.
+  size_t elems = 1;
+  while (elems <= max_elems) {
+    const size_t batch = batch_size(sweep, elems);
+    printf("%zu,%zu", elems, batch); fflush(stdout);
+    measure_at_single_size(sweep, elems, batch);
+
+    for (size_t i = 0; i < sorts->length; ++i) {
+      printf(",%g", runs[i].stats.median * 1e9);
+    }
+    for (size_t i = 0; i < sorts->length; ++i) {
+      printf(",%g", runs[i].stats.median * 1e9 / elems);
+    }
+    if (sorts->baseline) {
+      const double baseline_time =
+          runs[sorts->baseline - sorts->entry].stats.median;
+      for (size_t i = 0; i < sorts->length; ++i) {
+        printf(",%g", baseline_time / runs[i].stats.median);
+      }
+    }
+    for (size_t i = 0; i < sorts->length; ++i) {
+      printf(",%g,%zu", runs[i].stats.p90 * 1e9, runs[i].stats.samples);
+    }
+    if (sweep->flush) {
+      for (size_t i = 0; i < sorts->length; ++i) {
+        printf(",%g", cold_runs[i].stats.median * 1e9);
+      }
+      for (size_t i = 0; i < sorts->length; ++i) {
+        printf(",%g", cold_runs[i].stats.median * 1e9 / elems);
+      }
+    }
+    if (use_counters) {
+      print_counters(runs, sorts->length);
+    }
+    if (list_instrument_enabled()) {
+      print_work(runs, sorts->length, elems);
+      print_passes(runs, sorts->length);
+    }
+    putchar('\n');
+    fflush(stdout);
+
+    if (elems == max_elems) {
+      break;
+    }
+    size_t step = 1;
+    while (elems >= 8 * step) {
+      step *= 2;
+    }
+    elems = elems + step > max_elems ? max_elems : elems + step;
+  }
+}
+
+// The default largest list, 256MiB.  The -m flag changes it.
+#define DEFAULT_MAX_BYTES (1ull << 28)
 #define NUM_SEEDS (8)
 
-int main(int argc, char *argv[]) {
-  // For now, very simple argument parsing to select one of two benchmark types.
-  if (argc != 2) {
-    fprintf(stderr, 
-        "Usage:  benchmark <int64|cacheline>\n"
-        "  'int64' runs the benchmark with Int64ListNode\n"
-        "  'cacheline' runs the benchmark with CachelineListNode\n");
+// By default, each sort repeats at each size at least NUM_SEEDS times, until
+// its 95% confidence interval is within 1% of its mean or it has spent half a
+// second there, but no more than 1000 times.  The -n, -e and -B flags change
+// these.
+#define DEFAULT_MIN_REPS (NUM_SEEDS)
+#define DEFAULT_MAX_REPS (1000)
+#define DEFAULT_TARGET (0.01)
+#define DEFAULT_BUDGET (0.5)
+
+// The largest list we sort, in bytes, and the pages behind the list buffers.
+static size_t max_bytes = DEFAULT_MAX_BYTES;
+static PageBufKind page_kind = PAGE_BUF_MALLOC;
+
+// Parses a byte count, with an optional K, M, G or T suffix for binary
+// multiples.  Returns false if it isn't a positive byte count.
+static bool parse_bytes(const char *const str, size_t *const bytes) {
+  char *end;
+  const unsigned long long value = strtoull(str, &end, 10);
+  int shift = 0;
+
+  switch (*end) {
+    case 'k': case 'K': shift = 10; ++end; break;
+    case 'm': case 'M': shift = 20; ++end; break;
+    case 'g': case 'G': shift = 30; ++end; break;
+    case 't': case 'T': shift = 40; ++end; break;
+  }
+
+  if (end == str || *end || !value || value > (SIZE_MAX >> shift)) {
+    return false;
+  }
+  *bytes = (size_t)value << shift;
+  return true;
+}
+
+// Parses a repetition count range, "<min>[:<max>]".  Returns false if it's
+// malformed, or the range is empty.
+static bool parse_reps(const char *const str, size_t *const min_reps,
+                       size_t *const max_reps) {
+  char *end;
+  const unsigned long lo = strtoul(str, &end, 10);
+  unsigned long hi = *max_reps > lo ? *max_reps : lo;
+  if (end == str) {
+    return false;
+  }
+  if (*end == ':') {
+    const char *const hi_str = end + 1;
+    hi = strtoul(hi_str, &end, 10);
+    if (end == hi_str) {
+      return false;
+    }
+  }
+  if (*end || !lo || hi < lo) {
+    return false;
+  }
+  *min_reps = lo;
+  *max_reps = hi;
+  return true;
+}
+
+// Rounds 'bytes' down to the largest size the size sweep visits, so that the
+// warmup pass, which runs at exactly the maximum size, has a size to run at.
+static size_t round_to_sweep_size(const size_t bytes) {
+  if (bytes < 16) {
+    return 16;
+  }
+  int pow2 = 63;
+  while (!(bytes >> pow2)) {
+    --pow2;
+  }
+  const size_t step = pow2 >= 3 ? (size_t)1 << (pow2 - 3) : 1;
+  const size_t base = (size_t)1 << pow2;
+  return base + (bytes - base) / step * step;
+}
+
+// Exits with an error if the benchmark needs more memory than the system has
+// available:  the list buffers, plus the nodes the list generator allocates
+// itself for non-dense placements, gaps included, plus its node order, plus
+// the gather scratch, plus the cache flush buffers.  Going past that would
+// turn the benchmark into a swap test.
+static void check_available_memory(const ListNodeBenchOps *const lnb_ops,
+                                   const int threads) {
+  const size_t avail = page_buf_available_bytes();
+  if (!avail) {
+    return;
+  }
+
+  const size_t elems = max_bytes / lnb_ops->size;
+  size_t need = max_bytes + elems * sizeof(size_t) +
+                list_gen_placement_bytes(list_gen_options().placement, elems,
+                                         lnb_ops->size);
+  if (lnb_ops->key) {
+    const size_t gather = gsv1_gather_sort_scratch_bytes(elems / threads);
+    const size_t pairs = sizeof(KeyNodePair) * (elems / threads);
+    need += (gather > pairs ? gather : pairs) * threads;
+  }
+  need += cache_flush_buf_bytes(flush_mode);
+
+  if (need > avail) {
+    fprintf(stderr, "A %zu byte sweep needs about %zu bytes, but only %zu are "
+            "available.  Use -m to lower the maximum.\n",
+            max_bytes, need, avail);
+    exit(1);
+  }
+}
+
+// Allocates a list buffer with the selected pages.
+static void alloc_list_buf(PageBuf *const buf, const size_t bytes) {
+  if (!page_buf_alloc(buf, bytes, page_kind)) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    exit(1);
+  }
+}
+
+// Records the pages behind the list buffers, and how many of their bytes the
+// kernel actually backed with huge pages.
+static void print_page_details(const PageBuf *const bufs, const int count) {
+  size_t bytes = 0, huge_bytes = 0;
+  for (int i = 0; i < count; ++i) {
+    bytes += bufs[i].bytes;
+    huge_bytes += page_buf_huge_bytes(&bufs[i]);
+  }
+
+  printf("Pages,%s\n", page_buf_kind_name(bufs[0].kind));
+  printf("List buffer bytes,%zu\n", bytes);
+  printf("Huge page bytes,%zu\n", huge_bytes);
+  fflush(stdout);
+}
+
+// Scratch for the gather-sort-relink sorts, big enough to sort 'elems' nodes
+// without allocating while we're timing them.  They run one at a time, so
+// they can share it.  The vector version needs more.
+typedef struct {
+  void *buf;
+  size_t bytes, elems;
+} GatherScratch;
+
+// Allocates gather scratch for lists of up to 'max_elems' nodes.  Types without
+// sort keys don't need any.
+static GatherScratch alloc_gather_scratch(
+    const ListNodeBenchOps *const lnb_ops,
+    const size_t max_elems
+) {
+  GatherScratch scratch = { .buf = NULL, .bytes = 0, .elems = 0 };
+  if (!lnb_ops->key) {
+    return scratch;
+  }
+
+  scratch.elems = max_elems;
+  scratch.bytes = gsv1_gather_sort_scratch_bytes(max_elems);
+  if (scratch.bytes < sizeof(KeyNodePair) * max_elems) {
+    scratch.bytes = sizeof(KeyNodePair) * max_elems;
+  }
+  scratch.buf = malloc(scratch.bytes);
+  if (!scratch.buf) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    exit(1);
+  }
+  return scratch;
+}
+
+// Hands gather scratch to the gather-sort-relink sorts in the calling thread.
+static void use_gather_scratch(const GatherScratch *const scratch) {
+  gsr1_gather_sort_set_scratch((KeyNodePair *)scratch->buf, scratch->elems);
+  gsv1_gather_sort_set_scratch(scratch->buf, scratch->bytes);
+}
+
+// Throughput mode runs several worker threads, each sorting its own list at
+// the same time as the others, so that they compete for memory bandwidth and
+// shared caches.  Each worker gets its own list buffer and seeds.  The
+// workers meet at a barrier before each sort, so that their sorts overlap,
+// and again after, so that list generation and checking stay out of the way.
+typedef struct {
+  const ListNodeBenchOps *lnb_ops;
+  const BenchSorts *sorts;
+  size_t elems;
+  pthread_barrier_t barrier;
+} ThroughputShared;
+
+// One worker's buffers and results.  The results have one slot per sort per
+// seed.
+typedef struct {
+  ThroughputShared *shared;
+  int index;
+  PageBuf list_buf;
+  ListGenBuf gen_buf;
+  GatherScratch scratch;
+  double *start, *end;
+  uint64_t *csum;
+} ThroughputWorker;
+
+// Returns the seed worker 'index' uses for seed number 'seed'.  Each worker
+// sorts different lists, but the same ones for every sort and thread count.
+static uint64_t worker_seed(const int seed, const int index) {
+  return (uint64_t)seed + ((uint64_t)index << 32);
+}
+
+// Runs each sort under test on each seed, in lockstep with the other workers.
+static void *throughput_worker(void *const arg) {
+  ThroughputWorker *const worker = (ThroughputWorker *)arg;
+  ThroughputShared *const shared = worker->shared;
+  const ListNodeBenchOps *const lnb_ops = shared->lnb_ops;
+  const BenchSorts *const sorts = shared->sorts;
+
+  use_gather_scratch(&worker->scratch);
+
+  for (size_t i = 0; i < sorts->length; ++i) {
+    for (int seed = 1; seed <= NUM_SEEDS; ++seed) {
+      const size_t slot = i * NUM_SEEDS + seed - 1;
+
+      // The workers already run in parallel, so each generates its own list
+      // in a single thread.
+      ListGenOptions opts = list_gen_options();
+      opts.threads = 1;
+      ListNode *const in = list_gen_generate_opts(
+          &worker->gen_buf, lnb_ops, worker->list_buf.ptr, shared->elems,
+          worker_seed(seed, worker->index), &opts);
+
+      pthread_barrier_wait(&shared->barrier);
+      const double t1 = now();
+      ListNode *const out = run_sort(&sorts->entry[i], lnb_ops, in);
+      const double t2 = now();
+      pthread_barrier_wait(&shared->barrier);
+
+      worker->start[slot] = t1;
+      worker->end[slot] = t2;
+      worker->csum[slot] = check_list_correctness(lnb_ops, out, shared->elems);
+    }
+  }
+
+  return NULL;
+}
+
+// Runs the throughput benchmark with 1 through 'max_threads' workers.  Each
+// worker sorts lists of max_bytes / max_threads bytes, so the total stays
+// within max_bytes.  For each thread count and sort, reports the aggregate
+// nodes sorted per second of wall-clock time, along with the average and
+// worst per-thread latency of a single sort.
+static void run_throughput_mode(const ListNodeBenchOps *const lnb_ops,
+                                const BenchSorts *const sorts,
+                                const int max_threads) {
+  const size_t elems = max_bytes / max_threads / lnb_ops->size;
+  const size_t slots = sorts->length * NUM_SEEDS;
+  ThroughputShared shared = {
+    .lnb_ops = lnb_ops,
+    .sorts = sorts,
+    .elems = elems
+  };
+  ThroughputWorker *const worker = calloc(max_threads, sizeof(*worker));
+  pthread_t *const thread = calloc(max_threads, sizeof(*thread));
+  if (!worker || !thread) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    exit(1);
+  }
+
+  for (int t = 0; t < max_threads; ++t) {
+    worker[t].shared = &shared;
+    worker[t].index = t;
+    alloc_list_buf(&worker[t].list_buf, elems * lnb_ops->size);
+    worker[t].scratch = alloc_gather_scratch(lnb_ops, elems);
+    worker[t].start = calloc(slots, sizeof(double));
+    worker[t].end = calloc(slots, sizeof(double));
+    worker[t].csum = calloc(slots, sizeof(uint64_t));
+    if (!worker[t].start || !worker[t].end || !worker[t].csum) {
+      fprintf(stderr, "Memory allocation failed.\n");
+      exit(1);
+    }
+  }
+
+  // Gather the buffers to sum up their huge pages.
+  PageBuf *const bufs = calloc(max_threads, sizeof(*bufs));
+  if (!bufs) {
+    fprintf(stderr, "Memory allocation failed.\n");
     exit(1);
   }
+  for (int t = 0; t < max_threads; ++t) {
+    bufs[t] = worker[t].list_buf;
+  }
+  print_page_details(bufs, max_threads);
+  free(bufs);
+
+  printf("Elems per thread,%zu\n", elems);
+  fputs("Threads", stdout);
+  for (size_t i = 0; i < sorts->length; ++i) {
+    const char *const name = sorts->entry[i].name;
+    printf(",%s nodes/s,%s avg latency,%s max latency", name, name, name);
+  }
+  putchar('\n');
+  fflush(stdout);
+
+  for (int threads = 1; threads <= max_threads; ++threads) {
+    printf("%d", threads); fflush(stdout);
+
+    pthread_barrier_init(&shared.barrier, NULL, threads);
+    for (int t = 0; t < threads; ++t) {
+      if (pthread_create(&thread[t], NULL, throughput_worker, &worker[t])) {
+        fprintf(stderr, "\nCould not create worker thread.\n");
+        exit(1);
+      }
+    }
+    for (int t = 0; t < threads; ++t) {
+      pthread_join(thread[t], NULL);
+    }
+    pthread_barrier_destroy(&shared.barrier);
+
+    for (size_t i = 0; i < sorts->length; ++i) {
+      double wall = 0., latency_sum = 0., latency_max = 0.;
+
+      for (int seed = 0; seed < NUM_SEEDS; ++seed) {
+        const size_t slot = i * NUM_SEEDS + seed;
+        double first_start = worker[0].start[slot];
+        double last_end = worker[0].end[slot];
+
+        for (int t = 0; t < threads; ++t) {
+          const double latency = worker[t].end[slot] - worker[t].start[slot];
+          latency_sum += latency;
+          latency_max = latency > latency_max ? latency : latency_max;
+          if (worker[t].start[slot] < first_start) {
+            first_start = worker[t].start[slot];
+          }
+          if (worker[t].end[slot] > last_end) {
+            last_end = worker[t].end[slot];
+          }
+
+          // Each worker's lists must come out the same for every sort.
+          if (!worker[t].csum[slot] ||
+              worker[t].csum[slot] != worker[t].csum[seed]) {
+            printf("\nFAIL,%s,thread %d,seed %d,%" PRIX64 "\n",
+                   sorts->entry[i].name, t, seed + 1, worker[t].csum[slot]);
+            exit(1);
+          }
+        }
+        wall += last_end - first_start;
+      }
+
+      const double nodes = (double)elems * threads * NUM_SEEDS;
+      printf(",%g,%g,%g", nodes / wall, latency_sum / (threads * NUM_SEEDS),
+             latency_max);
+    }
+    putchar('\n');
+    fflush(stdout);
+  }
+}
+
+// Prints usage information and exits.
+static void usage(void) {
+  fprintf(stderr,
+      "Usage:  benchmark [options] <int64|cacheline>\n"
+      "  'int64' runs the benchmark with Int64ListNode\n"
+      "  'cacheline' runs the benchmark with CachelineListNode\n"
+      "Options:\n"
+      "  -b <sort>     Also report each sort's speedup over the named sort\n"
+      "  -B <seconds>  Time budget for repeating each sort at each size\n"
+      "                (default: 0.5; 0 = none)\n"
+      "  -C <mode>     Also time each sort with the lists evicted from the\n"
+      "                caches:  sweep (read a buffer twice the size of the\n"
+      "                LLC) or clflush (flush each node), optionally with\n"
+      "                ':tlb' to evict the TLBs too.  The default, none,\n"
+      "                only times the sorts warm\n"
+      "  -c            Also report hardware performance counters for each\n"
+      "                sort:  cycles, instructions, and L1D, LLC, dTLB and\n"
+      "                branch misses\n"
+      "  -d <dist>     Input distribution:  uniform (the default), sorted,\n"
+      "                reverse, nearly[:<fraction swapped>],\n"
+      "                sawtooth[:<teeth>], organ, few[:<values>],\n"
+      "                zipf[:<exponent>] or runs[:<runs>].  The naive pivot\n"
+      "                QuickSorts only run on uniform\n"
+      "  -D <file>     Write every timing sample to <file> as a CSV\n"
+      "  -e <error>    Repeat each sort at each size until the 95%%\n"
+      "                confidence interval of its mean time is within this\n"
+      "                fraction of the mean (default: 0.01)\n"
+      "  -g <threads>  Threads used to generate lists with '-r ctr'\n"
+      "                (0 = one per CPU)\n"
+      "  -k <ways>     Runs merged at once in the multiway merge sort\n"
+      "                (default: as many as fit in the L1 data cache)\n"
+      "  -l <layout>   Where the nodes live:  dense (the default), malloc,\n"
+      "                or arena[:<max gap bytes>]\n"
+      "  -L <leaf>     Leaf sort for the leaf merge sorts:  <size>,\n"
+      "                network:<size> or insertion:<size>, for sizes 2\n"
+      "                through 16 (default: network:8)\n"
+      "  -m <bytes>    Largest list, with an optional K, M, G or T suffix\n"
+      "                (default: 256M)\n"
+      "  -n <reps>     Samples per sort at each size, as <min>[:<max>]\n"
+      "                (default: 8:1000)\n"
+      "  -o <order>    Node order:  shuffle (the default), alloc, or\n"
+      "                window[:<bytes>] to shuffle within windows\n"
+      "  -p <nodes>    Prefetch distance for the prefetching sorts (0 = off)\n"
+      "  -P <pages>    Pages behind the list buffer:  malloc (the default),\n"
+      "                4k, thp (transparent huge pages) or hugetlb\n"
+      "  -r <rng>      List generator:  mt64 (the default) or ctr, a faster\n"
+      "                counter-based generator that can use several threads\n"
+      "  -S <nodes>    Small-list mode:  at each size up to <nodes>, sort\n"
+      "                thousands of short lists back-to-back, and report the\n"
+      "                time per sort and per node\n"
+      "  -t <threads>  Threads used by the parallel sorts (0 = one per CPU)\n"
+      "  -T <threads>  Throughput mode:  run 1 through <threads> workers,\n"
+      "                each sorting its own list at the same time\n"
+      "  -v <isa>      Vector sort kernels:  scalar, avx2 or avx512\n"
+      "                (default: the best the CPU supports)\n"
+      "  -w <width>    Interleaved merges in the interleaved merge sort, and\n"
+      "                lists in flight in the many-list merge sort\n");
+  exit(1);
+}
+
+int main(int argc, char *argv[]) {
+  const char *baseline_name = NULL;
+  const char *dump_name = NULL;
+  int throughput_threads = 0;
+  int merge_ways = 0;
+  long small_elems = 0;
+  size_t min_reps = DEFAULT_MIN_REPS, max_reps = DEFAULT_MAX_REPS;
+  double target = DEFAULT_TARGET, budget = DEFAULT_BUDGET;
+  ListLeaf leaf = {
+    .kind = LIST_LEAF_DEFAULT_KIND,
+    .size = LIST_LEAF_DEFAULT_SIZE
+  };
+  int opt;
+
+  while ((opt = getopt(argc, argv,
+                       "b:B:cC:d:D:e:g:k:l:L:m:n:o:p:P:r:S:t:T:v:w:")) != -1) {
+    switch (opt) {
+      case 'b':
+        baseline_name = optarg;
+        break;
+      case 'B':
+        budget = atof(optarg);
+        if (budget < 0.) {
+          usage();
+        }
+        break;
+      case 'c':
+        use_counters = true;
+        break;
+      case 'C':
+        if (!cache_flush_parse(optarg, &flush_mode)) {
+          usage();
+        }
+        break;
+      case 'd': {
+        ListGenDist dist;
+        if (!list_gen_parse_dist(optarg, &dist)) {
+          usage();
+        }
+        list_gen_set_dist(dist);
+        break;
+      }
+      case 'D':
+        dump_name = optarg;
+        break;
+      case 'e':
+        target = atof(optarg);
+        if (target <= 0.) {
+          usage();
+        }
+        break;
+      case 'g':
+        list_gen_set_threads(atoi(optarg));
+        break;
+      case 'k':
+        merge_ways = atoi(optarg);
+        if (merge_ways < 2 || merge_ways > WBI1_MAX_WAYS) {
+          usage();
+        }
+        break;
+      case 'l': {
+        ListGenPlacement placement;
+        if (!list_gen_parse_placement(optarg, &placement)) {
+          usage();
+        }
+        list_gen_set_placement(placement);
+        break;
+      }
+      case 'L':
+        if (!list_leaf_parse(optarg, &leaf)) {
+          usage();
+        }
+        lbi2_merge_sort_set_leaf(leaf);
+        ltr2_merge_sort_set_leaf(leaf);
+        lti2_merge_sort_set_leaf(leaf);
+        break;
+      case 'm':
+        if (!parse_bytes(optarg, &max_bytes)) {
+          usage();
+        }
+        max_bytes = round_to_sweep_size(max_bytes);
+        break;
+      case 'n':
+        if (!parse_reps(optarg, &min_reps, &max_reps)) {
+          usage();
+        }
+        break;
+      case 'o': {
+        ListGenOrder order;
+        if (!list_gen_parse_order(optarg, &order)) {
+          usage();
+        }
+        list_gen_set_order(order);
+        break;
+      }
+      case 'p':
+        fbi2_merge_sort_set_distance(atoi(optarg));
+        ftr2_merge_sort_set_distance(atoi(optarg));
+        fti2_merge_sort_set_distance(atoi(optarg));
+        wbi1_merge_sort_set_distance(atoi(optarg));
+        break;
+      case 'P':
+        if (!page_buf_parse_kind(optarg, &page_kind)) {
+          usage();
+        }
+        break;
+      case 'r': {
+        ListGenRng rng;
+        if (!list_gen_parse_rng(optarg, &rng)) {
+          usage();
+        }
+        list_gen_set_rng(rng);
+        break;
+      }
+      case 'S':
+        small_elems = atol(optarg);
+        if (small_elems < 1) {
+          usage();
+        }
+        break;
+      case 't':
+        pbi1_merge_sort_set_threads(atoi(optarg));
+        ptq1_quick_sort_set_threads(atoi(optarg));
+        break;
+      case 'T':
+        throughput_threads = atoi(optarg);
+        if (throughput_threads < 1) {
+          usage();
+        }
+        break;
+      case 'v': {
+        SimdIsa isa;
+        if (!simd_sort_parse_isa(optarg, &isa)) {
+          usage();
+        }
+        if (!simd_sort_set_isa(isa)) {
+          fprintf(stderr, "This CPU doesn't support %s.\n", optarg);
+          exit(1);
+        }
+        break;
+      }
+      case 'w':
+        ami1_merge_sort_set_width(atoi(optarg));
+        mbi1_merge_sort_set_width(atoi(optarg));
+        break;
+      default:
+        usage();
+    }
+  }
+
+  // The one remaining argument selects the list node type.  Small-list mode
+  // and throughput mode each replace the usual size sweep, so only one of
+  // them can run.
+  if (optind != argc - 1 || (small_elems && throughput_threads)) {
+    usage();
+  }
+  const char *const type = argv[optind];
 
   const ListNodeBenchOps *lnb_ops = NULL;
 
-  if (!strcmp(argv[1], "int64")) {
+  if (!strcmp(type, "int64")) {
     lnb_ops = &list_node_bench_ops_int64;
   }
 
-  if (!strcmp(argv[1], "cacheline")) {
+  if (!strcmp(type, "cacheline")) {
     lnb_ops = &list_node_bench_ops_cacheline;
   }
 
   if (!lnb_ops) {
-    fprintf(stderr, "Unknown benchmark type '%s'\n", argv[1]);
+    fprintf(stderr, "Unknown benchmark type '%s'\n", type);
     exit(1);
   }
 
-  // Set up the benchmark sweep details.  Eventually, consider adding flags to
-  // modify these details.
-  const BenchSweepDetails main_sweep = {
-    .lnb_ops = lnb_ops,
-    .list_buf = malloc(MAX_BYTES),
-    .rslt_buf = calloc(sizeof(BenchResult), sort_registry.length),
-    .time_buf = calloc(sizeof(double), sort_registry.length),
-    .seed_lo = 1,  .seed_hi = NUM_SEEDS,
-    .size_lo = 16, .size_hi = MAX_BYTES
-  };
+  // Small-list mode's lists come out of the same buffer as the sweep's.
+  if ((size_t)small_elems > max_bytes / lnb_ops->size) {
+    fprintf(stderr, "-S %ld needs %zu bytes, more than -m allows.\n",
+            small_elems, (size_t)small_elems * lnb_ops->size);
+    usage();
+  }
 
-  // Set up the warmpup sweep details.  Eventually, consider adding flags to
-  // modify these details.
-  const BenchSweepDetails warmup_sweep = {
-    .lnb_ops = main_sweep.lnb_ops,
-    .list_buf = main_sweep.list_buf,
-    .rslt_buf = main_sweep.rslt_buf,
-    .time_buf = main_sweep.time_buf,
-    .seed_lo = 0,.seed_hi = 0, .size_lo = MAX_BYTES, .size_hi = MAX_BYTES
-  };
+  // The multiway merge sort sizes its runs and ways to the caches and the
+  // node size, unless -k picked the ways.
+  wbi1_merge_sort_tune(lnb_ops->size);
+  if (merge_ways) {
+    wbi1_merge_sort_set_ways(merge_ways);
+  }
+
+  BenchSorts sorts = collect_sorts(lnb_ops);
+  counted_compare = lnb_ops->compare;
+  if (baseline_name) {
+    sorts.baseline = find_sort(&sorts, baseline_name);
+    if (!sorts.baseline) {
+      fprintf(stderr, "Unknown sort '%s'\n", baseline_name);
+      exit(1);
+    }
+  }
+
+  if (lnb_ops->key) {
+    fprintf(stderr, "Vector sort kernels:  %s\n",
+            simd_sort_isa_name(simd_sort_isa()));
+  }
+
+  if (use_counters && throughput_threads > 0) {
+    fprintf(stderr, "Throughput mode doesn't report performance counters.\n");
+    use_counters = false;
+  }
+  if (flush_mode.kind != CACHE_FLUSH_NONE && throughput_threads > 0) {
+    fprintf(stderr, "Throughput mode doesn't report cold-cache times.\n");
+    flush_mode.kind = CACHE_FLUSH_NONE;
+    flush_mode.tlb = false;
+  }
+  if (use_counters && !perf_counters_open(&counters)) {
+    fprintf(stderr, "Performance counters aren't available here, so the "
+            "results leave them out.\n");
+    use_counters = false;
+  }
+
+  bench_timer_init();
+  print_list_details();
+  printf("Max bytes,%zu\n", max_bytes);
+  printf("Timer,%s\n", bench_timer_name());
+  char leaf_name[32];
+  list_leaf_name(leaf, leaf_name, sizeof(leaf_name));
+  printf("Leaf sort,%s\n", leaf_name);
+  printf("Merge ways,%d\n", wbi1_merge_sort_ways());
+  printf("Merge run nodes,%zu\n", wbi1_merge_sort_run_nodes());
+  check_available_memory(lnb_ops, throughput_threads > 0 ? throughput_threads
+                                                         : 1);
+
+  // Throughput mode replaces the usual size sweep.
+  if (throughput_threads > 0) {
+    run_throughput_mode(lnb_ops, &sorts, throughput_threads);
+    printf("PASS\n");
+    return 0;
+  }
+
+  // Set up the benchmark sweep details.
+  static ListGenBuf gen_bufs[MAX_BATCH];
+  PageBuf list_buf;
+  alloc_list_buf(&list_buf, max_bytes);
+  print_page_details(&list_buf, 1);
+
+  printf("Repetitions,%zu:%zu\n", min_reps, max_reps);
+  printf("Target error,%g\n", target);
+  printf("Time budget,%g\n", budget);
 
-  if (!main_sweep.list_buf || !main_sweep.rslt_buf || !main_sweep.time_buf) {
+  char flush_name[32];
+  cache_flush_name(flush_mode, flush_name, sizeof(flush_name));
+  printf("Cold cache,%s\n", flush_name);
+  CacheFlush flush;
+  if (!cache_flush_open(&flush, flush_mode)) {
     fprintf(stderr, "Memory allocation failed.\n");
     exit(1);
   }
 
-  // Warmup.  Run the sorts on a max-size buffer with a single seed.
-  print_csv_header("Warmup");
-  run_benchmark_suite_size_sweep(&warmup_sweep);
+  FILE *dump = NULL;
+  if (dump_name) {
+    dump = fopen(dump_name, "w");
+    if (!dump) {
+      perror(dump_name);
+      exit(1);
+    }
+    fputs("Elems,Sort,Cache,Rep,Batch,Seconds\n", dump);
+  }
+
+  // Warm runs for each sort, followed by cold runs for each sort.
+  BenchRuns *const runs = calloc(sizeof(BenchRuns), 2 * sorts.length);
+  double *const samples = calloc(sizeof(double), 2 * sorts.length * max_reps);
+  double *const stats_scratch = calloc(sizeof(double), max_reps);
+  if (!runs || !samples || !stats_scratch) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    exit(1);
+  }
+  for (size_t i = 0; i < 2 * sorts.length; ++i) {
+    runs[i].samples = samples + i * max_reps;
+  }
+
+  ListNode **const lists = calloc(sizeof(ListNode *), SMALL_MAX_LISTS);
+  if (!lists) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    exit(1);
+  }
+
+  const BenchSweepDetails main_sweep = {
+    .lnb_ops = lnb_ops,
+    .sorts = &sorts,
+    .list_buf = list_buf.ptr,
+    .list_bytes = list_buf.bytes,
+    .gen_bufs = gen_bufs,
+    .lists = lists,
+    .small = small_elems > 0,
+    .runs = runs,
+    .cold_runs = runs + sorts.length,
+    .flush = flush_mode.kind != CACHE_FLUSH_NONE ? &flush : NULL,
+    .scratch = stats_scratch,
+    .seed_base = 1,
+    .min_reps = min_reps, .max_reps = max_reps,
+    .target = target, .budget = budget,
+    .dump = dump,
+    .size_lo = 16, .size_hi = max_bytes
+  };
+
+  // Set up the warmpup sweep details:  one run of each sort at the maximum
+  // size, with seed 0.
+  BenchSweepDetails warmup_sweep = main_sweep;
+  warmup_sweep.seed_base = 0;
+  warmup_sweep.min_reps = warmup_sweep.max_reps = 1;
+  warmup_sweep.dump = NULL;
+  warmup_sweep.size_lo = max_bytes;
 
-  // Main benchmark.  
-  // Sweep over a range of memory sizes, and use multiple seeds.
-  print_csv_header("Elems");
-  run_benchmark_suite_size_sweep(&main_sweep);
-  
+  // Give the gather-sort-relink sorts enough scratch for the largest list.
+  const GatherScratch scratch =
+      alloc_gather_scratch(lnb_ops, max_bytes / lnb_ops->size);
+  use_gather_scratch(&scratch);
+
+  if (small_elems) {
+    // Warm up with one unreported batch at the largest size, then run
+    // small-list mode instead of the size sweep.
+    const size_t elems = (size_t)small_elems;
+    measure_at_single_size(&warmup_sweep, elems,
+                           batch_size(&warmup_sweep, elems));
+    run_small_list_mode(&main_sweep, elems);
+  } else {
+    // Warmup.  Run the sorts on a max-size buffer with a single seed.
+    print_csv_header("Warmup", &sorts);
+    run_benchmark_suite_size_sweep(&warmup_sweep);
+
+    // Main benchmark.
+    // Sweep over a range of memory sizes, and use multiple seeds.
+    print_csv_header("Elems", &sorts);
+    run_benchmark_suite_size_sweep(&main_sweep);
+  }
+
+  if (dump) {
+    fclose(dump);
+  }
+  cache_flush_close(&flush);
   printf("PASS\n");
 }
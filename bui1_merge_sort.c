@@ -6,6 +6,8 @@
 
 #include <stddef.h>
 
+#include "list_instrument.h"
+
 #define MAX_STACK (64)
 
 typedef struct {
@@ -28,6 +30,8 @@ static inline ListNode *push_first(
   stk->stk[stk->top++] = sn;
   ListNode *rest = first->next;
   first->next = NULL;
+  LIST_COUNT_VISIT();
+  LIST_COUNT_LINK();
   return rest;
 }
 
@@ -54,7 +58,7 @@ static inline int peek_length(Stack *const restrict stk, const int dist) {
 ListNode *bui1_merge_sort(ListNode *const first,
                           ListNodeCompareFxn *const cmp) {
   // Handle degenerate cases of an empty list or a single-node list.
-  if (!first || !first->next) {
+  if (!first || !LIST_VISIT_NEXT(first)) {
     return first;
   }
 
@@ -87,10 +91,13 @@ ListNode *bui1_merge_sort(ListNode *const first,
         *pnext = *l;
         pnext = &(*pnext)->next;
         *l = (*l)->next;
+        LIST_COUNT_LINK();
+        LIST_COUNT_VISIT();
       }
 
       // Once we exhaust one list, append the other as-is to the merged list.
       *pnext = a ? a : b;
+      LIST_COUNT_LINK();
 
       push_list(&stk, length, merged);
     }
@@ -4,8 +4,11 @@
 // SPDX-License-Identifier:  CC-BY-SA-4.0
 #include "bui2_merge_sort.h"
 
+#include <stdbool.h>
 #include <stddef.h>
 
+#include "list_instrument.h"
+
 #define MAX_STACK (64)
 
 typedef struct {
@@ -29,12 +32,17 @@ static inline ListNode *push_first(
     ListNode *a = first;
     ListNode *b = a->next;
     ListNode *rest = b->next;
+    LIST_COUNT_VISIT();
+    LIST_COUNT_VISIT();
     if (cmp(a, b)) {
       b->next = NULL;
+      LIST_COUNT_LINK();
     } else {
       a->next = NULL;
       b->next = a;
       a = b;
+      LIST_COUNT_LINK();
+      LIST_COUNT_LINK();
     }
     const StackNode sn = { .length = 2, .node = a };
     stk->stk[stk->top++] = sn;
@@ -45,6 +53,8 @@ static inline ListNode *push_first(
   const StackNode sn = { .length = 1, .node = first };
   first->next = NULL;
   stk->stk[stk->top++] = sn;
+  LIST_COUNT_VISIT();
+  LIST_COUNT_LINK();
 
   return rest;
 }
@@ -69,11 +79,13 @@ static inline int peek_length(Stack *const restrict stk, const int dist) {
 // Implements a merge sort on a singly linked list, using a bottom-up iterative
 // power-of-2 collapsing merge sort, based on a strawman I posted here:
 // https://www.quora.com/Which-is-the-best-the-most-efficient-sorting-algorithm-implemented-by-linked-list-Merge-sort-Insertion-sort-heap-sort-or-Quick-sort/answer/David-Vandevoorde?comment_id=216999829&comment_type=2
-// Includes a minor optimization to sort pairs of nodes at the leaves.
-ListNode *bui2_merge_sort(ListNode *const first,
-                          ListNodeCompareFxn *const cmp) {
+// Includes a minor optimization to sort pairs of nodes at the leaves.  Counts
+// its passes if 'count_passes' is set.
+static inline ListNode *merge_sort(ListNode *const first,
+                                   ListNodeCompareFxn *const cmp,
+                                   const bool count_passes) {
   // Handle degenerate cases of an empty list or a single-node list.
-  if (!first || !first->next) {
+  if (!first || !LIST_VISIT_NEXT(first)) {
     return first;
   }
 
@@ -81,8 +93,14 @@ ListNode *bui2_merge_sort(ListNode *const first,
   Stack stk;
   stk.top = 0;
 
-  // Push the first pair of nodes onto the stack.
+  // Push the first pair of nodes onto the stack.  Pairing up the nodes counts
+  // as the first pass, and each merge into a longer list than any before
+  // starts another.
   ListNode *rest = push_first(&stk, first, cmp);
+  size_t longest = 2;
+  if (count_passes) {
+    LIST_COUNT_PASS();
+  }
 
   // While there's sub-lists to merge, keep merging. 
   do {
@@ -91,6 +109,10 @@ ListNode *bui2_merge_sort(ListNode *const first,
            (!rest || peek_length(&stk, 1) >= peek_length(&stk, 2))) {
       // Extract the top two nodes from the stack to merge.
       const size_t length = peek_length(&stk, 1) + peek_length(&stk, 2);
+      if (count_passes && length > longest) {
+        longest = length;
+        LIST_COUNT_PASS();
+      }
       ListNode *a = pop_list(&stk);
       ListNode *b = pop_list(&stk);
 
@@ -106,10 +128,13 @@ ListNode *bui2_merge_sort(ListNode *const first,
         *pnext = *l;
         pnext = &(*pnext)->next;
         *l = (*l)->next;
+        LIST_COUNT_LINK();
+        LIST_COUNT_VISIT();
       }
 
       // Once we exhaust one list, append the other as-is to the merged list.
       *pnext = a ? a : b;
+      LIST_COUNT_LINK();
 
       push_list(&stk, length, merged);
     }
@@ -124,3 +149,15 @@ ListNode *bui2_merge_sort(ListNode *const first,
   // Return the final merged result.
   return pop_list(&stk);
 }
+
+// Sorts a whole list with the merge sort above.
+ListNode *bui2_merge_sort(ListNode *const first,
+                          ListNodeCompareFxn *const cmp) {
+  return merge_sort(first, cmp, true);
+}
+
+// Sorts part of a larger list with the merge sort above.
+ListNode *bui2_merge_sort_part(ListNode *const first,
+                               ListNodeCompareFxn *const cmp) {
+  return merge_sort(first, cmp, false);
+}
@@ -13,4 +13,8 @@
 // https://www.quora.com/Which-is-the-best-the-most-efficient-sorting-algorithm-implemented-by-linked-list-Merge-sort-Insertion-sort-heap-sort-or-Quick-sort/answer/David-Vandevoorde?comment_id=216999829&comment_type=2
 ListNode *bui2_merge_sort(ListNode *first, ListNodeCompareFxn *cmp);
 
+// Same as bui2_merge_sort, for the sorts that use it on pieces of a larger
+// list.  It doesn't count its passes, since they don't cover the whole list.
+ListNode *bui2_merge_sort_part(ListNode *first, ListNodeCompareFxn *cmp);
+
 #endif  // BUI2_MERGE_SORT_H_
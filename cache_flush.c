@@ -0,0 +1,192 @@
+// Evicts a list from the caches, and optionally the TLBs, before a timed sort,
+// so the sort sees memory the way it would if the list was built long ago.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#include "cache_flush.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+# include <x86intrin.h>
+# define HAVE_CLFLUSH (1)
+#else
+# define HAVE_CLFLUSH (0)
+#endif
+
+#define CACHE_LINE_BYTES (64)
+#define SMALL_PAGE_BYTES (4096)
+
+// Our guess at the last-level cache size when the system won't say.
+#define DEFAULT_LLC_BYTES (64u << 20)
+
+// Touching one line in each of this many 4KiB pages pushes every other
+// translation out of the TLBs.  It's several times the reach of the largest
+// second-level TLBs.
+#define TLB_EVICT_PAGES (16384)
+
+static const char *const kind_names[] = {
+  [CACHE_FLUSH_NONE] = "none",
+  [CACHE_FLUSH_SWEEP] = "sweep",
+  [CACHE_FLUSH_CLFLUSH] = "clflush"
+};
+
+// Parses a flush method, optionally followed by ":tlb".
+bool cache_flush_parse(const char *const spec, CacheFlushMode *const mode) {
+  const char *const colon = strchr(spec, ':');
+  const size_t name_len = colon ? (size_t)(colon - spec) : strlen(spec);
+
+  if (colon && strcmp(colon + 1, "tlb")) {
+    return false;
+  }
+
+  for (size_t i = 0; i < sizeof(kind_names) / sizeof(kind_names[0]); ++i) {
+    if (strlen(kind_names[i]) == name_len &&
+        !strncmp(spec, kind_names[i], name_len)) {
+      if ((i == CACHE_FLUSH_CLFLUSH && !HAVE_CLFLUSH) ||
+          (i == CACHE_FLUSH_NONE && colon)) {
+        return false;
+      }
+      mode->kind = (CacheFlushKind)i;
+      mode->tlb = colon != NULL;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Writes a flush method to 'str'.
+void cache_flush_name(const CacheFlushMode mode, char *const str,
+                      const size_t size) {
+  snprintf(str, size, "%s%s", kind_names[mode.kind], mode.tlb ? ":tlb" : "");
+}
+
+// Returns the size of the last-level cache.
+size_t cache_flush_llc_bytes(void) {
+  const long l3 = sysconf(_SC_LEVEL3_CACHE_SIZE);
+  if (l3 > 0) {
+    return (size_t)l3;
+  }
+  const long l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+  return l2 > 0 ? (size_t)l2 : DEFAULT_LLC_BYTES;
+}
+
+// Returns the bytes cache_flush_open allocates.
+size_t cache_flush_buf_bytes(const CacheFlushMode mode) {
+  size_t bytes = 0;
+  if (mode.kind == CACHE_FLUSH_SWEEP) {
+    bytes += 2 * cache_flush_llc_bytes();
+  }
+  if (mode.tlb) {
+    bytes += (size_t)TLB_EVICT_PAGES * SMALL_PAGE_BYTES;
+  }
+  return bytes;
+}
+
+// Allocates the buffers.  The sweep buffer gets huge pages, so that sweeping
+// it doesn't also sweep the TLBs unless we ask for that.  The TLB eviction
+// buffer needs small pages, one translation per touch.
+bool cache_flush_open(CacheFlush *const flush, const CacheFlushMode mode) {
+  memset(flush, 0, sizeof(*flush));
+  flush->mode = mode;
+
+  if (mode.kind == CACHE_FLUSH_SWEEP &&
+      !page_buf_alloc(&flush->sweep, 2 * cache_flush_llc_bytes(),
+                      PAGE_BUF_THP)) {
+    return false;
+  }
+  if (mode.tlb &&
+      !page_buf_alloc(&flush->tlb, (size_t)TLB_EVICT_PAGES * SMALL_PAGE_BYTES,
+                      PAGE_BUF_4K)) {
+    cache_flush_close(flush);
+    return false;
+  }
+  return true;
+}
+
+// Frees the buffers.
+void cache_flush_close(CacheFlush *const flush) {
+  if (flush->sweep.ptr) {
+    page_buf_free(&flush->sweep);
+  }
+  if (flush->tlb.ptr) {
+    page_buf_free(&flush->tlb);
+  }
+  memset(flush, 0, sizeof(*flush));
+}
+
+// Keeps the compiler from optimizing away the loads.
+static volatile uint64_t sink;
+
+// Reads one word from each cache line of the sweep buffer.
+static void sweep_caches(const PageBuf *const buf) {
+  const uint64_t *const words = buf->ptr;
+  const size_t stride = CACHE_LINE_BYTES / sizeof(uint64_t);
+  const size_t count = buf->bytes / sizeof(uint64_t);
+  uint64_t sum = 0;
+  for (size_t i = 0; i < count; i += stride) {
+    sum += words[i];
+  }
+  sink = sum;
+}
+
+// Reads one line from each page of the TLB eviction buffer.  The line moves
+// along each page, so the loads don't all land in the same cache set.
+static void evict_tlbs(const PageBuf *const buf) {
+  const char *const bytes = buf->ptr;
+  const size_t pages = buf->bytes / SMALL_PAGE_BYTES;
+  uint64_t sum = 0;
+  for (size_t i = 0; i < pages; ++i) {
+    const size_t line = i % (SMALL_PAGE_BYTES / CACHE_LINE_BYTES);
+    sum += bytes[i * SMALL_PAGE_BYTES + line * CACHE_LINE_BYTES];
+  }
+  sink = sum;
+}
+
+#if HAVE_CLFLUSH
+// Walks a list, flushing every cache line each node touches.
+static void clflush_list(const ListNode *node, const size_t node_size) {
+  while (node) {
+    const ListNode *const next = node->next;
+    const uintptr_t first = (uintptr_t)node & -(uintptr_t)CACHE_LINE_BYTES;
+    const uintptr_t last = (uintptr_t)node + node_size - 1;
+    for (uintptr_t line = first; line <= last; line += CACHE_LINE_BYTES) {
+      _mm_clflush((const void *)line);
+    }
+    node = next;
+  }
+}
+#endif
+
+// Evicts the lists.
+void cache_flush_lists(const CacheFlush *const flush,
+                       ListNode *const *const lists, const size_t count,
+                       const size_t node_size) {
+  switch (flush->mode.kind) {
+    case CACHE_FLUSH_NONE:
+      break;
+
+    case CACHE_FLUSH_SWEEP:
+      sweep_caches(&flush->sweep);
+      break;
+
+    case CACHE_FLUSH_CLFLUSH:
+#if HAVE_CLFLUSH
+      for (size_t i = 0; i < count; ++i) {
+        clflush_list(lists[i], node_size);
+      }
+      _mm_mfence();
+#endif
+      break;
+  }
+
+  if (flush->mode.tlb) {
+    evict_tlbs(&flush->tlb);
+  }
+  (void)lists;
+  (void)count;
+  (void)node_size;
+}
@@ -0,0 +1,64 @@
+// Evicts a list from the caches, and optionally the TLBs, before a timed sort,
+// so the sort sees memory the way it would if the list was built long ago.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#ifndef CACHE_FLUSH_H_
+#define CACHE_FLUSH_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "list_node.h"
+#include "page_buf.h"
+
+// Selects how to evict the list from the caches.
+typedef enum {
+  CACHE_FLUSH_NONE,     // Don't.  The list stays as warm as generating it
+                        // left it.
+  CACHE_FLUSH_SWEEP,    // Read a buffer twice the size of the last-level
+                        // cache, pushing everything else out.
+  CACHE_FLUSH_CLFLUSH   // Walk the list, flushing each node's cache lines.
+                        // Only the list leaves the caches.  x86 only.
+} CacheFlushKind;
+
+// A flush method, and whether to evict the TLBs too.
+typedef struct {
+  CacheFlushKind kind;
+  bool tlb;
+} CacheFlushMode;
+
+// The buffers a flush method needs.
+typedef struct {
+  CacheFlushMode mode;
+  PageBuf sweep;  // For CACHE_FLUSH_SWEEP.
+  PageBuf tlb;    // For evicting the TLBs.
+} CacheFlush;
+
+// Parses a flush method ("none", "sweep" or "clflush"), optionally followed by
+// ":tlb" to evict the TLBs too.  Returns false if it doesn't recognize the
+// method, or the method isn't available on this CPU.
+bool cache_flush_parse(const char *spec, CacheFlushMode *mode);
+
+// Writes a flush method in the form cache_flush_parse accepts to 'str'.
+void cache_flush_name(CacheFlushMode mode, char *str, size_t size);
+
+// Returns the size of the last-level cache, or a guess if the system won't
+// say.
+size_t cache_flush_llc_bytes(void);
+
+// Returns the bytes cache_flush_open allocates for 'mode'.
+size_t cache_flush_buf_bytes(CacheFlushMode mode);
+
+// Allocates the buffers for 'mode'.  Returns false if it can't.
+bool cache_flush_open(CacheFlush *flush, CacheFlushMode mode);
+
+// Frees the buffers.
+void cache_flush_close(CacheFlush *flush);
+
+// Evicts 'count' lists of nodes 'node_size' bytes each from the caches, and
+// the TLBs if the mode says to.
+void cache_flush_lists(const CacheFlush *flush, ListNode *const *lists,
+                       size_t count, size_t node_size);
+
+#endif  // CACHE_FLUSH_H_
@@ -0,0 +1,146 @@
+// Implements a bottom-up iterative merge sort on a linked list, with
+// branch-free merges.
+//
+// Author:  agent <agent@local>
+// Based on bui2_merge_sort.c by Joe Zbiciak.
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#include "cbi2_merge_sort.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "list_instrument.h"
+#include "list_merge.h"
+
+#define MAX_STACK (64)
+
+typedef struct {
+  size_t length;
+  ListNode *node;
+} StackNode;
+
+typedef struct {
+  int top;
+  StackNode stk[MAX_STACK];
+} Stack;
+
+// Pushes the first nodes from the rest of the list onto the top of stack, and
+// returns the rest of the list.  Sorts the first two nodes, picking their
+// order with masks.
+static inline ListNode *push_first(
+    Stack *const restrict stk,
+    ListNode *first,
+    ListNodeCompareFxn *const cmp,
+    const size_t key_offset
+) {
+  if (first->next) {
+    ListNode *const a = first;
+    ListNode *const b = a->next;
+    ListNode *const rest = b->next;
+    LIST_COUNT_VISIT();
+    LIST_COUNT_VISIT();
+    const bool in_order = list_merge_less(a, b, cmp, key_offset);
+    ListNode *const lo = list_merge_select(in_order, a, b);
+    ListNode *const hi = list_merge_select(in_order, b, a);
+    lo->next = hi;
+    hi->next = NULL;
+    LIST_COUNT_LINK();
+    LIST_COUNT_LINK();
+    const StackNode sn = { .length = 2, .node = lo };
+    stk->stk[stk->top++] = sn;
+    return rest;
+  }
+
+  ListNode *rest = first->next;
+  const StackNode sn = { .length = 1, .node = first };
+  first->next = NULL;
+  stk->stk[stk->top++] = sn;
+  LIST_COUNT_VISIT();
+  LIST_COUNT_LINK();
+
+  return rest;
+}
+
+// Pushes a sub-list onto the stack, along with its length.
+static inline void push_list(Stack *const restrict stk, const int length,
+                             ListNode *const node) {
+  const StackNode sn = { .length = length, .node = node };
+  stk->stk[stk->top++] = sn;
+}
+
+// Pops the top of stack, returning the ListNode* at the top.
+static inline ListNode *pop_list(Stack *const restrict stk) {
+  return stk->stk[--stk->top].node;
+}
+
+// Returns the length of the nth previous stack push.
+static inline int peek_length(Stack *const restrict stk, const int dist) {
+  return stk->stk[stk->top - dist].length;
+}
+
+// Implements bui2_merge_sort with branch-free merges.  Compares with 'cmp', or
+// inline as int64_ts at 'key_offset' if 'cmp' is NULL.
+static inline ListNode *cbi2_merge_sort_internal(
+    ListNode *const first,
+    ListNodeCompareFxn *const cmp,
+    const size_t key_offset
+) {
+  // Handle degenerate cases of an empty list or a single-node list.
+  if (!first || !LIST_VISIT_NEXT(first)) {
+    return first;
+  }
+
+  // Our stack of partially merged lists.  Only need to initialize stk.top.
+  Stack stk;
+  stk.top = 0;
+
+  // Push the first pair of nodes onto the stack.
+  ListNode *rest = push_first(&stk, first, cmp, key_offset);
+
+  // While there's sub-lists to merge, keep merging.
+  do {
+    // Merge sub-lists at top of stack, if possible.
+    while (stk.top > 1 &&
+           (!rest || peek_length(&stk, 1) >= peek_length(&stk, 2))) {
+      // Extract the top two nodes from the stack to merge.
+      const size_t length = peek_length(&stk, 1) + peek_length(&stk, 2);
+      ListNode *a = pop_list(&stk);
+      ListNode *b = pop_list(&stk);
+      ListNode *merged = NULL;
+      ListNode **pnext = &merged;
+
+      // Take the smallest from a or b, as long as both lists are non-empty.
+      while (a && b) {
+        const bool take_a = list_merge_less(a, b, cmp, key_offset);
+        pnext = list_merge_take(take_a, &a, &b, pnext);
+      }
+
+      // Once we exhaust one list, append the other as-is to the merged list.
+      *pnext = a ? a : b;
+      LIST_COUNT_LINK();
+
+      push_list(&stk, length, merged);
+    }
+
+    // If there are more unsorted nodes, add a new sub-list containing the next
+    // item from it.  Try to push a sorted pair if we can.
+    if (rest) {
+      rest = push_first(&stk, rest, cmp, key_offset);
+    }
+  } while (stk.top > 1);
+
+  // Return the final merged result.
+  return pop_list(&stk);
+}
+
+// Implements bui2_merge_sort with branch-free merges.
+ListNode *cbi2_merge_sort(ListNode *const first,
+                          ListNodeCompareFxn *const cmp) {
+  return cbi2_merge_sort_internal(first, cmp, 0);
+}
+
+// Same as above, comparing int64_t keys inline.
+ListNode *cbi2_merge_sort_int64(ListNode *const first,
+                                const size_t key_offset) {
+  return cbi2_merge_sort_internal(first, NULL, key_offset);
+}
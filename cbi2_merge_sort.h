@@ -0,0 +1,24 @@
+// Implements a bottom-up iterative merge sort on a linked list, with
+// branch-free merges.
+//
+// Author:  agent <agent@local>
+// Based on bui2_merge_sort.c by Joe Zbiciak.
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#ifndef CBI2_MERGE_SORT_H_
+#define CBI2_MERGE_SORT_H_
+
+#include <stddef.h>
+
+#include "list_node.h"
+#include "list_sort.h"
+
+// Implements bui2_merge_sort, with each merge step and each leaf pair picking
+// its node with masks rather than branching on the comparison.
+ListNode *cbi2_merge_sort(ListNode *first, ListNodeCompareFxn *cmp);
+
+// Same as above, for nodes that each hold a signed int64_t key 'key_offset'
+// bytes from the start of the node.  Compares the keys inline instead of
+// calling a comparison function.
+ListNode *cbi2_merge_sort_int64(ListNode *first, size_t key_offset);
+
+#endif  // CBI2_MERGE_SORT_H_
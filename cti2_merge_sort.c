@@ -0,0 +1,107 @@
+// Top-down Iterative Merge Sort with O(1) auxillary storage, with branch-free
+// merges.
+//
+// Author:  agent <agent@local>
+// Based on tdi2_merge_sort.c by Drew Eckhardt and Joe Zbiciak.
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#include "cti2_merge_sort.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "list_instrument.h"
+#include "list_merge.h"
+
+// Implements tdi2_merge_sort with branch-free merges.  Compares with 'cmp', or
+// inline as int64_ts at 'key_offset' if 'cmp' is NULL.
+static inline ListNode *cti2_merge_sort_internal(
+    ListNode *const src,
+    ListNodeCompareFxn *const cmp,
+    const size_t key_offset
+) {
+  ListNode *rest, *out_head, **out_tail;
+  size_t increment = 1, size = 0;
+
+  // Scan once to find our size.
+  for (ListNode *n = src; n; n = n->next) {
+    size++;
+    LIST_COUNT_VISIT();
+  }
+
+  rest = src;
+  while (increment < size) {
+    out_head = NULL;
+    out_tail = &out_head;
+
+    while (rest) {
+      size_t ar = increment, br = increment;
+      ListNode *a = rest;
+      ListNode *b = a;
+
+      // Find the start of 'b'.
+      for (size_t i = 0; i < increment && b; ++i) {
+        b = b->next;
+        LIST_COUNT_VISIT();
+      }
+
+      // If 'a' was shorter than increment, just append it and break out.
+      if (!b) {
+        rest = NULL;
+        *out_tail = a;
+        LIST_COUNT_LINK();
+        break;
+      }
+
+      // Merge 'b' into 'a'.  The counts come down by the comparison's result,
+      // rather than on one side of a branch.
+      while (ar && br && b) {
+        const bool take_a = list_merge_less(a, b, cmp, key_offset);
+        out_tail = list_merge_take(take_a, &a, &b, out_tail);
+        ar -= take_a;
+        br -= !take_a;
+      }
+
+      // Push any remaining 'a' nodes.
+      while (ar) {
+        *out_tail = a;
+        out_tail = &a->next;
+        a = a->next;
+        --ar;
+        LIST_COUNT_LINK();
+        LIST_COUNT_VISIT();
+      }
+
+      // Push any remaining 'b' nodes. 'b' can end early.
+      while (br && b) {
+        *out_tail = b;
+        out_tail = &b->next;
+        b = b->next;
+        --br;
+        LIST_COUNT_LINK();
+        LIST_COUNT_VISIT();
+      }
+
+      // Terminate our partial list.
+      *out_tail = NULL;
+      LIST_COUNT_LINK();
+
+      // The final advance on 'b' will make it point to 'rest'.
+      rest = b;
+    }
+
+    increment *= 2;
+    rest = out_head;
+  }
+
+  return rest;
+}
+
+// Implements tdi2_merge_sort with branch-free merges.
+ListNode *cti2_merge_sort(ListNode *const src, ListNodeCompareFxn *const cmp) {
+  return cti2_merge_sort_internal(src, cmp, 0);
+}
+
+// Same as above, comparing int64_t keys inline.
+ListNode *cti2_merge_sort_int64(ListNode *const src, const size_t key_offset) {
+  return cti2_merge_sort_internal(src, NULL, key_offset);
+}
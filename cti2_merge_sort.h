@@ -0,0 +1,25 @@
+// Top-down Iterative Merge Sort with O(1) auxillary storage, with branch-free
+// merges.
+//
+// Author:  agent <agent@local>
+// Based on tdi2_merge_sort.c by Drew Eckhardt and Joe Zbiciak.
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#ifndef CTI2_MERGE_SORT_H_
+#define CTI2_MERGE_SORT_H_
+
+#include <stddef.h>
+
+#include "list_node.h"
+#include "list_sort.h"
+
+// Implements tdi2_merge_sort, with each merge step picking its node and
+// counting down its sub-list with masks rather than branching on the
+// comparison.
+ListNode *cti2_merge_sort(ListNode *src, ListNodeCompareFxn *cmp);
+
+// Same as above, for nodes that each hold a signed int64_t key 'key_offset'
+// bytes from the start of the node.  Compares the keys inline instead of
+// calling a comparison function.
+ListNode *cti2_merge_sort_int64(ListNode *src, size_t key_offset);
+
+#endif  // CTI2_MERGE_SORT_H_
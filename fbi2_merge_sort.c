@@ -0,0 +1,142 @@
+// Implements a bottom-up iterative merge sort on a linked list, with software
+// prefetching in the merges.
+//
+// Author:  agent <agent@local>
+// Based on bui2_merge_sort.c by Joe Zbiciak.
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#include "fbi2_merge_sort.h"
+
+#include <stddef.h>
+
+#include "list_instrument.h"
+#include "list_prefetch.h"
+
+#define MAX_STACK (64)
+
+static int fbi2_distance = LIST_PREFETCH_DEFAULT_DISTANCE;
+
+// Sets the prefetch distance fbi2_merge_sort uses.  Zero turns prefetching
+// off.
+void fbi2_merge_sort_set_distance(const int distance) {
+  fbi2_distance = distance < 0 ? 0 : distance;
+}
+
+typedef struct {
+  size_t length;
+  ListNode *node;
+} StackNode;
+
+typedef struct {
+  int top;
+  StackNode stk[MAX_STACK];
+} Stack;
+
+// Pushes the first nodes from the rest of the list onto the top of stack, and
+// returns the rest of the list.  Sorts the first two nodes.
+static inline ListNode *push_first(
+    Stack *const restrict stk,
+    ListNode *first,
+    ListNodeCompareFxn *const cmp
+) {
+  if (first->next) {
+    ListNode *a = first;
+    ListNode *b = a->next;
+    ListNode *rest = b->next;
+    LIST_COUNT_VISIT();
+    LIST_COUNT_VISIT();
+    if (cmp(a, b)) {
+      b->next = NULL;
+      LIST_COUNT_LINK();
+    } else {
+      a->next = NULL;
+      b->next = a;
+      a = b;
+      LIST_COUNT_LINK();
+      LIST_COUNT_LINK();
+    }
+    const StackNode sn = { .length = 2, .node = a };
+    stk->stk[stk->top++] = sn;
+    return rest;
+  }
+
+  ListNode *rest = first->next;
+  const StackNode sn = { .length = 1, .node = first };
+  first->next = NULL;
+  stk->stk[stk->top++] = sn;
+  LIST_COUNT_VISIT();
+  LIST_COUNT_LINK();
+
+  return rest;
+}
+
+// Pushes a sub-list onto the stack, along with its length.
+static inline void push_list(Stack *const restrict stk, const int length,
+                             ListNode *const node) {
+  const StackNode sn = { .length = length, .node = node };
+  stk->stk[stk->top++] = sn;
+}
+
+// Pops the top of stack, returning the ListNode* at the top.
+static inline ListNode *pop_list(Stack *const restrict stk) {
+  return stk->stk[--stk->top].node;
+}
+
+// Returns the length of the nth previous stack push.
+static inline int peek_length(Stack *const restrict stk, const int dist) {
+  return stk->stk[stk->top - dist].length;
+}
+
+// Implements bui2_merge_sort, with the merges running lookahead cursors
+// 'distance' nodes ahead along both input sub-lists.  Merges of sub-lists no
+// longer than the distance skip prefetching:  priming the cursors would cost
+// as much as the merge itself.
+ListNode *fbi2_merge_sort_distance(ListNode *const first,
+                                   ListNodeCompareFxn *const cmp,
+                                   const int distance) {
+  // Handle degenerate cases of an empty list or a single-node list.
+  if (!first || !LIST_VISIT_NEXT(first)) {
+    return first;
+  }
+
+  // Our stack of partially merged lists.  Only need to initialize stk.top.
+  Stack stk;
+  stk.top = 0;
+
+  // Push the first pair of nodes onto the stack.
+  ListNode *rest = push_first(&stk, first, cmp);
+
+  // While there's sub-lists to merge, keep merging. 
+  do {
+    // Merge sub-lists at top of stack, if possible.
+    while (stk.top > 1 &&
+           (!rest || peek_length(&stk, 1) >= peek_length(&stk, 2))) {
+      // Extract the top two nodes from the stack to merge.  The one on top
+      // is never the longer of the two.
+      const int shorter = peek_length(&stk, 1);
+      const size_t length = peek_length(&stk, 1) + peek_length(&stk, 2);
+      ListNode *a = pop_list(&stk);
+      ListNode *b = pop_list(&stk);
+
+      ListNode *const merged = list_prefetch_merge(
+          a, b, cmp, shorter > distance ? distance : 0);
+
+      push_list(&stk, length, merged);
+    }
+
+    // If there are more unsorted nodes, add a new sub-list containing the next
+    // item from it.  Try to push a sorted pair if we can.
+    if (rest) {
+      rest = push_first(&stk, rest, cmp);
+    }
+  } while (stk.top > 1);
+
+  // Return the final merged result.
+  return pop_list(&stk);
+}
+
+// Same as above, using the prefetch distance set by
+// fbi2_merge_sort_set_distance.
+ListNode *fbi2_merge_sort(ListNode *const first,
+                          ListNodeCompareFxn *const cmp) {
+  return fbi2_merge_sort_distance(first, cmp, fbi2_distance);
+}
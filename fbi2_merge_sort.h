@@ -0,0 +1,25 @@
+// Implements a bottom-up iterative merge sort on a linked list, with software
+// prefetching in the merges.
+//
+// Author:  agent <agent@local>
+// Based on bui2_merge_sort.c by Joe Zbiciak.
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#ifndef FBI2_MERGE_SORT_H_
+#define FBI2_MERGE_SORT_H_
+
+#include "list_node.h"
+#include "list_sort.h"
+
+// Sets the prefetch distance, in nodes, fbi2_merge_sort uses.  Zero turns
+// prefetching off.  The default is LIST_PREFETCH_DEFAULT_DISTANCE.
+void fbi2_merge_sort_set_distance(int distance);
+
+// Implements bui2_merge_sort, with each merge running lookahead cursors
+// 'distance' nodes ahead along both input sub-lists, prefetching as they go.
+ListNode *fbi2_merge_sort_distance(ListNode *first, ListNodeCompareFxn *cmp,
+                                   int distance);
+
+// Same as above, using the distance set by fbi2_merge_sort_set_distance.
+ListNode *fbi2_merge_sort(ListNode *first, ListNodeCompareFxn *cmp);
+
+#endif  // FBI2_MERGE_SORT_H_
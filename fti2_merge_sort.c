@@ -0,0 +1,137 @@
+// Top-down Iterative Merge Sort with O(1) auxillary storage.  Modified to
+// measure list length up front and merge the second sublist during extraction
+// from the main list.  This version adds software prefetching to the merges.
+//
+// Primary author:  Drew Eckhardt
+// Secondary author:  Joe Zbiciak
+// Prefetching version:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#include "fti2_merge_sort.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "list_instrument.h"
+#include "list_prefetch.h"
+
+static int fti2_distance = LIST_PREFETCH_DEFAULT_DISTANCE;
+
+// Sets the prefetch distance fti2_merge_sort uses.  Zero turns prefetching
+// off.
+void fti2_merge_sort_set_distance(const int distance) {
+  fti2_distance = distance < 0 ? 0 : distance;
+}
+
+// Implements a top-down iterative list merge sort with O(1) auxillary storage,
+// from Drew Eckhardt's post here:
+// https://www.quora.com/What-is-the-best-way-to-sort-an-unsorted-linked-list/answers/3873494
+//
+// Modified by Joe Zbiciak (joe.zbiciak@leftturnonly.info) to measure the list
+// length once up front, and to merge sub-lists while extracting them from the
+// main list.  The merges run lookahead cursors 'distance' nodes ahead along
+// both sub-lists, once the sub-lists are longer than 'distance'.
+ListNode *fti2_merge_sort_distance(ListNode *const src,
+                                   ListNodeCompareFxn *const cmp,
+                                   const int distance) {
+  ListNode *rest, *out_head, **out_tail;
+  size_t increment = 1, size = 0;
+
+  // Scan once to find our size.
+  for (ListNode *n = src; n; n = n->next) {
+    size++;
+    LIST_COUNT_VISIT();
+  }
+
+  rest = src;
+  while (increment < size) {
+    out_head = NULL;
+    out_tail = &out_head;
+
+    while (rest) {
+      size_t ar = increment, br = increment;
+      ListNode *a = rest;
+      ListNode *b = a;
+
+      // Find the start of 'b'.  Pick up 'a's lookahead cursor on the way.
+      const bool prefetch = distance > 0 && increment > (size_t)distance;
+      ListNode *ahead_a = NULL;
+      for (size_t i = 0; i < increment && b; ++i) {
+        b = b->next;
+        LIST_COUNT_VISIT();
+        if (prefetch && i + 1 == (size_t)distance) {
+          ahead_a = b;
+        }
+      }
+
+      // If 'a' was shorter than increment, just append it and break out.
+      if (!b) {
+        rest = NULL;
+        *out_tail = a;
+        LIST_COUNT_LINK();
+        break;
+      }
+
+      // Merge 'b' into 'a', advancing the lookahead cursors along with them.
+      // They run off the ends of the sub-lists into the nodes that follow,
+      // which the next merge wants anyway.
+      ListNode *ahead_b = prefetch ? list_prefetch_ahead(b, distance) : NULL;
+      while (ar && br && b) {
+        if (cmp(a, b)) {
+          --ar;
+          *out_tail = a;
+          out_tail = &a->next;
+          a = a->next;
+          ahead_a = list_prefetch_advance(ahead_a);
+          LIST_COUNT_LINK();
+          LIST_COUNT_VISIT();
+        } else {
+          --br;
+          *out_tail = b;
+          out_tail = &b->next;
+          b = b->next;
+          ahead_b = list_prefetch_advance(ahead_b);
+          LIST_COUNT_LINK();
+          LIST_COUNT_VISIT();
+        }
+      }
+
+      // Push any remaining 'a' nodes.
+      while (ar) {
+        *out_tail = a;
+        out_tail = &a->next;
+        a = a->next;
+        --ar;
+        LIST_COUNT_LINK();
+        LIST_COUNT_VISIT();
+      }
+
+      // Push any remaining 'b' nodes. 'b' can end early.
+      while (br && b) {
+        *out_tail = b;
+        out_tail = &b->next;
+        b = b->next;
+        --br;
+        LIST_COUNT_LINK();
+        LIST_COUNT_VISIT();
+      }
+
+      // Terminate our partial list.
+      *out_tail = NULL;
+      LIST_COUNT_LINK();
+
+      // The final advance on 'b' will make it point to 'rest'.
+      rest = b;
+    }
+
+    increment *= 2;
+    rest = out_head;
+  }
+
+  return rest;
+}
+
+// Same as above, using the prefetch distance set by
+// fti2_merge_sort_set_distance.
+ListNode *fti2_merge_sort(ListNode *const src, ListNodeCompareFxn *const cmp) {
+  return fti2_merge_sort_distance(src, cmp, fti2_distance);
+}
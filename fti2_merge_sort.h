@@ -0,0 +1,27 @@
+// Top-down Iterative Merge Sort with O(1) auxillary storage.  Modified to
+// measure list length up front and merge the second sublist during extraction
+// from the main list.  This version adds software prefetching to the merges.
+//
+// Primary author:  Drew Eckhardt
+// Secondary author:  Joe Zbiciak
+// Prefetching version:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#ifndef FTI2_MERGE_SORT_H_
+#define FTI2_MERGE_SORT_H_
+
+#include "list_node.h"
+#include "list_sort.h"
+
+// Sets the prefetch distance, in nodes, fti2_merge_sort uses.  Zero turns
+// prefetching off.  The default is LIST_PREFETCH_DEFAULT_DISTANCE.
+void fti2_merge_sort_set_distance(int distance);
+
+// Implements tdi2_merge_sort, with each merge running lookahead cursors
+// 'distance' nodes ahead along both sub-lists, prefetching as they go.
+ListNode *fti2_merge_sort_distance(ListNode *src, ListNodeCompareFxn *cmp,
+                                   int distance);
+
+// Same as above, using the distance set by fti2_merge_sort_set_distance.
+ListNode *fti2_merge_sort(ListNode *src, ListNodeCompareFxn *cmp);
+
+#endif  // FTI2_MERGE_SORT_H_
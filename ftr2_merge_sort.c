@@ -0,0 +1,100 @@
+// Top-down Recursive Merge Sort, measuring list length up front.
+//
+// Author:  agent <agent@local>
+// Based on tdr2_merge_sort.c by Joe Zbiciak.
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#include "ftr2_merge_sort.h"
+
+#include <stddef.h>
+
+#include "list_instrument.h"
+#include "list_prefetch.h"
+
+static int ftr2_distance = LIST_PREFETCH_DEFAULT_DISTANCE;
+
+// Sets the prefetch distance ftr2_merge_sort uses.  Zero turns prefetching
+// off.
+void ftr2_merge_sort_set_distance(const int distance) {
+  ftr2_distance = distance < 0 ? 0 : distance;
+}
+
+// Implements the recursive portion of the top-down recursive sort, taking
+// advantage of the length information computed up-front.  Merges of halves no
+// longer than the prefetch distance skip prefetching.
+static ListNode *ftr2_merge_sort_internal(
+    ListNode *const head,
+    ListNodeCompareFxn *const cmp,
+    const size_t length,
+    const int distance
+) {
+  // Degenerate list: return as-is.
+  if (length < 2) {
+    return head;
+  }
+
+  // Two-node list: sort and return.
+  if (length == 2) {
+    ListNode *const a = head;
+    ListNode *const b = head->next;
+    LIST_COUNT_VISIT();
+
+    // Do we need to swap them?
+    if (cmp(a, b)) {
+      return head;  // No.
+    }
+
+    // Yes.
+    b->next = a;
+    a->next = NULL;
+    LIST_COUNT_LINK();
+    LIST_COUNT_LINK();
+    return b;
+  }
+
+  // Find midpoint and cut into two lists.
+  const size_t len_a = length / 2, len_b = length - len_a;
+  ListNode *pmid = head;
+
+  for (size_t i = 1; i < len_a; ++i) {
+    pmid = pmid->next;
+    LIST_COUNT_VISIT();
+  }
+
+  ListNode *const mid = pmid->next;
+  pmid->next = NULL;
+  LIST_COUNT_VISIT();
+  LIST_COUNT_LINK();
+
+  // Recursively sort the halves.
+  ListNode *const a = ftr2_merge_sort_internal(head, cmp, len_a, distance);
+  ListNode *const b = ftr2_merge_sort_internal(mid, cmp, len_b, distance);
+  ListNode *const merged = list_prefetch_merge(
+      a, b, cmp, len_a > (size_t)distance ? distance : 0);
+
+  // Return the final merged result.
+  return merged;
+}
+
+// Implements tdr2_merge_sort, with the merges running lookahead cursors
+// 'distance' nodes ahead along both halves.
+ListNode *ftr2_merge_sort_distance(ListNode *const head,
+                                   ListNodeCompareFxn *const cmp,
+                                   const int distance) {
+  size_t length = 0;
+  ListNode *node = head;
+
+  // Measure length of the list once up-front.
+  while (node) {
+    length++;
+    node = node->next;
+    LIST_COUNT_VISIT();
+  }
+
+  return ftr2_merge_sort_internal(head, cmp, length, distance);
+}
+
+// Same as above, using the prefetch distance set by
+// ftr2_merge_sort_set_distance.
+ListNode *ftr2_merge_sort(ListNode *const head, ListNodeCompareFxn *const cmp) {
+  return ftr2_merge_sort_distance(head, cmp, ftr2_distance);
+}
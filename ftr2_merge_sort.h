@@ -0,0 +1,25 @@
+// Top-Down Recursive Merge Sort, measuring list length up front, with software
+// prefetching in the merges.
+//
+// Author:  agent <agent@local>
+// Based on tdr2_merge_sort.c by Joe Zbiciak.
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#ifndef FTR2_MERGE_SORT_H_
+#define FTR2_MERGE_SORT_H_
+
+#include "list_node.h"
+#include "list_sort.h"
+
+// Sets the prefetch distance, in nodes, ftr2_merge_sort uses.  Zero turns
+// prefetching off.  The default is LIST_PREFETCH_DEFAULT_DISTANCE.
+void ftr2_merge_sort_set_distance(int distance);
+
+// Implements tdr2_merge_sort, with each merge running lookahead cursors
+// 'distance' nodes ahead along both halves, prefetching as they go.
+ListNode *ftr2_merge_sort_distance(ListNode *head, ListNodeCompareFxn *cmp,
+                                   int distance);
+
+// Same as above, using the distance set by ftr2_merge_sort_set_distance.
+ListNode *ftr2_merge_sort(ListNode *head, ListNodeCompareFxn *cmp);
+
+#endif  // FTR2_MERGE_SORT_H_
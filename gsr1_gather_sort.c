@@ -0,0 +1,211 @@
+// Gather-sort-relink:  sorts a linked list by sorting an array of its keys.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#include "gsr1_gather_sort.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "kbi2_merge_sort.h"
+#include "list_instrument.h"
+
+// Sub-arrays at or below this size get an insertion sort.
+#define INSERTION_CUTOFF (16)
+
+// Each thread has its own scratch array, so that threads can sort at once.
+static _Thread_local KeyNodePair *gsr1_scratch = NULL;
+static _Thread_local size_t gsr1_scratch_length = 0;
+
+// Sets the scratch array gsr1_gather_sort uses in the calling thread.
+void gsr1_gather_sort_set_scratch(KeyNodePair *const scratch,
+                                  const size_t scratch_length) {
+  gsr1_scratch = scratch;
+  gsr1_scratch_length = scratch ? scratch_length : 0;
+}
+
+// Returns true if 'a' is less than 'b'.  Only calls the comparison function
+// if the keys can't decide it.
+static inline bool pair_less(const KeyNodePair *const a,
+                             const KeyNodePair *const b,
+                             ListNodeCompareFxn *const cmp) {
+  return a->key < b->key || (a->key == b->key && cmp(a->node, b->node));
+}
+
+static inline void swap_pairs(KeyNodePair *const a, KeyNodePair *const b) {
+  const KeyNodePair t = *a;
+  *a = *b;
+  *b = t;
+}
+
+// Sorts a short sub-array with a straight insertion sort.
+static void insertion_sort(KeyNodePair *const pair, const size_t length,
+                           ListNodeCompareFxn *const cmp) {
+  for (size_t i = 1; i < length; ++i) {
+    const KeyNodePair ins = pair[i];
+    size_t j = i;
+    while (j > 0 && pair_less(&ins, &pair[j - 1], cmp)) {
+      pair[j] = pair[j - 1];
+      j--;
+    }
+    pair[j] = ins;
+  }
+}
+
+// Restores the max-heap property below 'root'.
+static void sift_down(KeyNodePair *const pair, size_t root,
+                      const size_t length, ListNodeCompareFxn *const cmp) {
+  for (;;) {
+    size_t child = 2 * root + 1;
+    if (child >= length) {
+      return;
+    }
+    if (child + 1 < length && pair_less(&pair[child], &pair[child + 1], cmp)) {
+      child++;
+    }
+    if (!pair_less(&pair[root], &pair[child], cmp)) {
+      return;
+    }
+    swap_pairs(&pair[root], &pair[child]);
+    root = child;
+  }
+}
+
+// Sorts a sub-array with heapsort, for when QuickSort goes too deep.
+static void heap_sort(KeyNodePair *const pair, const size_t length,
+                      ListNodeCompareFxn *const cmp) {
+  for (size_t i = length / 2; i-- > 0; ) {
+    sift_down(pair, i, length, cmp);
+  }
+  for (size_t i = length; i-- > 1; ) {
+    swap_pairs(&pair[0], &pair[i]);
+    sift_down(pair, 0, i, cmp);
+  }
+}
+
+// Sorts a sub-array with an introsort:  QuickSort with a median-of-3 pivot,
+// insertion sort for short sub-arrays, and heapsort past a depth limit.
+// Recurses on the smaller side, and loops on the larger.
+static void intro_sort(KeyNodePair *pair, size_t length, int depth_limit,
+                       ListNodeCompareFxn *const cmp) {
+  while (length > INSERTION_CUTOFF) {
+    if (depth_limit-- == 0) {
+      heap_sort(pair, length, cmp);
+      return;
+    }
+
+    // Order the first, middle and last elements, and use the middle one as
+    // the pivot.  That leaves sentinels at both ends for the partition loop.
+    KeyNodePair *const lo = &pair[0];
+    KeyNodePair *const mid = &pair[length / 2];
+    KeyNodePair *const hi = &pair[length - 1];
+    if (pair_less(mid, lo, cmp)) {
+      swap_pairs(mid, lo);
+    }
+    if (pair_less(hi, mid, cmp)) {
+      swap_pairs(hi, mid);
+      if (pair_less(mid, lo, cmp)) {
+        swap_pairs(mid, lo);
+      }
+    }
+
+    // Hoare partition around the pivot, which we park at pair[1].
+    swap_pairs(mid, &pair[1]);
+    const KeyNodePair pivot = pair[1];
+    size_t i = 1, j = length - 1;
+    for (;;) {
+      do {
+        i++;
+      } while (pair_less(&pair[i], &pivot, cmp));
+      do {
+        j--;
+      } while (pair_less(&pivot, &pair[j], cmp));
+      if (i >= j) {
+        break;
+      }
+      swap_pairs(&pair[i], &pair[j]);
+    }
+    swap_pairs(&pair[1], &pair[j]);
+
+    // pair[j] is in its final place.
+    const size_t left = j, right = length - j - 1;
+    if (left < right) {
+      intro_sort(pair, left, depth_limit, cmp);
+      pair += j + 1;
+      length = right;
+    } else {
+      intro_sort(pair + j + 1, right, depth_limit, cmp);
+      length = left;
+    }
+  }
+
+  insertion_sort(pair, length, cmp);
+}
+
+// Sorts a singly linked list by gathering, sorting and relinking.  See the
+// header for details.
+ListNode *gsr1_gather_sort_scratch(ListNode *const head,
+                                   ListNodeKeyFxn *const key,
+                                   ListNodeCompareFxn *const cmp,
+                                   KeyNodePair *scratch,
+                                   const size_t scratch_length) {
+  // Degenerate list: return as-is.
+  if (!head || !LIST_VISIT_NEXT(head)) {
+    return head;
+  }
+
+  // Gather keys and addresses.  Keep counting if we run out of room.
+  size_t length = 0;
+  for (ListNode *node = head; node; node = node->next) {
+    if (length < scratch_length) {
+      scratch[length].key = key(node);
+      scratch[length].node = node;
+    }
+    length++;
+    LIST_COUNT_VISIT();
+  }
+
+  // Didn't fit?  Get a bigger scratch array and gather again.  If we can't
+  // get one, fall back to a sort that doesn't need one.
+  KeyNodePair *allocated = NULL;
+  if (length > scratch_length) {
+    allocated = malloc(sizeof(KeyNodePair) * length);
+    if (!allocated) {
+      return kbi2_merge_sort(head, key, cmp);
+    }
+    scratch = allocated;
+
+    size_t i = 0;
+    for (ListNode *node = head; node; node = node->next, ++i) {
+      scratch[i].key = key(node);
+      scratch[i].node = node;
+      LIST_COUNT_VISIT();
+    }
+  }
+
+  // Sort.  The depth limit is 2 * log2(length).
+  int depth_limit = 0;
+  for (size_t n = length; n > 1; n >>= 1) {
+    depth_limit += 2;
+  }
+  intro_sort(scratch, length, depth_limit, cmp);
+
+  // Relink in one sequential pass over the array.
+  for (size_t i = 0; i + 1 < length; ++i) {
+    scratch[i].node->next = scratch[i + 1].node;
+    LIST_COUNT_LINK();
+  }
+  scratch[length - 1].node->next = NULL;
+  LIST_COUNT_LINK();
+
+  ListNode *const sorted = scratch[0].node;
+  free(allocated);
+  return sorted;
+}
+
+// Same as above, using the scratch array set by gsr1_gather_sort_set_scratch.
+ListNode *gsr1_gather_sort(ListNode *const head, ListNodeKeyFxn *const key,
+                           ListNodeCompareFxn *const cmp) {
+  return gsr1_gather_sort_scratch(head, key, cmp, gsr1_scratch,
+                                  gsr1_scratch_length);
+}
@@ -0,0 +1,41 @@
+// Gather-sort-relink:  sorts a linked list by sorting an array of its keys.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#ifndef GSR1_GATHER_SORT_H_
+#define GSR1_GATHER_SORT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "list_node.h"
+#include "list_sort.h"
+
+// One gathered node:  its sort key, and the node itself.
+typedef struct {
+  uint64_t key;
+  ListNode *node;
+} KeyNodePair;
+
+// Sorts a singly linked list in three passes.  The first pass walks the list,
+// gathering each node's key and address into 'scratch'.  The second sorts
+// 'scratch' in place with an introsort, comparing keys first and only calling
+// 'cmp' when keys are equal.  The third walks 'scratch' in order, relinking
+// the 'next' pointers.  If the list has more than 'scratch_length' nodes, it
+// allocates a bigger scratch array.
+ListNode *gsr1_gather_sort_scratch(ListNode *head, ListNodeKeyFxn *key,
+                                   ListNodeCompareFxn *cmp,
+                                   KeyNodePair *scratch,
+                                   size_t scratch_length);
+
+// Sets the scratch array gsr1_gather_sort uses in the calling thread.  Supply
+// one big enough for the longest list you'll sort, so gsr1_gather_sort never
+// allocates.
+void gsr1_gather_sort_set_scratch(KeyNodePair *scratch,
+                                  size_t scratch_length);
+
+// Same as above, using the scratch array set by gsr1_gather_sort_set_scratch.
+ListNode *gsr1_gather_sort(ListNode *head, ListNodeKeyFxn *key,
+                           ListNodeCompareFxn *cmp);
+
+#endif  // GSR1_GATHER_SORT_H_
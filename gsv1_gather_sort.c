@@ -0,0 +1,200 @@
+// Vector gather-sort-relink:  sorts a linked list by sorting an array of its
+// keys with SIMD sorting networks and merges.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#include "gsv1_gather_sort.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "kbi2_merge_sort.h"
+#include "list_instrument.h"
+#include "nbi1_merge_sort.h"
+#include "simd_sort.h"
+
+// Alignment of the arrays carved from the scratch buffer:  one cache line,
+// which covers the widest vector.
+#define SCRATCH_ALIGN (64)
+
+// Each thread has its own scratch buffer, so that threads can sort at once.
+static _Thread_local void *gsv1_scratch = NULL;
+static _Thread_local size_t gsv1_scratch_bytes = 0;
+
+// Sets the scratch buffer gsv1_gather_sort uses in the calling thread.
+void gsv1_gather_sort_set_scratch(void *const scratch,
+                                  const size_t scratch_bytes) {
+  gsv1_scratch = scratch;
+  gsv1_scratch_bytes = scratch ? scratch_bytes : 0;
+}
+
+// Rounds a list length up to whole sorting-network blocks.
+static size_t padded_length(const size_t length) {
+  return (length + SIMD_SORT_BLOCK - 1) / SIMD_SORT_BLOCK * SIMD_SORT_BLOCK;
+}
+
+// Returns the number of scratch bytes needed for a list of 'length' nodes:
+// keys, payloads, and a second copy of each to merge into, plus slack for
+// alignment.
+size_t gsv1_gather_sort_scratch_bytes(const size_t length) {
+  return 4 * sizeof(int64_t) * padded_length(length) + SCRATCH_ALIGN;
+}
+
+// The four arrays carved out of a scratch buffer, each 'capacity' long.
+typedef struct {
+  int64_t *keys, *keys_tmp;
+  uintptr_t *vals, *vals_tmp;
+  size_t capacity;
+} ScratchArrays;
+
+// Carves the arrays out of a scratch buffer.  The capacity is a whole number
+// of blocks.
+static ScratchArrays carve_scratch(void *const scratch,
+                                   const size_t scratch_bytes) {
+  ScratchArrays arrays = { NULL, NULL, NULL, NULL, 0 };
+  if (!scratch || scratch_bytes < SCRATCH_ALIGN) {
+    return arrays;
+  }
+  const uintptr_t base = ((uintptr_t)scratch + SCRATCH_ALIGN - 1)
+                       & ~(uintptr_t)(SCRATCH_ALIGN - 1);
+  const size_t capacity = (scratch_bytes - SCRATCH_ALIGN) / 4
+                        / sizeof(int64_t) / SIMD_SORT_BLOCK * SIMD_SORT_BLOCK;
+  arrays.keys = (int64_t *)base;
+  arrays.keys_tmp = arrays.keys + capacity;
+  arrays.vals = (uintptr_t *)(arrays.keys_tmp + capacity);
+  arrays.vals_tmp = arrays.vals + capacity;
+  arrays.capacity = capacity;
+  return arrays;
+}
+
+// Gathers a node's key and address.  The kernels sort signed keys, so flip
+// the key's sign bit.
+static inline void gather_one(const ScratchArrays *const arrays,
+                              const size_t i, ListNode *const node,
+                              ListNodeKeyFxn *const key) {
+  arrays->keys[i] = (int64_t)(key(node) ^ (UINT64_C(1) << 63));
+  arrays->vals[i] = (uintptr_t)node;
+}
+
+// Relinks the nodes in sorted key order.  Keys only order nodes up to their
+// prefix, so each run of equal keys gets chained up and sorted with 'cmp'.
+// For exact keys, those runs are all equal, and the natural merge sort
+// passes over them in linear time.
+static ListNode *relink(const int64_t *const keys, const uintptr_t *const vals,
+                        const size_t padded, ListNodeCompareFxn *const cmp) {
+  ListNode *sorted = NULL;
+  ListNode **link = &sorted;
+
+  size_t i = 0;
+  while (i < padded) {
+    size_t j = i + 1;
+    while (j < padded && keys[j] == keys[i]) {
+      j++;
+    }
+
+    if (j - i == 1) {
+      if (vals[i]) {
+        ListNode *const node = (ListNode *)vals[i];
+        *link = node;
+        link = &node->next;
+        LIST_COUNT_LINK();
+      }
+    } else {
+      ListNode *run = NULL;
+      ListNode **run_link = &run;
+      for (size_t r = i; r < j; ++r) {
+        if (vals[r]) {
+          ListNode *const node = (ListNode *)vals[r];
+          *run_link = node;
+          run_link = &node->next;
+          LIST_COUNT_LINK();
+        }
+      }
+      *run_link = NULL;
+      LIST_COUNT_LINK();
+
+      *link = nbi1_merge_sort(run, cmp);
+      LIST_COUNT_LINK();
+      while (*link) {
+        link = &(*link)->next;
+        LIST_COUNT_VISIT();
+      }
+    }
+
+    i = j;
+  }
+
+  *link = NULL;
+  LIST_COUNT_LINK();
+  return sorted;
+}
+
+// Sorts a singly linked list by gathering, sorting and relinking.  See the
+// header for details.
+ListNode *gsv1_gather_sort_scratch(ListNode *const head,
+                                   ListNodeKeyFxn *const key,
+                                   ListNodeCompareFxn *const cmp,
+                                   void *scratch,
+                                   const size_t scratch_bytes) {
+  // Degenerate list: return as-is.
+  if (!head || !LIST_VISIT_NEXT(head)) {
+    return head;
+  }
+
+  // Gather keys and addresses.  Keep counting if we run out of room.
+  ScratchArrays arrays = carve_scratch(scratch, scratch_bytes);
+  size_t length = 0;
+  for (ListNode *node = head; node; node = node->next) {
+    if (length < arrays.capacity) {
+      gather_one(&arrays, length, node, key);
+    }
+    length++;
+    LIST_COUNT_VISIT();
+  }
+
+  // Didn't fit?  Get a bigger scratch buffer and gather again.  If we can't
+  // get one, fall back to a sort that doesn't need one.
+  const size_t padded = padded_length(length);
+  void *allocated = NULL;
+  if (padded > arrays.capacity) {
+    const size_t needed_bytes = gsv1_gather_sort_scratch_bytes(length);
+    allocated = malloc(needed_bytes);
+    if (!allocated) {
+      return kbi2_merge_sort(head, key, cmp);
+    }
+    arrays = carve_scratch(allocated, needed_bytes);
+
+    size_t i = 0;
+    for (ListNode *node = head; node; node = node->next, ++i) {
+      gather_one(&arrays, i, node, key);
+      LIST_COUNT_VISIT();
+    }
+  }
+
+  // Pad out to whole blocks with the largest key and a NULL node, for the
+  // relink pass to skip.
+  for (size_t i = length; i < padded; ++i) {
+    arrays.keys[i] = INT64_MAX;
+    arrays.vals[i] = 0;
+  }
+
+  ListNode *sorted;
+  if (simd_sort_pairs(arrays.keys, arrays.vals,
+                      arrays.keys_tmp, arrays.vals_tmp, padded)) {
+    sorted = relink(arrays.keys_tmp, arrays.vals_tmp, padded, cmp);
+  } else {
+    sorted = relink(arrays.keys, arrays.vals, padded, cmp);
+  }
+
+  free(allocated);
+  return sorted;
+}
+
+// Same as above, using the scratch buffer set by
+// gsv1_gather_sort_set_scratch.
+ListNode *gsv1_gather_sort(ListNode *const head, ListNodeKeyFxn *const key,
+                           ListNodeCompareFxn *const cmp) {
+  return gsv1_gather_sort_scratch(head, key, cmp, gsv1_scratch,
+                                  gsv1_scratch_bytes);
+}
@@ -0,0 +1,37 @@
+// Vector gather-sort-relink:  sorts a linked list by sorting an array of its
+// keys with SIMD sorting networks and merges.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#ifndef GSV1_GATHER_SORT_H_
+#define GSV1_GATHER_SORT_H_
+
+#include <stddef.h>
+
+#include "list_node.h"
+#include "list_sort.h"
+
+// Returns the number of scratch bytes gsv1_gather_sort needs to sort a list
+// of 'length' nodes without allocating.
+size_t gsv1_gather_sort_scratch_bytes(size_t length);
+
+// Sorts a singly linked list in three passes.  The first pass walks the list,
+// gathering each node's key and address into separate arrays in 'scratch'.
+// The second sorts the arrays with the kernels in simd_sort.h, which use
+// AVX-512 or AVX2 if the CPU has them.  The third walks the arrays in order,
+// relinking the 'next' pointers.  Nodes with equal keys get sorted among
+// themselves with 'cmp' as they're relinked.  If 'scratch' is too small, it
+// allocates a bigger one.
+ListNode *gsv1_gather_sort_scratch(ListNode *head, ListNodeKeyFxn *key,
+                                   ListNodeCompareFxn *cmp,
+                                   void *scratch, size_t scratch_bytes);
+
+// Sets the scratch buffer gsv1_gather_sort uses in the calling thread.
+void gsv1_gather_sort_set_scratch(void *scratch, size_t scratch_bytes);
+
+// Same as above, using the scratch buffer set by
+// gsv1_gather_sort_set_scratch.
+ListNode *gsv1_gather_sort(ListNode *head, ListNodeKeyFxn *key,
+                           ListNodeCompareFxn *cmp);
+
+#endif  // GSV1_GATHER_SORT_H_
@@ -0,0 +1,168 @@
+// Implements a key-aware bottom-up iterative merge sort on a linked list.
+//
+// Author:  agent <agent@local>
+// Based on bui2_merge_sort.c by Joe Zbiciak.
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#include "kbi2_merge_sort.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "list_instrument.h"
+
+#define MAX_STACK (64)
+
+typedef struct {
+  size_t length;
+  ListNode *node;
+} StackNode;
+
+typedef struct {
+  int top;
+  StackNode stk[MAX_STACK];
+} Stack;
+
+// Returns true if 'a' (with key 'ka') is less than 'b' (with key 'kb').  Only
+// calls the comparison function if the keys can't decide it.
+static inline bool key_less(
+    const ListNode *const a, const uint64_t ka,
+    const ListNode *const b, const uint64_t kb,
+    ListNodeCompareFxn *const cmp
+) {
+  return ka < kb || (ka == kb && cmp(a, b));
+}
+
+// Pushes the first nodes from the rest of the list onto the top of stack, and
+// returns the rest of the list.  Sorts the first two nodes.
+static inline ListNode *push_first(
+    Stack *const restrict stk,
+    ListNode *first,
+    ListNodeKeyFxn *const key,
+    ListNodeCompareFxn *const cmp
+) {
+  if (first->next) {
+    ListNode *a = first;
+    ListNode *b = a->next;
+    ListNode *rest = b->next;
+    LIST_COUNT_VISIT();
+    LIST_COUNT_VISIT();
+    if (key_less(a, key(a), b, key(b), cmp)) {
+      b->next = NULL;
+      LIST_COUNT_LINK();
+    } else {
+      a->next = NULL;
+      b->next = a;
+      a = b;
+      LIST_COUNT_LINK();
+      LIST_COUNT_LINK();
+    }
+    const StackNode sn = { .length = 2, .node = a };
+    stk->stk[stk->top++] = sn;
+    return rest;
+  }
+
+  ListNode *rest = first->next;
+  const StackNode sn = { .length = 1, .node = first };
+  first->next = NULL;
+  stk->stk[stk->top++] = sn;
+  LIST_COUNT_VISIT();
+  LIST_COUNT_LINK();
+
+  return rest;
+}
+
+// Pushes a sub-list onto the stack, along with its length.
+static inline void push_list(Stack *const restrict stk, const int length,
+                             ListNode *const node) {
+  const StackNode sn = { .length = length, .node = node };
+  stk->stk[stk->top++] = sn;
+}
+
+// Pops the top of stack, returning the ListNode* at the top.
+static inline ListNode *pop_list(Stack *const restrict stk) {
+  return stk->stk[--stk->top].node;
+}
+
+// Returns the length of the nth previous stack push.
+static inline int peek_length(Stack *const restrict stk, const int dist) {
+  return stk->stk[stk->top - dist].length;
+}
+
+// Implements bui2_merge_sort using sort keys.  Compares keys inline, caching
+// the key for the node at the head of each sub-list during a merge, and only
+// calls 'cmp' when two keys are equal.
+ListNode *kbi2_merge_sort(ListNode *const first,
+                          ListNodeKeyFxn *const key,
+                          ListNodeCompareFxn *const cmp) {
+  // Handle degenerate cases of an empty list or a single-node list.
+  if (!first || !LIST_VISIT_NEXT(first)) {
+    return first;
+  }
+
+  // Our stack of partially merged lists.  Only need to initialize stk.top.
+  Stack stk;
+  stk.top = 0;
+
+  // Push the first pair of nodes onto the stack.
+  ListNode *rest = push_first(&stk, first, key, cmp);
+
+  // While there's sub-lists to merge, keep merging.
+  do {
+    // Merge sub-lists at top of stack, if possible.
+    while (stk.top > 1 &&
+           (!rest || peek_length(&stk, 1) >= peek_length(&stk, 2))) {
+      // Extract the top two nodes from the stack to merge.
+      const size_t length = peek_length(&stk, 1) + peek_length(&stk, 2);
+      ListNode *a = pop_list(&stk);
+      ListNode *b = pop_list(&stk);
+      uint64_t ka = key(a), kb = key(b);
+
+      // Merge the two lists, with merged as its head. pnext points to the
+      // next pointer at the tail of the list, or merged at the start of the
+      // merge process.
+      ListNode *merged = NULL;
+      ListNode **pnext = &merged;
+
+      // Take the smallest from a or b, as long as both lists are non-empty.
+      // Only the side we took from needs a new key.
+      for (;;) {
+        if (key_less(a, ka, b, kb, cmp)) {
+          *pnext = a;
+          pnext = &a->next;
+          a = a->next;
+          LIST_COUNT_LINK();
+          LIST_COUNT_VISIT();
+          if (!a) {
+            break;
+          }
+          ka = key(a);
+        } else {
+          *pnext = b;
+          pnext = &b->next;
+          b = b->next;
+          LIST_COUNT_LINK();
+          LIST_COUNT_VISIT();
+          if (!b) {
+            break;
+          }
+          kb = key(b);
+        }
+      }
+
+      // Once we exhaust one list, append the other as-is to the merged list.
+      *pnext = a ? a : b;
+      LIST_COUNT_LINK();
+
+      push_list(&stk, length, merged);
+    }
+
+    // If there are more unsorted nodes, add a new sub-list containing the next
+    // item from it.  Try to push a sorted pair if we can.
+    if (rest) {
+      rest = push_first(&stk, rest, key, cmp);
+    }
+  } while (stk.top > 1);
+
+  // Return the final merged result.
+  return pop_list(&stk);
+}
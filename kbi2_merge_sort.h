@@ -0,0 +1,18 @@
+// Implements a key-aware bottom-up iterative merge sort on a linked list.
+//
+// Author:  agent <agent@local>
+// Based on bui2_merge_sort.c by Joe Zbiciak.
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#ifndef KBI2_MERGE_SORT_H_
+#define KBI2_MERGE_SORT_H_
+
+#include "list_node.h"
+#include "list_sort.h"
+
+// Implements bui2_merge_sort using sort keys.  Compares keys inline, caching
+// the key for the node at the head of each sub-list during a merge, and only
+// calls 'cmp' when two keys are equal.
+ListNode *kbi2_merge_sort(ListNode *first, ListNodeKeyFxn *key,
+                          ListNodeCompareFxn *cmp);
+
+#endif  // KBI2_MERGE_SORT_H_
@@ -0,0 +1,121 @@
+// Key-aware Top-down Iterative Merge Sort with O(1) auxillary storage.
+//
+// Primary author:  Drew Eckhardt
+// Secondary author:  Joe Zbiciak
+// Key-aware version:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#include "kti2_merge_sort.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "list_instrument.h"
+
+// Returns true if 'a' (with key 'ka') is less than 'b' (with key 'kb').  Only
+// calls the comparison function if the keys can't decide it.
+static inline bool key_less(
+    const ListNode *const a, const uint64_t ka,
+    const ListNode *const b, const uint64_t kb,
+    ListNodeCompareFxn *const cmp
+) {
+  return ka < kb || (ka == kb && cmp(a, b));
+}
+
+// Implements tdi2_merge_sort using sort keys.  Compares keys inline, caching
+// the key for the node at the head of each sub-list during a merge, and only
+// calls 'cmp' when two keys are equal.
+ListNode *kti2_merge_sort(ListNode *const src, ListNodeKeyFxn *const key,
+                          ListNodeCompareFxn *const cmp) {
+  ListNode *rest, *out_head, **out_tail;
+  size_t increment = 1, size = 0;
+
+  // Scan once to find our size.
+  for (ListNode *n = src; n; n = n->next) {
+    size++;
+    LIST_COUNT_VISIT();
+  }
+
+  rest = src;
+  while (increment < size) {
+    out_head = NULL;
+    out_tail = &out_head;
+
+    while (rest) {
+      size_t ar = increment, br = increment;
+      ListNode *a = rest;
+      ListNode *b = a;
+
+      // Find the start of 'b'.
+      for (size_t i = 0; i < increment && b; ++i) {
+        b = b->next;
+        LIST_COUNT_VISIT();
+      }
+
+      // If 'a' was shorter than increment, just append it and break out.
+      if (!b) {
+        rest = NULL;
+        *out_tail = a;
+        LIST_COUNT_LINK();
+        break;
+      }
+
+      // Merge 'b' into 'a'.  Only the side we took from needs a new key.
+      uint64_t ka = key(a), kb = key(b);
+      for (;;) {
+        if (key_less(a, ka, b, kb, cmp)) {
+          *out_tail = a;
+          out_tail = &a->next;
+          a = a->next;
+          LIST_COUNT_LINK();
+          LIST_COUNT_VISIT();
+          if (!--ar) {
+            break;
+          }
+          ka = key(a);
+        } else {
+          *out_tail = b;
+          out_tail = &b->next;
+          b = b->next;
+          LIST_COUNT_LINK();
+          LIST_COUNT_VISIT();
+          if (!--br || !b) {
+            break;
+          }
+          kb = key(b);
+        }
+      }
+
+      // Push any remaining 'a' nodes.
+      while (ar) {
+        *out_tail = a;
+        out_tail = &a->next;
+        a = a->next;
+        --ar;
+        LIST_COUNT_LINK();
+        LIST_COUNT_VISIT();
+      }
+
+      // Push any remaining 'b' nodes. 'b' can end early.
+      while (br && b) {
+        *out_tail = b;
+        out_tail = &b->next;
+        b = b->next;
+        --br;
+        LIST_COUNT_LINK();
+        LIST_COUNT_VISIT();
+      }
+
+      // Terminate our partial list.
+      *out_tail = NULL;
+      LIST_COUNT_LINK();
+
+      // The final advance on 'b' will make it point to 'rest'.
+      rest = b;
+    }
+
+    increment *= 2;
+    rest = out_head;
+  }
+
+  return rest;
+}
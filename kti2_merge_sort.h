@@ -0,0 +1,19 @@
+// Key-aware Top-down Iterative Merge Sort with O(1) auxillary storage.
+//
+// Primary author:  Drew Eckhardt
+// Secondary author:  Joe Zbiciak
+// Key-aware version:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#ifndef KTI2_MERGE_SORT_H_
+#define KTI2_MERGE_SORT_H_
+
+#include "list_node.h"
+#include "list_sort.h"
+
+// Implements tdi2_merge_sort using sort keys.  Compares keys inline, caching
+// the key for the node at the head of each sub-list during a merge, and only
+// calls 'cmp' when two keys are equal.
+ListNode *kti2_merge_sort(ListNode *src, ListNodeKeyFxn *key,
+                          ListNodeCompareFxn *cmp);
+
+#endif // KTI2_MERGE_SORT_H_
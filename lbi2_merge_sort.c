@@ -0,0 +1,132 @@
+// Implements a bottom-up iterative merge sort on a linked list, sorting short
+// leaves with a sorting network or insertion sort.
+//
+// Author:  agent <agent@local>
+// Based on bui2_merge_sort.c by Joe Zbiciak.
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#include "lbi2_merge_sort.h"
+
+#include <stddef.h>
+
+#include "list_instrument.h"
+
+#define MAX_STACK (64)
+
+static ListLeaf lbi2_leaf = {
+  .kind = LIST_LEAF_DEFAULT_KIND,
+  .size = LIST_LEAF_DEFAULT_SIZE
+};
+
+// Sets the leaf sort lbi2_merge_sort uses.
+void lbi2_merge_sort_set_leaf(const ListLeaf leaf) {
+  lbi2_leaf = list_leaf_clamp(leaf);
+}
+
+typedef struct {
+  size_t length;
+  ListNode *node;
+} StackNode;
+
+typedef struct {
+  int top;
+  StackNode stk[MAX_STACK];
+} Stack;
+
+// Takes a leaf from the front of the rest of the list, sorts it, and pushes it
+// onto the top of stack.  Returns the rest of the list.
+static inline ListNode *push_leaf(
+    Stack *const restrict stk,
+    ListNode *rest,
+    ListNodeCompareFxn *const cmp,
+    const ListLeaf leaf
+) {
+  int length;
+  ListNode *const node = list_leaf_take(&rest, leaf, cmp, &length);
+  const StackNode sn = { .length = length, .node = node };
+  stk->stk[stk->top++] = sn;
+  return rest;
+}
+
+// Pushes a sub-list onto the stack, along with its length.
+static inline void push_list(Stack *const restrict stk, const int length,
+                             ListNode *const node) {
+  const StackNode sn = { .length = length, .node = node };
+  stk->stk[stk->top++] = sn;
+}
+
+// Pops the top of stack, returning the ListNode* at the top.
+static inline ListNode *pop_list(Stack *const restrict stk) {
+  return stk->stk[--stk->top].node;
+}
+
+// Returns the length of the nth previous stack push.
+static inline int peek_length(Stack *const restrict stk, const int dist) {
+  return stk->stk[stk->top - dist].length;
+}
+
+// Implements bui2_merge_sort with sorted leaves of up to leaf.size nodes.
+ListNode *lbi2_merge_sort_leaf(ListNode *const first,
+                               ListNodeCompareFxn *const cmp,
+                               ListLeaf leaf) {
+  // Handle degenerate cases of an empty list or a single-node list.
+  if (!first || !LIST_VISIT_NEXT(first)) {
+    return first;
+  }
+
+  leaf = list_leaf_clamp(leaf);
+
+  // Our stack of partially merged lists.  Only need to initialize stk.top.
+  Stack stk;
+  stk.top = 0;
+
+  // Push the first leaf onto the stack.
+  ListNode *rest = push_leaf(&stk, first, cmp, leaf);
+
+  // While there's sub-lists to merge, keep merging.
+  do {
+    // Merge sub-lists at top of stack, if possible.
+    while (stk.top > 1 &&
+           (!rest || peek_length(&stk, 1) >= peek_length(&stk, 2))) {
+      // Extract the top two nodes from the stack to merge.
+      const size_t length = peek_length(&stk, 1) + peek_length(&stk, 2);
+      ListNode *a = pop_list(&stk);
+      ListNode *b = pop_list(&stk);
+
+      // Merge the two lists, with merged as its head. pnext points to the
+      // next pointer at the tail of the list, or merged at the start of the
+      // merge process.
+      ListNode *merged = NULL;
+      ListNode **pnext = &merged;
+
+      // Take the smallest from a or b, as long as both lists are non-empty.
+      while (a && b) {
+        ListNode **l = cmp(a, b) ? &a : &b;
+        *pnext = *l;
+        pnext = &(*pnext)->next;
+        *l = (*l)->next;
+        LIST_COUNT_LINK();
+        LIST_COUNT_VISIT();
+      }
+
+      // Once we exhaust one list, append the other as-is to the merged list.
+      *pnext = a ? a : b;
+      LIST_COUNT_LINK();
+
+      push_list(&stk, length, merged);
+    }
+
+    // If there are more unsorted nodes, push the next leaf.
+    if (rest) {
+      rest = push_leaf(&stk, rest, cmp, leaf);
+    }
+  } while (stk.top > 1);
+
+  // Return the final merged result.
+  return pop_list(&stk);
+}
+
+// Same as above, using the leaf sort set by lbi2_merge_sort_set_leaf.
+ListNode *lbi2_merge_sort(ListNode *const first,
+                          ListNodeCompareFxn *const cmp) {
+  return lbi2_merge_sort_leaf(first, cmp, lbi2_leaf);
+}
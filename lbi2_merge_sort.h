@@ -0,0 +1,26 @@
+// Implements a bottom-up iterative merge sort on a linked list, sorting short
+// leaves with a sorting network or insertion sort.
+//
+// Author:  agent <agent@local>
+// Based on bui2_merge_sort.c by Joe Zbiciak.
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#ifndef LBI2_MERGE_SORT_H_
+#define LBI2_MERGE_SORT_H_
+
+#include "list_leaf.h"
+#include "list_node.h"
+#include "list_sort.h"
+
+// Sets the leaf sort lbi2_merge_sort uses.  The default is a sorting network
+// on LIST_LEAF_DEFAULT_SIZE nodes.
+void lbi2_merge_sort_set_leaf(ListLeaf leaf);
+
+// Implements bui2_merge_sort, pushing sorted leaves of up to leaf.size nodes
+// onto the stack instead of sorted pairs.
+ListNode *lbi2_merge_sort_leaf(ListNode *first, ListNodeCompareFxn *cmp,
+                               ListLeaf leaf);
+
+// Same as above, using the leaf sort set by lbi2_merge_sort_set_leaf.
+ListNode *lbi2_merge_sort(ListNode *first, ListNodeCompareFxn *cmp);
+
+#endif  // LBI2_MERGE_SORT_H_
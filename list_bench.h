@@ -14,8 +14,9 @@
 // ListNode* to a given index.
 typedef ListNode *ListNodeGetFxn(void *buf, size_t index);
 
-// Randomizes the value a list node of a particular type, given a ListNode*.
-typedef void ListNodeRandomizeFxn(ListNode *node);
+// Randomizes the value a list node of a particular type, given a ListNode* and
+// a 64-bit random number.
+typedef void ListNodeRandomizeFxn(ListNode *node, uint64_t random);
 
 // Returns an index-sensitive checksum for a list node of a particular type.
 typedef uint64_t ListNodeChecksumFxn(const ListNode *node, size_t index);
@@ -33,6 +34,8 @@ typedef struct {
   ListNodeCompareFxn *compare;
   ListNodeChecksumFxn *checksum;
   ListNodeValidateFxn *validate;
+  ListNodeKeyFxn *key;  // Extracts a sort key.  NULL if this type has none.
+  const SortRegistry *typed_sorts;  // Sorts that only work on this type.
 } ListNodeBenchOps;
 
 #endif  // LIST_BENCH_H_
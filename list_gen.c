@@ -0,0 +1,857 @@
+// Generates randomized linked lists for the benchmark.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#include "list_gen.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "online_cpus.h"
+
+// LIST_GEN_CTR cuts the node indices into at most MAX_CHUNKS chunks of at
+// least CHUNK_NODES nodes each.  Each chunk is one thread's unit of work.
+#define CHUNK_NODES (65536)
+#define MAX_CHUNKS (64)
+
+// It scatters the nodes into at most MAX_BUCKETS buckets, averaging at least
+// BUCKET_NODES nodes each.  That keeps each bucket's shuffle in cache.
+#define BUCKET_NODES (8192)
+#define MAX_BUCKETS (1024)
+
+// LIST_GEN_ARENA keeps nodes and gaps aligned to this many bytes, like malloc.
+#define ARENA_ALIGN (16)
+
+static ListGenOptions list_gen_selected = {
+  .rng = LIST_GEN_MT64,
+  .dist = { LIST_GEN_UNIFORM, 0. },
+  .placement = { LIST_GEN_DENSE, 0. },
+  .order = { LIST_GEN_SHUFFLE, 0. },
+  .threads = 0
+};
+
+static const char *const rng_names[] = {
+  [LIST_GEN_MT64] = "mt64",
+  [LIST_GEN_CTR] = "ctr"
+};
+
+// Describes one choice for a distribution, placement or order, and its
+// parameter.
+typedef struct {
+  const char *name;
+  bool has_param;
+  double default_param, min_param;
+} SpecInfo;
+
+static const SpecInfo dist_info[] = {
+  [LIST_GEN_UNIFORM]  = { "uniform",  false, 0.,   0. },
+  [LIST_GEN_SORTED]   = { "sorted",   false, 0.,   0. },
+  [LIST_GEN_REVERSE]  = { "reverse",  false, 0.,   0. },
+  [LIST_GEN_NEARLY]   = { "nearly",   true,  0.01, 0. },
+  [LIST_GEN_SAWTOOTH] = { "sawtooth", true,  16.,  1. },
+  [LIST_GEN_ORGAN]    = { "organ",    false, 0.,   0. },
+  [LIST_GEN_FEW]      = { "few",      true,  16.,  1. },
+  [LIST_GEN_ZIPF]     = { "zipf",     true,  1.,   0. },
+  [LIST_GEN_RUNS]     = { "runs",     true,  16.,  1. }
+};
+
+static const SpecInfo placement_info[] = {
+  [LIST_GEN_DENSE]  = { "dense",  false, 0.,  0. },
+  [LIST_GEN_MALLOC] = { "malloc", false, 0.,  0. },
+  [LIST_GEN_ARENA]  = { "arena",  true,  64., 0. }
+};
+
+static const SpecInfo order_info[] = {
+  [LIST_GEN_SHUFFLE] = { "shuffle", false, 0.,    0. },
+  [LIST_GEN_WINDOW]  = { "window",  true,  4096., 1. },
+  [LIST_GEN_ALLOC]   = { "alloc",   false, 0.,    0. }
+};
+
+// Parses a name, optionally followed by a colon and a parameter, against a
+// table of choices.  Returns the index of the choice, or -1.
+static int parse_spec(const char *const spec, const SpecInfo *const info,
+                      const size_t count, double *const param) {
+  const char *const colon = strchr(spec, ':');
+  const size_t name_len = colon ? (size_t)(colon - spec) : strlen(spec);
+
+  for (size_t i = 0; i < count; ++i) {
+    if (strlen(info[i].name) != name_len ||
+        strncmp(spec, info[i].name, name_len)) {
+      continue;
+    }
+
+    *param = info[i].default_param;
+    if (colon) {
+      char *end;
+      *param = strtod(colon + 1, &end);
+      if (!info[i].has_param || end == colon + 1 || *end ||
+          !(*param >= info[i].min_param)) {
+        return -1;
+      }
+    }
+    return (int)i;
+  }
+  return -1;
+}
+
+// Writes a choice's name and parameter to 'str'.
+static void format_spec(const SpecInfo *const info, const double param,
+                        char *const str, const size_t size) {
+  if (info->has_param) {
+    snprintf(str, size, "%s:%g", info->name, param);
+  } else {
+    snprintf(str, size, "%s", info->name);
+  }
+}
+
+#define COUNT_OF(array) (sizeof(array) / sizeof((array)[0]))
+
+// Parses a generator name.
+bool list_gen_parse_rng(const char *const name, ListGenRng *const rng) {
+  for (size_t i = 0; i < COUNT_OF(rng_names); ++i) {
+    if (!strcmp(name, rng_names[i])) {
+      *rng = (ListGenRng)i;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns the name of a generator.
+const char *list_gen_rng_name(const ListGenRng rng) {
+  return rng_names[rng];
+}
+
+// Parses a distribution and its optional parameter.
+bool list_gen_parse_dist(const char *const spec, ListGenDist *const dist) {
+  double param;
+  const int kind = parse_spec(spec, dist_info, COUNT_OF(dist_info), &param);
+  if (kind < 0) {
+    return false;
+  }
+  dist->kind = (ListGenDistKind)kind;
+  dist->param = param;
+  return true;
+}
+
+// Writes a distribution's name and parameter to 'str'.
+void list_gen_dist_name(const ListGenDist dist, char *const str,
+                        const size_t size) {
+  format_spec(&dist_info[dist.kind], dist.param, str, size);
+}
+
+// Parses a placement and its optional parameter.
+bool list_gen_parse_placement(const char *const spec,
+                              ListGenPlacement *const placement) {
+  double param;
+  const int kind =
+      parse_spec(spec, placement_info, COUNT_OF(placement_info), &param);
+  if (kind < 0) {
+    return false;
+  }
+  placement->kind = (ListGenPlacementKind)kind;
+  placement->param = param;
+  return true;
+}
+
+// Writes a placement's name and parameter to 'str'.
+void list_gen_placement_name(const ListGenPlacement placement,
+                             char *const str, const size_t size) {
+  format_spec(&placement_info[placement.kind], placement.param, str, size);
+}
+
+// Parses an order and its optional parameter.
+bool list_gen_parse_order(const char *const spec, ListGenOrder *const order) {
+  double param;
+  const int kind = parse_spec(spec, order_info, COUNT_OF(order_info), &param);
+  if (kind < 0) {
+    return false;
+  }
+  order->kind = (ListGenOrderKind)kind;
+  order->param = param;
+  return true;
+}
+
+// Writes an order's name and parameter to 'str'.
+void list_gen_order_name(const ListGenOrder order, char *const str,
+                         const size_t size) {
+  format_spec(&order_info[order.kind], order.param, str, size);
+}
+
+// Sets the generator list_gen_generate uses.
+void list_gen_set_rng(const ListGenRng rng) {
+  list_gen_selected.rng = rng;
+}
+
+// Sets the distribution list_gen_generate uses.
+void list_gen_set_dist(const ListGenDist dist) {
+  list_gen_selected.dist = dist;
+}
+
+// Sets the placement list_gen_generate uses.
+void list_gen_set_placement(const ListGenPlacement placement) {
+  list_gen_selected.placement = placement;
+}
+
+// Sets the order list_gen_generate uses.
+void list_gen_set_order(const ListGenOrder order) {
+  list_gen_selected.order = order;
+}
+
+// Sets the number of threads list_gen_generate uses.  Zero means "one thread
+// per online CPU."
+void list_gen_set_threads(const int threads) {
+  list_gen_selected.threads = threads < 0 ? 0 : threads;
+}
+
+// Returns the options list_gen_generate uses.
+ListGenOptions list_gen_options(void) {
+  return list_gen_selected;
+}
+
+// Frees a ListGenBuf's buffers.
+void list_gen_buf_free(ListGenBuf *const buf) {
+  for (size_t i = 0; i < buf->malloc_elems; ++i) {
+    free(buf->malloc_nodes[i]);
+  }
+  free(buf->malloc_nodes);
+  free(buf->arena_nodes);
+  free(buf->arena);
+  free(buf->perm);
+  free(buf->counts);
+  free(buf->mt);
+  memset(buf, 0, sizeof(*buf));
+}
+
+// Exits if an allocation failed.
+static void *check_alloc(void *const ptr) {
+  if (!ptr) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    exit(1);
+  }
+  return ptr;
+}
+
+// Returns a random number in [0, range), given a 64-bit random number.
+static inline size_t scale_rand(const uint64_t rand, const size_t range) {
+  return (size_t)(((unsigned __int128)rand * range) >> 64);
+}
+
+// A distribution, set up for a particular list.
+typedef struct {
+  ListGenDistKind kind;
+  size_t elems;
+  size_t count;       // Teeth, runs or distinct values.
+  size_t swaps;       // Swaps for LIST_GEN_NEARLY.
+  double zipf_exp;    // 1 / (1 - s), or 0 if s == 1.
+  double zipf_scale;  // (elems + 1)^(1 - s) - 1, or ln(elems + 1) if s == 1.
+  uint64_t key;       // Picks each run's start for LIST_GEN_RUNS.
+} DistContext;
+
+// Sets up a distribution for a list of 'elems' nodes.
+static DistContext init_dist(const ListGenDist dist, const size_t elems,
+                             const uint64_t key) {
+  DistContext ctx = {
+    .kind = dist.kind,
+    .elems = elems,
+    .count = 1,
+    .swaps = 0,
+    .zipf_exp = 0.,
+    .zipf_scale = 0.,
+    .key = key
+  };
+
+  switch (dist.kind) {
+    case LIST_GEN_NEARLY:
+      ctx.swaps = (size_t)(dist.param * elems + 0.5);
+      break;
+
+    case LIST_GEN_SAWTOOTH:
+    case LIST_GEN_FEW:
+    case LIST_GEN_RUNS:
+      ctx.count = (size_t)dist.param;
+      if (ctx.count > elems) {
+        ctx.count = elems;
+      }
+      break;
+
+    case LIST_GEN_ZIPF:
+      if (dist.param == 1.) {
+        ctx.zipf_scale = log((double)elems + 1.);
+      } else {
+        ctx.zipf_exp = 1. / (1. - dist.param);
+        ctx.zipf_scale = pow((double)elems + 1., 1. - dist.param) - 1.;
+      }
+      break;
+
+    default:
+      break;
+  }
+
+  return ctx;
+}
+
+// Returns the value at position 'pos' in the list, given a 64-bit random
+// number drawn for that position.  The value depends on nothing else, so
+// threads can fill in values for any range of positions.
+static uint64_t dist_value(const DistContext *const ctx, const size_t pos,
+                           const uint64_t rand) {
+  const size_t elems = ctx->elems;
+
+  switch (ctx->kind) {
+    case LIST_GEN_UNIFORM:
+      return rand;
+
+    case LIST_GEN_SORTED:
+    case LIST_GEN_NEARLY:
+      return pos;
+
+    case LIST_GEN_REVERSE:
+      return elems - 1 - pos;
+
+    case LIST_GEN_SAWTOOTH: {
+      const size_t tooth = pos * ctx->count / elems;
+      return pos - (elems * tooth + ctx->count - 1) / ctx->count;
+    }
+
+    case LIST_GEN_ORGAN:
+      return pos < elems / 2 ? 2 * pos : 2 * (elems - 1 - pos) + 1;
+
+    case LIST_GEN_FEW:
+      return scale_rand(rand, ctx->count);
+
+    case LIST_GEN_ZIPF: {
+      // Invert the CDF of a continuous power law on [1, elems + 1), and round
+      // down to a rank.  Rank k comes up about k^-s as often as rank 1.
+      const double u = (rand >> 11) * (1.0 / 9007199254740992.0);
+      const double x = ctx->zipf_exp == 0.
+                     ? exp(u * ctx->zipf_scale)
+                     : pow(1. + u * ctx->zipf_scale, ctx->zipf_exp);
+      const size_t rank = x < 1. ? 1 : x >= elems ? elems : (size_t)x;
+      return rank - 1;
+    }
+
+    case LIST_GEN_RUNS: {
+      // Pick each run's first value so that its last one stays below elems.
+      const size_t run = pos * ctx->count / elems;
+      const size_t start = (elems * run + ctx->count - 1) / ctx->count;
+      const size_t end = (elems * (run + 1) + ctx->count - 1) / ctx->count;
+      return scale_rand(list_gen_ctr_rand(ctx->key, run),
+                        elems - (end - start) + 1) + pos - start;
+    }
+  }
+
+  return rand;
+}
+
+// Swaps the nodes at two random positions in 'perm', given two 64-bit random
+// numbers.
+static inline void swap_nodes(size_t *const perm, const size_t elems,
+                              const uint64_t rand_a, const uint64_t rand_b) {
+  const size_t a = scale_rand(rand_a, elems);
+  const size_t b = scale_rand(rand_b, elems);
+  const size_t t = perm[a];
+  perm[a] = perm[b];
+  perm[b] = t;
+}
+
+// Maps node indices to nodes.  'table' is NULL for LIST_GEN_DENSE.
+typedef struct {
+  const ListNodeBenchOps *lnb_ops;
+  void *list_buf;
+  ListNode *const *table;
+} NodeMap;
+
+// Returns the node at index 'i'.
+static inline ListNode *node_at(const NodeMap *const map, const size_t i) {
+  return map->table ? map->table[i] : map->lnb_ops->get(map->list_buf, i);
+}
+
+// Allocates 'elems' nodes with malloc, keeping the ones from earlier lists.
+static ListNode *const *place_malloc(ListGenBuf *const buf,
+                                     const size_t elems, const size_t size) {
+  // Start over if the node type changed.
+  if (size != buf->malloc_size) {
+    for (size_t i = 0; i < buf->malloc_elems; ++i) {
+      free(buf->malloc_nodes[i]);
+    }
+    buf->malloc_elems = 0;
+    buf->malloc_size = size;
+  }
+
+  if (elems > buf->malloc_elems) {
+    buf->malloc_nodes = (ListNode **)check_alloc(
+        realloc(buf->malloc_nodes, sizeof(ListNode *) * elems));
+    for (size_t i = buf->malloc_elems; i < elems; ++i) {
+      buf->malloc_nodes[i] = (ListNode *)check_alloc(malloc(size));
+    }
+    buf->malloc_elems = elems;
+  }
+
+  return buf->malloc_nodes;
+}
+
+// Returns the bytes each arena node takes, without its gap.
+static size_t arena_stride(const size_t size) {
+  return (size + ARENA_ALIGN - 1) & -(size_t)ARENA_ALIGN;
+}
+
+// Returns the bytes an arena of 'elems' nodes of 'size' bytes each needs, with
+// room for every gap to be 'max_gap' bytes.
+static size_t arena_bytes(const size_t elems, const size_t size,
+                          const size_t max_gap) {
+  return elems * (arena_stride(size) + max_gap / ARENA_ALIGN * ARENA_ALIGN);
+}
+
+// Places 'elems' nodes in an arena, each after a random gap of 0 to 'max_gap'
+// bytes.  The gaps depend only on 'key', so they're the same for either
+// generator.
+static ListNode *const *place_arena(ListGenBuf *const buf,
+                                    const size_t elems, const size_t size,
+                                    const size_t max_gap, const uint64_t key) {
+  const size_t stride = arena_stride(size);
+  const size_t gap_steps = max_gap / ARENA_ALIGN + 1;
+  const size_t bytes = arena_bytes(elems, size, max_gap);
+
+  if (bytes > buf->arena_bytes) {
+    free(buf->arena);
+    buf->arena = (char *)check_alloc(malloc(bytes));
+    buf->arena_bytes = bytes;
+  }
+  if (elems > buf->arena_elems) {
+    buf->arena_nodes = (ListNode **)check_alloc(
+        realloc(buf->arena_nodes, sizeof(ListNode *) * elems));
+    buf->arena_elems = elems;
+  }
+
+  size_t offset = 0;
+  for (size_t i = 0; i < elems; ++i) {
+    offset += scale_rand(list_gen_ctr_rand(key, i), gap_steps) * ARENA_ALIGN;
+    buf->arena_nodes[i] = (ListNode *)(buf->arena + offset);
+    offset += stride;
+  }
+
+  return buf->arena_nodes;
+}
+
+// Decides where each node lives, and allocates memory for them if needed.
+static NodeMap place_nodes(ListGenBuf *const buf,
+                           const ListNodeBenchOps *const lnb_ops,
+                           void *const list_buf, const size_t elems,
+                           const ListGenPlacement placement,
+                           const uint64_t key) {
+  NodeMap map = { .lnb_ops = lnb_ops, .list_buf = list_buf, .table = NULL };
+
+  switch (placement.kind) {
+    case LIST_GEN_DENSE:
+      break;
+
+    case LIST_GEN_MALLOC:
+      map.table = place_malloc(buf, elems, lnb_ops->size);
+      break;
+
+    case LIST_GEN_ARENA:
+      map.table = place_arena(buf, elems, lnb_ops->size,
+                              (size_t)placement.param, key);
+      break;
+  }
+
+  return map;
+}
+
+// Returns about how many bytes the generator allocates for the nodes with
+// 'placement'.  See the header.
+size_t list_gen_placement_bytes(const ListGenPlacement placement,
+                                const size_t elems, const size_t size) {
+  switch (placement.kind) {
+    case LIST_GEN_DENSE:
+      break;
+
+    case LIST_GEN_MALLOC:
+      // Each block also carries malloc's header, and rounds up to its
+      // alignment.
+      return elems * (sizeof(ListNode *) +
+                      arena_stride(size + sizeof(size_t)));
+
+    case LIST_GEN_ARENA:
+      return elems * sizeof(ListNode *) +
+             arena_bytes(elems, size, (size_t)placement.param);
+  }
+
+  return 0;
+}
+
+// Returns the number of nodes per window for LIST_GEN_WINDOW.
+static size_t window_nodes(const ListGenOrder order, const size_t size) {
+  const size_t nodes = (size_t)(order.param / size);
+  return nodes ? nodes : 1;
+}
+
+// Links the nodes in the order 'perm[lo]' through 'perm[hi - 1]'.  The last
+// one links to 'perm[hi]', or to NULL at the end of the list.
+static void link_nodes(const NodeMap *const map, const size_t *const perm,
+                       const size_t lo, const size_t hi, const size_t elems) {
+  ListNode *prev = node_at(map, perm[lo]);
+  for (size_t i = lo + 1; i < hi; ++i) {
+    ListNode *const curr = node_at(map, perm[i]);
+    prev->next = curr;
+    prev = curr;
+  }
+  prev->next = hi < elems ? node_at(map, perm[hi]) : NULL;
+}
+
+// Creates a list with the Mersenne Twister.  This is the benchmark's original
+// generator, kept so that results stay comparable with earlier runs.
+static ListNode *generate_mt64(ListGenBuf *const buf, const NodeMap *const map,
+                               const size_t elems, const uint64_t key,
+                               const ListGenOptions *const opts) {
+  if (!buf->mt) {
+    buf->mt = (mt64_state *)check_alloc(malloc(sizeof(mt64_state)));
+  }
+  mt64_state *const mt = buf->mt;
+  size_t *const perm = buf->perm;
+  const ListNodeBenchOps *const lnb_ops = map->lnb_ops;
+  const DistContext ctx =
+      init_dist(opts->dist, elems, list_gen_ctr_rand(key, 3));
+  init_genrand64_r(mt, key);
+
+  // Randomize the values.  Uniform values go in node order, which keeps the
+  // lists the same as earlier versions of the benchmark.
+  if (ctx.kind == LIST_GEN_UNIFORM) {
+    for (size_t i = 0; i < elems; ++i) {
+      lnb_ops->randomize(node_at(map, i), genrand64_int64_r(mt));
+    }
+  }
+
+  // Prepare to make a random permutation of nodes.
+  for (size_t i = 0; i < elems; ++i) {
+    perm[i] = i;
+  }
+
+  // Fisher-Yates shuffle the node order, either all at once or one window at
+  // a time.
+  if (opts->order.kind != LIST_GEN_ALLOC) {
+    const size_t window = opts->order.kind == LIST_GEN_WINDOW
+                        ? window_nodes(opts->order, lnb_ops->size) : elems;
+    for (size_t lo = 0; lo < elems; lo += window) {
+      const size_t hi = elems - lo > window ? lo + window : elems;
+      for (size_t i = lo; i < hi; ++i) {
+        size_t j = i + (hi - i) * genrand64_real2_r(mt);
+        size_t t = perm[i];
+        perm[i] = perm[j];
+        perm[j] = t;
+      }
+    }
+  }
+
+  // Other distributions give values in list order.
+  if (ctx.kind != LIST_GEN_UNIFORM) {
+    for (size_t i = 0; i < elems; ++i) {
+      lnb_ops->randomize(node_at(map, perm[i]),
+                         dist_value(&ctx, i, genrand64_int64_r(mt)));
+    }
+    for (size_t i = 0; i < ctx.swaps; ++i) {
+      const uint64_t rand_a = genrand64_int64_r(mt);
+      const uint64_t rand_b = genrand64_int64_r(mt);
+      swap_nodes(perm, elems, rand_a, rand_b);
+    }
+  }
+
+  // String together the linked list.
+  link_nodes(map, perm, 0, elems, elems);
+  return node_at(map, perm[0]);
+}
+
+// The state LIST_GEN_CTR's threads share.  The shuffle works on segments of
+// 'perm':  the buckets for LIST_GEN_SHUFFLE, the windows for LIST_GEN_WINDOW,
+// and the chunks for LIST_GEN_ALLOC.
+typedef struct {
+  const NodeMap *map;
+  size_t elems;
+  size_t *perm;
+  size_t *counts;        // counts[c * buckets + b] is chunk c's bucket b.
+  size_t *bucket_start;  // Where each bucket starts in 'perm'.
+  const DistContext *dist;
+  ListGenOrderKind order;
+  size_t window;         // Nodes per window for LIST_GEN_WINDOW.
+  size_t segments;
+  uint64_t value_key, bucket_key, shuffle_key, swap_key;
+  int chunks, buckets, threads;
+  pthread_barrier_t barrier;
+} CtrGenShared;
+
+typedef struct {
+  CtrGenShared *shared;
+  int index;
+} CtrGenWorker;
+
+// Returns the bucket node 'i' scatters to.
+static inline size_t bucket_of(const CtrGenShared *const shared,
+                               const size_t i) {
+  return scale_rand(list_gen_ctr_rand(shared->bucket_key, i),
+                    shared->buckets);
+}
+
+// Returns the first node index in chunk 'c'.
+static inline size_t chunk_start(const CtrGenShared *const shared,
+                                 const int c) {
+  return shared->elems * c / shared->chunks;
+}
+
+// Finds the range of positions [*lo, *hi) that segment 's' covers.
+static inline void segment_range(const CtrGenShared *const shared,
+                                 const size_t s, size_t *const lo,
+                                 size_t *const hi) {
+  switch (shared->order) {
+    case LIST_GEN_SHUFFLE:
+      *lo = shared->bucket_start[s];
+      *hi = shared->bucket_start[s + 1];
+      break;
+
+    case LIST_GEN_WINDOW:
+      *lo = s * shared->window;
+      *hi = shared->elems - *lo > shared->window ? *lo + shared->window
+                                                 : shared->elems;
+      break;
+
+    case LIST_GEN_ALLOC:
+      *lo = chunk_start(shared, (int)s);
+      *hi = chunk_start(shared, (int)s + 1);
+      break;
+  }
+}
+
+// Runs one thread's share of LIST_GEN_CTR.  Thread 'index' takes every
+// 'threads'th chunk and a contiguous share of the segments, and the threads
+// meet at a barrier between steps.
+static void *ctr_gen_worker(void *const arg) {
+  const CtrGenWorker *const worker = (const CtrGenWorker *)arg;
+  CtrGenShared *const shared = worker->shared;
+  const NodeMap *const map = shared->map;
+  const ListNodeBenchOps *const lnb_ops = map->lnb_ops;
+  const size_t buckets = shared->buckets;
+  size_t *const perm = shared->perm;
+
+  const DistContext *const dist = shared->dist;
+  const bool uniform = dist->kind == LIST_GEN_UNIFORM;
+  const bool scatter = shared->order == LIST_GEN_SHUFFLE;
+
+  // Randomize uniform values in node order.  For a full shuffle, count how
+  // many nodes each chunk sends to each bucket.  Otherwise, start from
+  // allocation order.
+  for (int c = worker->index; c < shared->chunks; c += shared->threads) {
+    size_t *const count = &shared->counts[c * buckets];
+    if (scatter) {
+      memset(count, 0, sizeof(size_t) * buckets);
+    }
+    for (size_t i = chunk_start(shared, c); i < chunk_start(shared, c + 1);
+         ++i) {
+      if (uniform) {
+        lnb_ops->randomize(node_at(map, i),
+                           list_gen_ctr_rand(shared->value_key, i));
+      }
+      if (scatter) {
+        count[bucket_of(shared, i)]++;
+      } else {
+        perm[i] = i;
+      }
+    }
+  }
+  pthread_barrier_wait(&shared->barrier);
+
+  if (scatter) {
+    // Turn the counts into offsets.  Buckets go in order, and within each
+    // bucket, chunks go in order.
+    if (worker->index == 0) {
+      size_t offset = 0;
+      for (size_t b = 0; b < buckets; ++b) {
+        shared->bucket_start[b] = offset;
+        for (int c = 0; c < shared->chunks; ++c) {
+          const size_t count = shared->counts[c * buckets + b];
+          shared->counts[c * buckets + b] = offset;
+          offset += count;
+        }
+      }
+      shared->bucket_start[buckets] = offset;
+    }
+    pthread_barrier_wait(&shared->barrier);
+
+    // Scatter the node indices into their buckets.
+    for (int c = worker->index; c < shared->chunks; c += shared->threads) {
+      size_t *const offset = &shared->counts[c * buckets];
+      for (size_t i = chunk_start(shared, c); i < chunk_start(shared, c + 1);
+           ++i) {
+        perm[offset[bucket_of(shared, i)]++] = i;
+      }
+    }
+    pthread_barrier_wait(&shared->barrier);
+  }
+
+  // Fisher-Yates shuffle each segment.  Each position draws its own random
+  // number, so no segment depends on another.  That fixes the segment's
+  // positions in the list, so give other distributions their values in list
+  // order while the segment is in cache.
+  const size_t seg_lo = shared->segments * worker->index / shared->threads;
+  const size_t seg_hi =
+      shared->segments * (worker->index + 1) / shared->threads;
+  for (size_t s = seg_lo; s < seg_hi; ++s) {
+    size_t lo = 0, hi = 0;
+    segment_range(shared, s, &lo, &hi);
+    if (shared->order != LIST_GEN_ALLOC) {
+      for (size_t i = lo; i < hi; ++i) {
+        const size_t j =
+            i + scale_rand(list_gen_ctr_rand(shared->shuffle_key, i), hi - i);
+        const size_t t = perm[i];
+        perm[i] = perm[j];
+        perm[j] = t;
+      }
+    }
+    if (!uniform) {
+      for (size_t i = lo; i < hi; ++i) {
+        lnb_ops->randomize(
+            node_at(map, perm[i]),
+            dist_value(dist, i, list_gen_ctr_rand(shared->value_key, i)));
+      }
+    }
+  }
+  pthread_barrier_wait(&shared->barrier);
+
+  // Swapping depends on the order of the swaps, so one thread does it.
+  if (dist->swaps) {
+    if (worker->index == 0) {
+      for (size_t i = 0; i < dist->swaps; ++i) {
+        swap_nodes(perm, shared->elems,
+                   list_gen_ctr_rand(shared->swap_key, 2 * i),
+                   list_gen_ctr_rand(shared->swap_key, 2 * i + 1));
+      }
+    }
+    pthread_barrier_wait(&shared->barrier);
+  }
+
+  // String together the linked list, one chunk of positions at a time.
+  for (int c = worker->index; c < shared->chunks; c += shared->threads) {
+    link_nodes(map, perm, chunk_start(shared, c), chunk_start(shared, c + 1),
+               shared->elems);
+  }
+
+  return NULL;
+}
+
+// Creates a list with the counter-based generator.  Scattering the nodes into
+// uniformly random buckets and then uniformly shuffling each bucket gives a
+// uniformly random permutation.
+static ListNode *generate_ctr(ListGenBuf *const buf, const NodeMap *const map,
+                              const size_t elems, const uint64_t key,
+                              const ListGenOptions *const opts) {
+  if (!buf->counts) {
+    buf->counts = (size_t *)check_alloc(
+        malloc(sizeof(size_t) * (MAX_CHUNKS * MAX_BUCKETS + MAX_BUCKETS + 1)));
+  }
+
+  size_t chunks = elems / CHUNK_NODES;
+  chunks = chunks < 1 ? 1 : chunks > MAX_CHUNKS ? MAX_CHUNKS : chunks;
+  size_t buckets = elems / BUCKET_NODES;
+  buckets = buckets < 1 ? 1 : buckets > MAX_BUCKETS ? MAX_BUCKETS : buckets;
+
+  int threads = opts->threads;
+  if (threads <= 0) {
+    threads = online_cpus();
+  }
+  if ((size_t)threads > chunks) {
+    threads = (int)chunks;
+  }
+
+  const DistContext ctx =
+      init_dist(opts->dist, elems, list_gen_ctr_rand(key, 3));
+  CtrGenShared shared = {
+    .map = map,
+    .elems = elems,
+    .perm = buf->perm,
+    .counts = buf->counts,
+    .bucket_start = buf->counts + MAX_CHUNKS * MAX_BUCKETS,
+    .dist = &ctx,
+    .order = opts->order.kind,
+    .window = window_nodes(opts->order, map->lnb_ops->size),
+    .value_key = list_gen_ctr_rand(key, 0),
+    .bucket_key = list_gen_ctr_rand(key, 1),
+    .shuffle_key = list_gen_ctr_rand(key, 2),
+    .swap_key = list_gen_ctr_rand(key, 4),
+    .chunks = (int)chunks,
+    .buckets = (int)buckets,
+    .threads = threads
+  };
+  switch (shared.order) {
+    case LIST_GEN_SHUFFLE:
+      shared.segments = buckets;
+      break;
+    case LIST_GEN_WINDOW:
+      shared.segments = (elems + shared.window - 1) / shared.window;
+      break;
+    case LIST_GEN_ALLOC:
+      shared.segments = chunks;
+      break;
+  }
+
+  CtrGenWorker worker[MAX_CHUNKS];
+  pthread_t thread[MAX_CHUNKS];
+
+  pthread_barrier_init(&shared.barrier, NULL, threads);
+  for (int t = 0; t < threads; ++t) {
+    worker[t].shared = &shared;
+    worker[t].index = t;
+  }
+
+  // The calling thread acts as worker 0.
+  for (int t = 1; t < threads; ++t) {
+    if (pthread_create(&thread[t], NULL, ctr_gen_worker, &worker[t])) {
+      fprintf(stderr, "Could not create list generator thread.\n");
+      exit(1);
+    }
+  }
+  ctr_gen_worker(&worker[0]);
+  for (int t = 1; t < threads; ++t) {
+    pthread_join(thread[t], NULL);
+  }
+  pthread_barrier_destroy(&shared.barrier);
+
+  return node_at(map, buf->perm[0]);
+}
+
+// Creates a randomized linked list.  See the header for details.
+ListNode *list_gen_generate_opts(ListGenBuf *const buf,
+                                 const ListNodeBenchOps *const lnb_ops,
+                                 void *const list_buf, const size_t elems,
+                                 const uint64_t seed,
+                                 const ListGenOptions *const opts) {
+  if (!elems) {
+    return NULL;
+  }
+
+  if (elems > buf->elems) {
+    buf->perm = (size_t *)check_alloc(
+        realloc(buf->perm, sizeof(size_t) * elems));
+    buf->elems = elems;
+  }
+
+  // The constant is intended to "temper" simple seeds like 1, 2, 3.
+  const uint64_t key = seed ^ 0x0A1A2A3A4A5A6A7Aull;
+  const NodeMap map = place_nodes(buf, lnb_ops, list_buf, elems,
+                                  opts->placement, list_gen_ctr_rand(key, 5));
+
+  if (opts->rng == LIST_GEN_CTR) {
+    return generate_ctr(buf, &map, elems, key, opts);
+  }
+  return generate_mt64(buf, &map, elems, key, opts);
+}
+
+// Same as above, using the options set by the setters.
+ListNode *list_gen_generate(ListGenBuf *const buf,
+                            const ListNodeBenchOps *const lnb_ops,
+                            void *const list_buf, const size_t elems,
+                            const uint64_t seed) {
+  return list_gen_generate_opts(buf, lnb_ops, list_buf, elems, seed,
+                                &list_gen_selected);
+}
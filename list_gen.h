@@ -0,0 +1,198 @@
+// Generates randomized linked lists for the benchmark.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#ifndef LIST_GEN_H_
+#define LIST_GEN_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "list_bench.h"
+#include "list_node.h"
+#include "mt64.h"
+
+// Selects the random number generator behind the list generator.
+typedef enum {
+  // The 64-bit Mersenne Twister.  It can only run serially, but it produces
+  // the same lists as earlier versions of the benchmark.
+  LIST_GEN_MT64,
+
+  // A counter-based generator.  Each random number is a pure function of the
+  // seed and its position, so the generator can split its work across threads
+  // and still produce the same lists.
+  LIST_GEN_CTR
+} ListGenRng;
+
+// Selects the distribution of values in the list, in list order.  Except for
+// LIST_GEN_UNIFORM, the values fall in [0, elems).
+typedef enum {
+  LIST_GEN_UNIFORM,   // Uniformly random 64-bit values.
+  LIST_GEN_SORTED,    // Already sorted.
+  LIST_GEN_REVERSE,   // Sorted in reverse.
+  LIST_GEN_NEARLY,    // Sorted, then 'param' * elems random pairs swapped.
+  LIST_GEN_SAWTOOTH,  // 'param' ascending teeth of equal length and range.
+  LIST_GEN_ORGAN,     // Organ pipe:  ascending, then descending.
+  LIST_GEN_FEW,       // Uniformly random among 'param' distinct values.
+  LIST_GEN_ZIPF,      // Zipfian duplicates, with exponent 'param'.
+  LIST_GEN_RUNS       // 'param' ascending runs, each from a random start.
+} ListGenDistKind;
+
+// A distribution and its parameter.
+typedef struct {
+  ListGenDistKind kind;
+  double param;
+} ListGenDist;
+
+// Selects where the nodes live in memory.
+typedef enum {
+  LIST_GEN_DENSE,   // Packed into the caller's buffer, in index order.
+  LIST_GEN_MALLOC,  // Each node from its own call to malloc.
+  LIST_GEN_ARENA    // In an arena, each after a random gap of 0 to 'param'
+                    // bytes, to model a fragmented heap.
+} ListGenPlacementKind;
+
+// A placement and its parameter.
+typedef struct {
+  ListGenPlacementKind kind;
+  double param;
+} ListGenPlacement;
+
+// Selects the order the list links the nodes in, relative to the order they
+// were allocated in.
+typedef enum {
+  LIST_GEN_SHUFFLE,  // Uniformly random.
+  LIST_GEN_WINDOW,   // Uniformly random within consecutive windows of 'param'
+                     // bytes' worth of nodes.
+  LIST_GEN_ALLOC     // Allocation order.
+} ListGenOrderKind;
+
+// An order and its parameter.
+typedef struct {
+  ListGenOrderKind kind;
+  double param;
+} ListGenOrder;
+
+// Everything that shapes a generated list, other than its length and seed.
+typedef struct {
+  ListGenRng rng;
+  ListGenDist dist;
+  ListGenPlacement placement;
+  ListGenOrder order;
+  int threads;  // Threads for LIST_GEN_CTR.  Zero means one per online CPU.
+} ListGenOptions;
+
+// Returns a random number from a counter-based generator:  a SplitMix64 hash
+// of 'key' and 'counter'.  Each key gives a different stream.
+static inline uint64_t list_gen_ctr_rand(const uint64_t key,
+                                         const uint64_t counter) {
+  uint64_t z = key + (counter + 1) * 0x9E3779B97F4A7C15ull;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+// Parses a generator name ("mt64" or "ctr").  Returns false if it doesn't
+// recognize the name.
+bool list_gen_parse_rng(const char *name, ListGenRng *rng);
+
+// Returns the name of a generator.
+const char *list_gen_rng_name(ListGenRng rng);
+
+// Parses a distribution, given as a name optionally followed by a colon and
+// its parameter, e.g. "zipf:1.2".  Distributions that take a parameter have a
+// default.  Returns false if it doesn't recognize the name, or the parameter
+// is out of range.
+bool list_gen_parse_dist(const char *spec, ListGenDist *dist);
+
+// Writes a distribution in the form list_gen_parse_dist accepts to 'str'.
+void list_gen_dist_name(ListGenDist dist, char *str, size_t size);
+
+// Same as list_gen_parse_dist, for placements:  "dense", "malloc" or
+// "arena[:<max gap bytes>]".
+bool list_gen_parse_placement(const char *spec, ListGenPlacement *placement);
+
+// Writes a placement in the form list_gen_parse_placement accepts to 'str'.
+void list_gen_placement_name(ListGenPlacement placement, char *str,
+                             size_t size);
+
+// Same as list_gen_parse_dist, for orders:  "shuffle",
+// "window[:<window bytes>]" or "alloc".
+bool list_gen_parse_order(const char *spec, ListGenOrder *order);
+
+// Writes an order in the form list_gen_parse_order accepts to 'str'.
+void list_gen_order_name(ListGenOrder order, char *str, size_t size);
+
+// Sets the generator list_gen_generate uses.  The default is LIST_GEN_MT64.
+void list_gen_set_rng(ListGenRng rng);
+
+// Sets the distribution list_gen_generate uses.  The default is
+// LIST_GEN_UNIFORM.
+void list_gen_set_dist(ListGenDist dist);
+
+// Sets the placement list_gen_generate uses.  The default is LIST_GEN_DENSE.
+void list_gen_set_placement(ListGenPlacement placement);
+
+// Sets the order list_gen_generate uses.  The default is LIST_GEN_SHUFFLE.
+void list_gen_set_order(ListGenOrder order);
+
+// Sets the number of threads list_gen_generate uses with LIST_GEN_CTR.  Zero
+// (the default) means "one thread per online CPU."  LIST_GEN_MT64 always runs
+// in the calling thread.
+void list_gen_set_threads(int threads);
+
+// Returns the options list_gen_generate uses.
+ListGenOptions list_gen_options(void);
+
+// Holds the list generator's working buffers, and the nodes themselves for
+// LIST_GEN_MALLOC and LIST_GEN_ARENA.  Those stay valid until the next list
+// generated with the same ListGenBuf.  Start with a zeroed ListGenBuf and free
+// it with list_gen_buf_free.  Each thread that generates lists needs its own.
+typedef struct {
+  size_t *perm;     // The node order.
+  size_t *counts;   // Bucket counts per chunk, for the parallel shuffle.
+  size_t elems;     // Holds the size of 'perm', in elements.
+  mt64_state *mt;   // State for LIST_GEN_MT64.
+
+  ListNode **malloc_nodes;  // The nodes for LIST_GEN_MALLOC.
+  size_t malloc_elems, malloc_size;
+
+  ListNode **arena_nodes;   // The nodes for LIST_GEN_ARENA.
+  size_t arena_elems;
+  char *arena;
+  size_t arena_bytes;
+} ListGenBuf;
+
+// Frees a ListGenBuf's buffers.
+void list_gen_buf_free(ListGenBuf *buf);
+
+// Returns about how many bytes a ListGenBuf allocates for a list of 'elems'
+// nodes of 'size' bytes each with 'placement':  the nodes and the table that
+// finds them.  That's zero for LIST_GEN_DENSE, which uses the caller's buffer,
+// and can be several times the list buffer's size for LIST_GEN_ARENA with wide
+// gaps.
+size_t list_gen_placement_bytes(ListGenPlacement placement, size_t elems,
+                                size_t size);
+
+// Creates a randomized linked list of 'elems' nodes, with the specified seed.
+// The nodes live in 'list_buf' for LIST_GEN_DENSE, and in memory 'buf' owns
+// otherwise.  It gives the nodes values drawn from 'opts->dist', and links
+// them in 'opts->order'.  All of the allocation happens here, so none of it
+// lands in a timed sort.  The list depends only on the options and 'seed',
+// and not on the number of threads.
+//
+// LIST_GEN_CTR shuffles in parallel by scattering the node indices into
+// random buckets, and then shuffling each bucket.  Both steps work on fixed
+// chunks of the list, sized by 'elems' alone, so that the threads only change
+// who does the work.
+ListNode *list_gen_generate_opts(ListGenBuf *buf,
+                                 const ListNodeBenchOps *lnb_ops,
+                                 void *list_buf, size_t elems, uint64_t seed,
+                                 const ListGenOptions *opts);
+
+// Same as above, using the options set by the setters.
+ListNode *list_gen_generate(ListGenBuf *buf, const ListNodeBenchOps *lnb_ops,
+                            void *list_buf, size_t elems, uint64_t seed);
+
+#endif  // LIST_GEN_H_
@@ -0,0 +1,60 @@
+// Counts the work a sort does, independent of the machine it runs on.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#ifndef LIST_INSTRUMENT_H_
+#define LIST_INSTRUMENT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// The work counted so far.
+typedef struct {
+  uint64_t compares;  // Calls to the comparison function.
+  uint64_t links;     // Stores of a node pointer into a 'next' pointer, or
+                      // into the head of a list under construction.
+  uint64_t visits;    // Loads of a 'next' pointer, to step along a list or
+                      // to test for its end.  That includes the checks for
+                      // empty and short lists.  A test and the step right
+                      // after it that load the same pointer count once.
+  uint64_t passes;    // Walks over the whole list, by the sorts that work in
+                      // passes:  wbi1, tdi2 and bui2.
+} ListInstrumentCounts;
+
+// The sorts count their work through these hooks.  They compile to nothing
+// unless LIST_SORT_INSTRUMENT is defined, which 'make instrumented' does.
+// The counters are shared by every thread, so the parallel sorts update them
+// atomically.
+#ifdef LIST_SORT_INSTRUMENT
+extern ListInstrumentCounts list_instrument_counts;
+# define LIST_INSTRUMENT_ADD(counter) \
+    ((void)__atomic_fetch_add(&list_instrument_counts.counter, 1, \
+                              __ATOMIC_RELAXED))
+#else
+# define LIST_INSTRUMENT_ADD(counter) ((void)0)
+#endif
+
+#define LIST_COUNT_COMPARE() LIST_INSTRUMENT_ADD(compares)
+#define LIST_COUNT_LINK()    LIST_INSTRUMENT_ADD(links)
+#define LIST_COUNT_VISIT()   LIST_INSTRUMENT_ADD(visits)
+#define LIST_COUNT_PASS()    LIST_INSTRUMENT_ADD(passes)
+
+// Loads 'node->next' and counts the visit, for loads inside a condition.
+#define LIST_VISIT_NEXT(node) (LIST_COUNT_VISIT(), (node)->next)
+
+// Returns true if this build counts work.
+static inline bool list_instrument_enabled(void) {
+#ifdef LIST_SORT_INSTRUMENT
+  return true;
+#else
+  return false;
+#endif
+}
+
+// Zeroes the counts.
+void list_instrument_reset(void);
+
+// Returns the counts so far.  Always zero unless this build counts work.
+ListInstrumentCounts list_instrument_read(void);
+
+#endif  // LIST_INSTRUMENT_H_
@@ -0,0 +1,258 @@
+// Leaf sorts for hybrid merge sorts:  sorting networks and binary insertion
+// sort, over short runs of list nodes gathered into an array.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#include "list_leaf.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *const kind_names[] = {
+  [LIST_LEAF_NETWORK] = "network",
+  [LIST_LEAF_INSERTION] = "insertion"
+};
+
+// Parses a leaf size, 2 through LIST_LEAF_MAX_SIZE.
+static bool parse_size(const char *const str, int *const size) {
+  char *end;
+  const long value = strtol(str, &end, 10);
+  if (end == str || *end || value < 2 || value > LIST_LEAF_MAX_SIZE) {
+    return false;
+  }
+  *size = (int)value;
+  return true;
+}
+
+// Parses a leaf sort.  A bare size means a sorting network.
+bool list_leaf_parse(const char *const spec, ListLeaf *const leaf) {
+  const char *const colon = strchr(spec, ':');
+  if (!colon) {
+    leaf->kind = LIST_LEAF_NETWORK;
+    return parse_size(spec, &leaf->size);
+  }
+
+  const size_t name_len = (size_t)(colon - spec);
+  for (size_t i = 0; i < sizeof(kind_names) / sizeof(kind_names[0]); ++i) {
+    if (strlen(kind_names[i]) == name_len &&
+        !strncmp(spec, kind_names[i], name_len)) {
+      leaf->kind = (ListLeafKind)i;
+      return parse_size(colon + 1, &leaf->size);
+    }
+  }
+  return false;
+}
+
+// Writes a leaf sort to 'str'.
+void list_leaf_name(const ListLeaf leaf, char *const str, const size_t size) {
+  snprintf(str, size, "%s:%d", kind_names[leaf.kind], leaf.size);
+}
+
+// Clamps a leaf's size.
+ListLeaf list_leaf_clamp(ListLeaf leaf) {
+  leaf.size = leaf.size < 2 ? 2
+            : leaf.size > LIST_LEAF_MAX_SIZE ? LIST_LEAF_MAX_SIZE : leaf.size;
+  return leaf;
+}
+
+// The smallest known sorting networks for 2 through 16 inputs, as lists of
+// compare-exchanges, one layer per line.  All but 15 come from Bert
+// Dobbelaere's list of smallest sorting networks; 15 is 16's network with its
+// top input taken out.  Each was checked against every 0/1 input.
+#define NETWORK_2(CX)                                                         \
+  CX(0, 1)
+#define NETWORK_3(CX)                                                         \
+  CX(0, 2)                                                                    \
+  CX(0, 1)                                                                    \
+  CX(1, 2)
+#define NETWORK_4(CX)                                                         \
+  CX(0, 2) CX(1, 3)                                                           \
+  CX(0, 1) CX(2, 3)                                                           \
+  CX(1, 2)
+#define NETWORK_5(CX)                                                         \
+  CX(0, 3) CX(1, 4)                                                           \
+  CX(0, 2) CX(1, 3)                                                           \
+  CX(0, 1) CX(2, 4)                                                           \
+  CX(1, 2) CX(3, 4)                                                           \
+  CX(2, 3)
+#define NETWORK_6(CX)                                                         \
+  CX(0, 5) CX(1, 3) CX(2, 4)                                                  \
+  CX(1, 2) CX(3, 4)                                                           \
+  CX(0, 3) CX(2, 5)                                                           \
+  CX(0, 1) CX(2, 3) CX(4, 5)                                                  \
+  CX(1, 2) CX(3, 4)
+#define NETWORK_7(CX)                                                         \
+  CX(0, 6) CX(2, 3) CX(4, 5)                                                  \
+  CX(0, 2) CX(1, 4) CX(3, 6)                                                  \
+  CX(0, 1) CX(2, 5) CX(3, 4)                                                  \
+  CX(1, 2) CX(4, 6)                                                           \
+  CX(2, 3) CX(4, 5)                                                           \
+  CX(1, 2) CX(3, 4) CX(5, 6)
+#define NETWORK_8(CX)                                                         \
+  CX(0, 2) CX(1, 3) CX(4, 6) CX(5, 7)                                         \
+  CX(0, 4) CX(1, 5) CX(2, 6) CX(3, 7)                                         \
+  CX(0, 1) CX(2, 3) CX(4, 5) CX(6, 7)                                         \
+  CX(2, 4) CX(3, 5)                                                           \
+  CX(1, 4) CX(3, 6)                                                           \
+  CX(1, 2) CX(3, 4) CX(5, 6)
+#define NETWORK_9(CX)                                                         \
+  CX(0, 3) CX(1, 7) CX(2, 5) CX(4, 8)                                         \
+  CX(0, 7) CX(2, 4) CX(3, 8) CX(5, 6)                                         \
+  CX(0, 2) CX(1, 3) CX(4, 5) CX(7, 8)                                         \
+  CX(1, 4) CX(3, 6) CX(5, 7)                                                  \
+  CX(0, 1) CX(2, 4) CX(3, 5) CX(6, 8)                                         \
+  CX(2, 3) CX(4, 5) CX(6, 7)                                                  \
+  CX(1, 2) CX(3, 4) CX(5, 6)
+#define NETWORK_10(CX)                                                        \
+  CX(0, 8) CX(1, 9) CX(2, 7) CX(3, 5) CX(4, 6)                                \
+  CX(0, 2) CX(1, 4) CX(5, 8) CX(7, 9)                                         \
+  CX(0, 3) CX(2, 4) CX(5, 7) CX(6, 9)                                         \
+  CX(0, 1) CX(3, 6) CX(8, 9)                                                  \
+  CX(1, 5) CX(2, 3) CX(4, 8) CX(6, 7)                                         \
+  CX(1, 2) CX(3, 5) CX(4, 6) CX(7, 8)                                         \
+  CX(2, 3) CX(4, 5) CX(6, 7)                                                  \
+  CX(3, 4) CX(5, 6)
+#define NETWORK_11(CX)                                                        \
+  CX(0, 9) CX(1, 6) CX(2, 4) CX(3, 7) CX(5, 8)                                \
+  CX(0, 1) CX(3, 5) CX(4, 10) CX(6, 9) CX(7, 8)                               \
+  CX(1, 3) CX(2, 5) CX(4, 7) CX(8, 10)                                        \
+  CX(0, 4) CX(1, 2) CX(3, 7) CX(5, 9) CX(6, 8)                                \
+  CX(0, 1) CX(2, 6) CX(4, 5) CX(7, 8) CX(9, 10)                               \
+  CX(2, 4) CX(3, 6) CX(5, 7) CX(8, 9)                                         \
+  CX(1, 2) CX(3, 4) CX(5, 6) CX(7, 8)                                         \
+  CX(2, 3) CX(4, 5) CX(6, 7)
+#define NETWORK_12(CX)                                                        \
+  CX(0, 8) CX(1, 7) CX(2, 6) CX(3, 11) CX(4, 10) CX(5, 9)                     \
+  CX(0, 1) CX(2, 5) CX(3, 4) CX(6, 9) CX(7, 8) CX(10, 11)                     \
+  CX(0, 2) CX(1, 6) CX(5, 10) CX(9, 11)                                       \
+  CX(0, 3) CX(1, 2) CX(4, 6) CX(5, 7) CX(8, 11) CX(9, 10)                     \
+  CX(1, 4) CX(3, 5) CX(6, 8) CX(7, 10)                                        \
+  CX(1, 3) CX(2, 5) CX(6, 9) CX(8, 10)                                        \
+  CX(2, 3) CX(4, 5) CX(6, 7) CX(8, 9)                                         \
+  CX(4, 6) CX(5, 7)                                                           \
+  CX(3, 4) CX(5, 6) CX(7, 8)
+#define NETWORK_13(CX)                                                        \
+  CX(0, 12) CX(1, 10) CX(2, 9) CX(3, 7) CX(5, 11) CX(6, 8)                    \
+  CX(1, 6) CX(2, 3) CX(4, 11) CX(7, 9) CX(8, 10)                              \
+  CX(0, 4) CX(1, 2) CX(3, 6) CX(7, 8) CX(9, 10) CX(11, 12)                    \
+  CX(4, 6) CX(5, 9) CX(8, 11) CX(10, 12)                                      \
+  CX(0, 5) CX(3, 8) CX(4, 7) CX(6, 11) CX(9, 10)                              \
+  CX(0, 1) CX(2, 5) CX(6, 9) CX(7, 8) CX(10, 11)                              \
+  CX(1, 3) CX(2, 4) CX(5, 6) CX(9, 10)                                        \
+  CX(1, 2) CX(3, 4) CX(5, 7) CX(6, 8)                                         \
+  CX(2, 3) CX(4, 5) CX(6, 7) CX(8, 9)                                         \
+  CX(3, 4) CX(5, 6)
+#define NETWORK_14(CX)                                                        \
+  CX(0, 1) CX(2, 3) CX(4, 5) CX(6, 7) CX(8, 9) CX(10, 11) CX(12, 13)          \
+  CX(0, 2) CX(1, 3) CX(4, 8) CX(5, 9) CX(10, 12) CX(11, 13)                   \
+  CX(0, 4) CX(1, 2) CX(3, 7) CX(5, 8) CX(6, 10) CX(9, 13) CX(11, 12)          \
+  CX(0, 6) CX(1, 5) CX(3, 9) CX(4, 10) CX(7, 13) CX(8, 12)                    \
+  CX(2, 10) CX(3, 11) CX(4, 6) CX(7, 9)                                       \
+  CX(1, 3) CX(2, 8) CX(5, 11) CX(6, 7) CX(10, 12)                             \
+  CX(1, 4) CX(2, 6) CX(3, 5) CX(7, 11) CX(8, 10) CX(9, 12)                    \
+  CX(2, 4) CX(3, 6) CX(5, 8) CX(7, 10) CX(9, 11)                              \
+  CX(3, 4) CX(5, 6) CX(7, 8) CX(9, 10)                                        \
+  CX(6, 7)
+#define NETWORK_15(CX)                                                        \
+  CX(0, 13) CX(1, 12) CX(3, 14) CX(4, 8) CX(5, 6) CX(7, 11) CX(9, 10)         \
+  CX(0, 5) CX(1, 7) CX(2, 9) CX(3, 4) CX(6, 13) CX(8, 14) CX(11, 12)          \
+  CX(0, 1) CX(2, 3) CX(4, 5) CX(6, 8) CX(7, 9) CX(10, 11) CX(12, 13)          \
+  CX(0, 2) CX(1, 3) CX(4, 10) CX(5, 11) CX(6, 7) CX(8, 9) CX(12, 14)          \
+  CX(1, 2) CX(3, 12) CX(4, 6) CX(5, 7) CX(8, 10) CX(9, 11) CX(13, 14)         \
+  CX(1, 4) CX(2, 6) CX(5, 8) CX(7, 10) CX(9, 13) CX(11, 14)                   \
+  CX(2, 4) CX(3, 6) CX(9, 12) CX(11, 13)                                      \
+  CX(3, 5) CX(6, 8) CX(7, 9) CX(10, 12)                                       \
+  CX(3, 4) CX(5, 6) CX(7, 8) CX(9, 10) CX(11, 12)                             \
+  CX(6, 7) CX(8, 9)
+#define NETWORK_16(CX)                                                        \
+  CX(0, 13) CX(1, 12) CX(2, 15) CX(3, 14) CX(4, 8) CX(5, 6) CX(7, 11)         \
+  CX(9, 10)                                                                   \
+  CX(0, 5) CX(1, 7) CX(2, 9) CX(3, 4) CX(6, 13) CX(8, 14) CX(10, 15)          \
+  CX(11, 12)                                                                  \
+  CX(0, 1) CX(2, 3) CX(4, 5) CX(6, 8) CX(7, 9) CX(10, 11) CX(12, 13)          \
+  CX(14, 15)                                                                  \
+  CX(0, 2) CX(1, 3) CX(4, 10) CX(5, 11) CX(6, 7) CX(8, 9) CX(12, 14)          \
+  CX(13, 15)                                                                  \
+  CX(1, 2) CX(3, 12) CX(4, 6) CX(5, 7) CX(8, 10) CX(9, 11) CX(13, 14)         \
+  CX(1, 4) CX(2, 6) CX(5, 8) CX(7, 10) CX(9, 13) CX(11, 14)                   \
+  CX(2, 4) CX(3, 6) CX(9, 12) CX(11, 13)                                      \
+  CX(3, 5) CX(6, 8) CX(7, 9) CX(10, 12)                                       \
+  CX(3, 4) CX(5, 6) CX(7, 8) CX(9, 10) CX(11, 12)                             \
+  CX(6, 7) CX(8, 9)
+
+// Orders nodes[i] and nodes[j].  Both selects compile to conditional moves,
+// so the only branch is inside the comparison function.
+#define COMPARE_EXCHANGE(i, j)                                                \
+  {                                                                           \
+    ListNode *const x = nodes[i], *const y = nodes[j];                        \
+    const bool swap = cmp(y, x);                                              \
+    nodes[i] = swap ? y : x;                                                  \
+    nodes[j] = swap ? x : y;                                                  \
+  }
+
+// Defines network_<n>, which runs NETWORK_<n> over 'nodes'.
+#define DEFINE_NETWORK(n)                                                     \
+  static void network_##n(ListNode **const nodes,                             \
+                          ListNodeCompareFxn *const cmp) {                    \
+    NETWORK_##n(COMPARE_EXCHANGE)                                             \
+  }
+
+DEFINE_NETWORK(2)
+DEFINE_NETWORK(3)
+DEFINE_NETWORK(4)
+DEFINE_NETWORK(5)
+DEFINE_NETWORK(6)
+DEFINE_NETWORK(7)
+DEFINE_NETWORK(8)
+DEFINE_NETWORK(9)
+DEFINE_NETWORK(10)
+DEFINE_NETWORK(11)
+DEFINE_NETWORK(12)
+DEFINE_NETWORK(13)
+DEFINE_NETWORK(14)
+DEFINE_NETWORK(15)
+DEFINE_NETWORK(16)
+
+typedef void NetworkFxn(ListNode**, ListNodeCompareFxn*);
+
+// The network for each leaf size.  Sizes 0 and 1 are already sorted.
+static NetworkFxn *const networks[LIST_LEAF_MAX_SIZE + 1] = {
+  [2] = network_2, [3] = network_3, [4] = network_4, [5] = network_5,
+  [6] = network_6, [7] = network_7, [8] = network_8, [9] = network_9,
+  [10] = network_10, [11] = network_11, [12] = network_12,
+  [13] = network_13, [14] = network_14, [15] = network_15,
+  [16] = network_16
+};
+
+// Sorts nodes with binary insertion sort.  Each node goes after any equal
+// nodes already placed, so it's stable.  The search updates its bounds with
+// selects rather than branches.
+static void binary_insertion(ListNode **const nodes, const int count,
+                             ListNodeCompareFxn *const cmp) {
+  for (int i = 1; i < count; ++i) {
+    ListNode *const node = nodes[i];
+    int lo = 0, hi = i;
+    while (lo < hi) {
+      const int mid = (lo + hi) / 2;
+      const bool less = cmp(node, nodes[mid]);
+      hi = less ? mid : hi;
+      lo = less ? lo : mid + 1;
+    }
+    memmove(&nodes[lo + 1], &nodes[lo], (i - lo) * sizeof(nodes[0]));
+    nodes[lo] = node;
+  }
+}
+
+// Sorts an array of nodes.
+void list_leaf_sort(ListNode **const nodes, const int count,
+                    ListNodeCompareFxn *const cmp, const ListLeafKind kind) {
+  if (count < 2) {
+    return;
+  }
+  if (kind == LIST_LEAF_INSERTION) {
+    binary_insertion(nodes, count, cmp);
+  } else {
+    networks[count](nodes, cmp);
+  }
+}
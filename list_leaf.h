@@ -0,0 +1,95 @@
+// Leaf sorts for hybrid merge sorts:  sorting networks and binary insertion
+// sort, over short runs of list nodes gathered into an array.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#ifndef LIST_LEAF_H_
+#define LIST_LEAF_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "list_instrument.h"
+#include "list_node.h"
+#include "list_sort.h"
+
+// The largest leaf.  There's a sorting network for every size up to this.
+#define LIST_LEAF_MAX_SIZE (16)
+
+// The default leaf for the hybrid merge sorts.
+#define LIST_LEAF_DEFAULT_KIND (LIST_LEAF_NETWORK)
+#define LIST_LEAF_DEFAULT_SIZE (8)
+
+// Selects how to sort a leaf.
+typedef enum {
+  LIST_LEAF_NETWORK,    // The smallest known sorting network for the leaf's
+                        // size, with branchless compare-exchanges.  Not
+                        // stable.
+  LIST_LEAF_INSERTION   // Binary insertion sort.  Stable.
+} ListLeafKind;
+
+// A leaf sort, and the most nodes it sorts at once.
+typedef struct {
+  ListLeafKind kind;
+  int size;
+} ListLeaf;
+
+// Parses a leaf sort, as "<size>", "network:<size>" or "insertion:<size>".
+// The size must be 2 through LIST_LEAF_MAX_SIZE.  Returns false if it doesn't
+// recognize the leaf sort.
+bool list_leaf_parse(const char *spec, ListLeaf *leaf);
+
+// Writes a leaf sort in the form list_leaf_parse accepts to 'str'.
+void list_leaf_name(ListLeaf leaf, char *str, size_t size);
+
+// Clamps a leaf's size to 2 through LIST_LEAF_MAX_SIZE.
+ListLeaf list_leaf_clamp(ListLeaf leaf);
+
+// Sorts an array of 'count' nodes, up to LIST_LEAF_MAX_SIZE, in place.
+void list_leaf_sort(ListNode **nodes, int count, ListNodeCompareFxn *cmp,
+                    ListLeafKind kind);
+
+// Moves up to 'max' nodes from the front of '*rest' into 'nodes'.  Returns how
+// many it moved, and leaves '*rest' pointing past them.
+static inline int list_leaf_gather(ListNode **const nodes,
+                                   ListNode **const rest, const int max) {
+  ListNode *node = *rest;
+  int count = 0;
+  while (node && count < max) {
+    nodes[count++] = node;
+    node = node->next;
+    LIST_COUNT_VISIT();
+  }
+  *rest = node;
+  return count;
+}
+
+// Links 'count' nodes together in array order, appending them at 'tail'.
+// Returns the address of the last node's 'next' pointer, which it leaves for
+// the caller to set.
+static inline ListNode **list_leaf_link(ListNode *const *const nodes,
+                                        const int count, ListNode **tail) {
+  for (int i = 0; i < count; ++i) {
+    *tail = nodes[i];
+    tail = &nodes[i]->next;
+    LIST_COUNT_LINK();
+  }
+  return tail;
+}
+
+// Takes up to leaf.size nodes from the front of '*rest', and returns them as a
+// sorted, NULL-terminated list.  Sets '*count' to the number of nodes it took.
+static inline ListNode *list_leaf_take(ListNode **const rest,
+                                       const ListLeaf leaf,
+                                       ListNodeCompareFxn *const cmp,
+                                       int *const count) {
+  ListNode *nodes[LIST_LEAF_MAX_SIZE];
+  ListNode *head = NULL;
+  *count = list_leaf_gather(nodes, rest, leaf.size);
+  list_leaf_sort(nodes, *count, cmp, leaf.kind);
+  *list_leaf_link(nodes, *count, &head) = NULL;
+  LIST_COUNT_LINK();
+  return head;
+}
+
+#endif  // LIST_LEAF_H_
@@ -0,0 +1,67 @@
+// Branch-free merge steps for merging linked lists.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#ifndef LIST_MERGE_H_
+#define LIST_MERGE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "list_instrument.h"
+#include "list_node.h"
+#include "list_sort.h"
+
+// The usual merge step, 'cmp(a, b) ? &a : &b', branches on the comparison.
+// On random keys, that branch goes each way about half the time, and the CPU
+// mispredicts it about half the time.  These helpers take the comparison's
+// result as data instead, and pick the node and advance the cursors with
+// masks, so the only branches left are the loop tests.
+
+// Returns 'x' if 'pick_x' is set, and 'y' otherwise, without a branch.
+static inline ListNode *list_merge_select(const bool pick_x, ListNode *const x,
+                                          ListNode *const y) {
+  const uintptr_t mask = -(uintptr_t)pick_x;
+  return (ListNode *)(((uintptr_t)x & mask) | ((uintptr_t)y & ~mask));
+}
+
+// Appends the head of 'a' at '*tail' if 'take_a' is set, and the head of 'b'
+// otherwise, and advances that list's cursor.  Returns the new tail.  It loads
+// both heads' 'next' pointers up front, so those loads don't wait on the
+// comparison.  Only the select does.
+static inline ListNode **list_merge_take(const bool take_a,
+                                         ListNode **const a,
+                                         ListNode **const b,
+                                         ListNode **const tail) {
+  ListNode *const a_next = (*a)->next;
+  ListNode *const b_next = (*b)->next;
+  ListNode *const node = list_merge_select(take_a, *a, *b);
+  *tail = node;
+  *a = list_merge_select(take_a, a_next, *a);
+  *b = list_merge_select(take_a, *b, b_next);
+  LIST_COUNT_LINK();
+  LIST_COUNT_VISIT();
+  return &node->next;
+}
+
+// Returns true if the int64_t 'key_offset' bytes into 'a' is less than the
+// one in 'b'.  This lets the int64 merges compare inline, with no call.
+static inline bool list_merge_less_int64(const ListNode *const a,
+                                         const ListNode *const b,
+                                         const size_t key_offset) {
+  return *(const int64_t *)((const char *)a + key_offset) <
+         *(const int64_t *)((const char *)b + key_offset);
+}
+
+// Compares with 'cmp', or inline as int64_ts if 'cmp' is NULL.  Sorts that
+// offer both paths pass a constant NULL on the int64 path, so once this
+// inlines, each path keeps only its own comparison.
+static inline bool list_merge_less(const ListNode *const a,
+                                   const ListNode *const b,
+                                   ListNodeCompareFxn *const cmp,
+                                   const size_t key_offset) {
+  return cmp ? cmp(a, b) : list_merge_less_int64(a, b, key_offset);
+}
+
+#endif  // LIST_MERGE_H_
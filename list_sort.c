@@ -12,17 +12,51 @@
 #include "tdr2_merge_sort.h"
 #include "tdr3_merge_sort.h"
 #include "tdq1_quick_sort.h"
+#include "pbi1_merge_sort.h"
+#include "ptq1_quick_sort.h"
+#include "nbi1_merge_sort.h"
+#include "fbi2_merge_sort.h"
+#include "ftr2_merge_sort.h"
+#include "fti2_merge_sort.h"
+#include "ami1_merge_sort.h"
+#include "tdq2_quick_sort.h"
+#include "kbi2_merge_sort.h"
+#include "kti2_merge_sort.h"
+#include "gsr1_gather_sort.h"
+#include "gsv1_gather_sort.h"
+#include "mbi1_merge_sort.h"
+#include "lbi2_merge_sort.h"
+#include "ltr2_merge_sort.h"
+#include "lti2_merge_sort.h"
+#include "cbi2_merge_sort.h"
+#include "cti2_merge_sort.h"
+#include "wbi1_merge_sort.h"
+#include "list_instrument.h"
 
 // Actual table of sort functions.  The registry points to this.
 static const SortRegistryEntry sort_registry_entry[] = {
-  { "Bottom-Up Iter. MergeSort 1", bui1_merge_sort },
-  { "Bottom-Up Iter. MergeSort 2", bui2_merge_sort },
-  { "Top-Down Rec. MergeSort 1",  tdr1_merge_sort },
-  { "Top-Down Rec. MergeSort 2",  tdr2_merge_sort },
-  { "Top-Down Rec. MergeSort 3",  tdr3_merge_sort },
-  { "Top-Down Rec. QuickSort 1",  tdq1_quick_sort },
-  { "Top-Down Iter. MergeSort 1", tdi1_merge_sort },
-  { "Top-Down Iter. MergeSort 2", tdi2_merge_sort },
+  { "Bottom-Up Iter. MergeSort 1", bui1_merge_sort, false },
+  { "Bottom-Up Iter. MergeSort 2", bui2_merge_sort, false },
+  { "Top-Down Rec. MergeSort 1",  tdr1_merge_sort, false },
+  { "Top-Down Rec. MergeSort 2",  tdr2_merge_sort, false },
+  { "Top-Down Rec. MergeSort 3",  tdr3_merge_sort, false },
+  { "Top-Down Rec. QuickSort 1",  tdq1_quick_sort, true },
+  { "Top-Down Iter. MergeSort 1", tdi1_merge_sort, false },
+  { "Top-Down Iter. MergeSort 2", tdi2_merge_sort, false },
+  { "Par. Bottom-Up Iter. MergeSort 1", pbi1_merge_sort, false },
+  { "Par. Top-Down QuickSort 1", ptq1_quick_sort, true },
+  { "Natural Bottom-Up MergeSort 1", nbi1_merge_sort, false },
+  { "Prefetch Bottom-Up Iter. MergeSort 2", fbi2_merge_sort, false },
+  { "Prefetch Top-Down Rec. MergeSort 2", ftr2_merge_sort, false },
+  { "Prefetch Top-Down Iter. MergeSort 2", fti2_merge_sort, false },
+  { "Interleaved Top-Down Iter. MergeSort 1", ami1_merge_sort, false },
+  { "Top-Down Rec. QuickSort 2", tdq2_quick_sort, false },
+  { "Leaf Bottom-Up Iter. MergeSort 2", lbi2_merge_sort, false },
+  { "Leaf Top-Down Rec. MergeSort 2", ltr2_merge_sort, false },
+  { "Leaf Top-Down Iter. MergeSort 2", lti2_merge_sort, false },
+  { "Branchless Bottom-Up Iter. MergeSort 2", cbi2_merge_sort, false },
+  { "Branchless Top-Down Iter. MergeSort 2", cti2_merge_sort, false },
+  { "Multiway Bottom-Up Iter. MergeSort 1", wbi1_merge_sort, false },
 };
 
 // Registry of sort functions.
@@ -30,3 +64,52 @@ const SortRegistry sort_registry = {
   .length = sizeof(sort_registry_entry) / sizeof(sort_registry_entry[0]),
   .entry = sort_registry_entry
 };
+
+// Actual table of key-aware sort functions.  The registry points to this.
+static const KeySortRegistryEntry key_sort_registry_entry[] = {
+  { "Key Bottom-Up Iter. MergeSort 2", kbi2_merge_sort },
+  { "Key Top-Down Iter. MergeSort 2", kti2_merge_sort },
+  { "Gather-Sort-Relink 1", gsr1_gather_sort },
+  { "Vector Gather-Sort-Relink 1", gsv1_gather_sort },
+};
+
+// Registry of key-aware sort functions.
+const KeySortRegistry key_sort_registry = {
+  .length = sizeof(key_sort_registry_entry) /
+            sizeof(key_sort_registry_entry[0]),
+  .entry = key_sort_registry_entry
+};
+
+// Actual table of many-list sort functions.  The registry points to this.
+static const ManySortRegistryEntry many_sort_registry_entry[] = {
+  { "Many-List Interleaved MergeSort 1", mbi1_merge_sort_many },
+};
+
+// Registry of many-list sort functions.
+const ManySortRegistry many_sort_registry = {
+  .length = sizeof(many_sort_registry_entry) /
+            sizeof(many_sort_registry_entry[0]),
+  .entry = many_sort_registry_entry
+};
+
+#ifdef LIST_SORT_INSTRUMENT
+ListInstrumentCounts list_instrument_counts;
+#endif
+
+// Zeroes the instrumentation counts.
+void list_instrument_reset(void) {
+#ifdef LIST_SORT_INSTRUMENT
+  const ListInstrumentCounts zero = { 0 };
+  list_instrument_counts = zero;
+#endif
+}
+
+// Returns the instrumentation counts so far.
+ListInstrumentCounts list_instrument_read(void) {
+#ifdef LIST_SORT_INSTRUMENT
+  return list_instrument_counts;
+#else
+  const ListInstrumentCounts zero = { 0 };
+  return zero;
+#endif
+}
@@ -8,6 +8,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include "list_node.h"
 
 // Function type for node comparison functions.  Returns true if the first
@@ -17,10 +18,14 @@ typedef bool ListNodeCompareFxn(const ListNode*, const ListNode*);
 // Function type for list sort functions.  Returns the new head of a list.
 typedef ListNode *ListSortFxn(ListNode*, ListNodeCompareFxn*);
 
-// Defines a registry entry for the sorting algorithm registry.
+// Defines a registry entry for the sorting algorithm registry.  Set
+// 'naive_pivot' for QuickSorts that pivot on the first node.  Those take
+// quadratic time, and recurse as deep as the list is long, on ordered or
+// duplicate-heavy lists, so the benchmark only runs them on uniform lists.
 typedef struct {
     const char *name;
     ListSortFxn *fxn;
+    bool naive_pivot;
 } SortRegistryEntry;
 
 // Defines a registry of sorting algorithms for the benchmarks to refer to, so
@@ -33,4 +38,50 @@ typedef struct sort_registry {
 
 extern const SortRegistry sort_registry;
 
+// Function type for sort key extraction functions.  Returns an unsigned key
+// whose order agrees with the comparison function:  if key(a) < key(b), then
+// a is less than b.  The key may only be a prefix of what the comparison
+// function looks at, so when two keys are equal, sorts must fall back to the
+// comparison function to order the nodes.
+typedef uint64_t ListNodeKeyFxn(const ListNode*);
+
+// Function type for list sort functions that can use sort keys.  Returns the
+// new head of a list.
+typedef ListNode *ListKeySortFxn(ListNode*, ListNodeKeyFxn*,
+                                 ListNodeCompareFxn*);
+
+// Defines a registry entry for the key-aware sorting algorithm registry.
+typedef struct {
+    const char *name;
+    ListKeySortFxn *fxn;
+} KeySortRegistryEntry;
+
+// Defines a registry of key-aware sorting algorithms.  These only apply to
+// list node types that provide a key extraction function.
+typedef struct key_sort_registry {
+  size_t length;
+  const KeySortRegistryEntry *entry;
+} KeySortRegistry;
+
+extern const KeySortRegistry key_sort_registry;
+
+// Function type for sort functions that sort many lists in one call.  Sorts
+// each of the 'count' lists in 'heads', replacing each with its new head.
+typedef void ListSortManyFxn(ListNode**, size_t, ListNodeCompareFxn*);
+
+// Defines a registry entry for the many-list sorting algorithm registry.
+typedef struct {
+    const char *name;
+    ListSortManyFxn *fxn;
+} ManySortRegistryEntry;
+
+// Defines a registry of many-list sorting algorithms.  These apply to every
+// list node type.
+typedef struct many_sort_registry {
+  size_t length;
+  const ManySortRegistryEntry *entry;
+} ManySortRegistry;
+
+extern const ManySortRegistry many_sort_registry;
+
 #endif  // LIST_SORT_H_
@@ -0,0 +1,586 @@
+// Header-only C++ versions of the linked list sorts.  Each sort is templated
+// on the node type, a pointer to the node's 'next' member, and a comparison
+// functor, so that the compiler can inline the comparison into the merge and
+// partition loops rather than calling through a function pointer.
+//
+// The 'next' member can live anywhere in the node; it doesn't need to be at
+// offset 0.  For node types like the C list types, which link through an
+// embedded ListNode, each sort also comes in a version templated on the node
+// type, the hook type, and pointers to the hook and to its 'next' member.
+//
+// Each function mirrors its C counterpart line for line.  See the
+// corresponding .c file for commentary on how each algorithm works.
+//
+// Author:  agent <agent@local>
+// Based on the C sorts by Joe Zbiciak and Drew Eckhardt.
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#ifndef LIST_SORT_HPP_
+#define LIST_SORT_HPP_
+
+#include <cstddef>
+
+namespace list_sort {
+
+namespace internal {
+
+// Merges two sorted lists, returning the head of the merged list.
+template <typename Node, Node *Node::*Next, typename Less>
+inline Node *merge(Node *a, Node *b, Less &less) {
+  Node *merged = nullptr;
+  Node **pnext = &merged;
+
+  // Take the smallest from a or b, as long as both lists are non-empty.
+  while (a && b) {
+    Node **const l = less(a, b) ? &a : &b;
+    *pnext = *l;
+    pnext = &((*pnext)->*Next);
+    *l = (*l)->*Next;
+  }
+
+  // Once we exhaust one list, append the other as-is to the merged list.
+  *pnext = a ? a : b;
+  return merged;
+}
+
+// The sub-list stack used by the bottom-up merge sorts.
+template <typename Node>
+struct MergeStack {
+  static constexpr int kMaxStack = 64;
+
+  struct Entry {
+    std::size_t length;
+    Node *node;
+  };
+
+  int top = 0;
+  Entry stk[kMaxStack];
+
+  void push(std::size_t length, Node *node) {
+    stk[top].length = length;
+    stk[top].node = node;
+    ++top;
+  }
+
+  Node *pop() { return stk[--top].node; }
+
+  std::size_t peek_length(int dist) const { return stk[top - dist].length; }
+};
+
+// Returns a sorted list's head, along with the address of its tail's 'next'
+// pointer.
+template <typename Node>
+struct QuickSortRet {
+  Node *head;
+  Node **tail_next;
+};
+
+template <typename Node, Node *Node::*Next, typename Less>
+QuickSortRet<Node> quick_sort_recurse(Node *const head, Less &less) {
+  const int len = !(head->*Next) ? 1
+                : !(head->*Next->*Next) ? 2
+                : !(head->*Next->*Next->*Next) ? 3
+                : -1;  // "many"
+
+  // Sorting network for 3 nodes:
+  if (len == 3) {
+    Node *a = head;
+    Node *b = a->*Next;
+    Node *c = b->*Next;
+
+    if (!less(a, b)) { Node *const t = a; a = b; b = t; }
+    if (!less(a, c)) { Node *const t = a; a = c; c = t; }
+    if (!less(b, c)) { Node *const t = b; b = c; c = t; }
+
+    a->*Next = b;
+    b->*Next = c;
+    c->*Next = nullptr;
+    return QuickSortRet<Node>{a, &(c->*Next)};
+  }
+
+  // If we're down to 2 nodes, swap them if needed, and return.
+  if (len == 2) {
+    Node *a = head;
+    Node *b = a->*Next;
+
+    if (!less(a, b)) { Node *const t = a; a = b; b = t; }
+
+    a->*Next = b;
+    b->*Next = nullptr;
+    return QuickSortRet<Node>{a, &(b->*Next)};
+  }
+
+  // If we're down to 1 node, just return it.
+  if (len == 1) {
+    return QuickSortRet<Node>{head, &(head->*Next)};
+  }
+
+  Node *const pivot = head;
+  Node *node = head->*Next;
+
+  // Partition the elements around the pivot.  Pull as large of a sublist as
+  // we can, to minimize the number of cachelines we dirty.
+  Node *less_list = nullptr;
+  Node *more_list = nullptr;
+
+  while (node) {
+    Node *const tmp1 = node;
+    Node *tmp2 = node->*Next;
+    Node *ptm2 = tmp1;
+    if (less(tmp1, pivot)) {
+      while (tmp2 && less(tmp2, pivot)) {
+        ptm2 = tmp2;
+        tmp2 = tmp2->*Next;
+      }
+      ptm2->*Next = less_list;
+      less_list = tmp1;
+    } else {
+      while (tmp2 && !less(tmp2, pivot)) {
+        ptm2 = tmp2;
+        tmp2 = tmp2->*Next;
+      }
+      ptm2->*Next = more_list;
+      more_list = tmp1;
+    }
+    node = tmp2;
+  }
+
+  // Sort the sublists.
+  const QuickSortRet<Node> qsm{nullptr, &(pivot->*Next)};
+  const QuickSortRet<Node> qsl{pivot, &node /* dummy */};
+
+  const QuickSortRet<Node> more_ret =
+      more_list ? quick_sort_recurse<Node, Next>(more_list, less) : qsm;
+  const QuickSortRet<Node> less_ret =
+      less_list ? quick_sort_recurse<Node, Next>(less_list, less) : qsl;
+
+  // Reconnect them, with the pivot in the middle.
+  *less_ret.tail_next = pivot;
+  pivot->*Next = more_ret.head;
+
+  return QuickSortRet<Node>{less_ret.head, more_ret.tail_next};
+}
+
+template <typename Node, Node *Node::*Next, typename Less>
+Node *tdr2_merge_sort_internal(Node *const head, Less &less,
+                               const std::size_t length) {
+  // Degenerate list: return as-is.
+  if (length < 2) {
+    return head;
+  }
+
+  // Two-node list: sort and return.
+  if (length == 2) {
+    Node *const a = head;
+    Node *const b = head->*Next;
+    if (less(a, b)) {
+      return head;
+    }
+    b->*Next = a;
+    a->*Next = nullptr;
+    return b;
+  }
+
+  // Find midpoint and cut into two lists.
+  const std::size_t len_a = length / 2, len_b = length - len_a;
+  Node *pmid = head;
+  for (std::size_t i = 1; i < len_a; ++i) {
+    pmid = pmid->*Next;
+  }
+  Node *const mid = pmid->*Next;
+  pmid->*Next = nullptr;
+
+  // Recursively sort the halves, and merge them.
+  Node *const a = tdr2_merge_sort_internal<Node, Next>(head, less, len_a);
+  Node *const b = tdr2_merge_sort_internal<Node, Next>(mid, less, len_b);
+  return merge<Node, Next>(a, b, less);
+}
+
+}  // namespace internal
+
+// Bottom-up iterative power-of-2 collapsing merge sort.  See bui1_merge_sort.c.
+template <typename Node, Node *Node::*Next, typename Less>
+Node *bui1_merge_sort(Node *const first, Less less) {
+  if (!first || !(first->*Next)) {
+    return first;
+  }
+
+  internal::MergeStack<Node> stk;
+
+  // Pushes the first node from the rest of the list onto the stack, and
+  // returns the rest of the list.
+  auto push_first = [&stk](Node *const node) {
+    Node *const rest = node->*Next;
+    node->*Next = nullptr;
+    stk.push(1, node);
+    return rest;
+  };
+
+  Node *rest = push_first(push_first(first));
+
+  do {
+    while (stk.top > 1 &&
+           (!rest || stk.peek_length(1) == stk.peek_length(2))) {
+      const std::size_t length = stk.peek_length(1) + stk.peek_length(2);
+      Node *const a = stk.pop();
+      Node *const b = stk.pop();
+      stk.push(length, internal::merge<Node, Next>(a, b, less));
+    }
+
+    if (rest) {
+      rest = push_first(rest);
+    }
+  } while (stk.top > 1);
+
+  return stk.pop();
+}
+
+// Bottom-up iterative merge sort, pushing sorted pairs.  See bui2_merge_sort.c.
+template <typename Node, Node *Node::*Next, typename Less>
+Node *bui2_merge_sort(Node *const first, Less less) {
+  if (!first || !(first->*Next)) {
+    return first;
+  }
+
+  internal::MergeStack<Node> stk;
+
+  // Pushes the first nodes from the rest of the list onto the stack, and
+  // returns the rest of the list.  Sorts the first two nodes.
+  auto push_first = [&stk, &less](Node *const node) {
+    if (node->*Next) {
+      Node *a = node;
+      Node *const b = a->*Next;
+      Node *const rest = b->*Next;
+      if (less(a, b)) {
+        b->*Next = nullptr;
+      } else {
+        a->*Next = nullptr;
+        b->*Next = a;
+        a = b;
+      }
+      stk.push(2, a);
+      return rest;
+    }
+
+    Node *const rest = node->*Next;
+    node->*Next = nullptr;
+    stk.push(1, node);
+    return rest;
+  };
+
+  Node *rest = push_first(first);
+
+  do {
+    while (stk.top > 1 &&
+           (!rest || stk.peek_length(1) >= stk.peek_length(2))) {
+      const std::size_t length = stk.peek_length(1) + stk.peek_length(2);
+      Node *const a = stk.pop();
+      Node *const b = stk.pop();
+      stk.push(length, internal::merge<Node, Next>(a, b, less));
+    }
+
+    if (rest) {
+      rest = push_first(rest);
+    }
+  } while (stk.top > 1);
+
+  return stk.pop();
+}
+
+// Naive top-down recursive merge sort.  See tdr1_merge_sort.c.
+template <typename Node, Node *Node::*Next, typename Less>
+Node *tdr1_merge_sort(Node *const head, Less less) {
+  // Degenerate list: return as-is.
+  if (!head || !(head->*Next)) {
+    return head;
+  }
+
+  // Two-node list: sort and return.
+  if (!(head->*Next->*Next)) {
+    Node *const a = head;
+    Node *const b = head->*Next;
+    if (less(b, a)) {
+      b->*Next = a;
+      a->*Next = nullptr;
+      return b;
+    }
+    return head;
+  }
+
+  // Find midpoint and cut into two lists.
+  Node *pmid = nullptr, *mid = head, *tail = head;
+  while (tail) {
+    pmid = mid;
+    mid = mid->*Next;
+    tail = tail->*Next;
+    tail = tail ? tail->*Next : nullptr;
+  }
+  pmid->*Next = nullptr;
+
+  // Recursively sort the halves, and merge them.
+  Node *const a = tdr1_merge_sort<Node, Next>(head, less);
+  Node *const b = tdr1_merge_sort<Node, Next>(mid, less);
+  return internal::merge<Node, Next>(a, b, less);
+}
+
+// Top-down recursive merge sort, measuring list length up front.  See
+// tdr2_merge_sort.c.
+template <typename Node, Node *Node::*Next, typename Less>
+Node *tdr2_merge_sort(Node *const head, Less less) {
+  std::size_t length = 0;
+  for (Node *node = head; node; node = node->*Next) {
+    length++;
+  }
+  return internal::tdr2_merge_sort_internal<Node, Next>(head, less, length);
+}
+
+// Top-down recursive merge sort with even/odd splitting.  See
+// tdr3_merge_sort.c.
+template <typename Node, Node *Node::*Next, typename Less>
+Node *tdr3_merge_sort(Node *const head, Less less) {
+  // Degenerate list: return as-is.
+  if (!head || !(head->*Next)) {
+    return head;
+  }
+
+  // Two-node list: sort and return.
+  if (!(head->*Next->*Next)) {
+    Node *const a = head;
+    Node *const b = head->*Next;
+    if (less(b, a)) {
+      b->*Next = a;
+      a->*Next = nullptr;
+      return b;
+    }
+    return head;
+  }
+
+  // Partition incoming list into two, putting even nodes on 'a' and odd nodes
+  // on 'b'.
+  Node *a = nullptr, *b = nullptr;
+  for (Node *node = head, *temp; node; ) {
+    temp = node->*Next;
+    node->*Next = a;
+    a = node;
+    node = temp;
+
+    if (!node) {
+      break;
+    }
+
+    temp = node->*Next;
+    node->*Next = b;
+    b = node;
+    node = temp;
+  }
+
+  // Recursively sort the halves, and merge them.
+  a = tdr3_merge_sort<Node, Next>(a, less);
+  b = tdr3_merge_sort<Node, Next>(b, less);
+  return internal::merge<Node, Next>(a, b, less);
+}
+
+// Drew Eckhardt's top-down iterative merge sort.  See tdi1_merge_sort.c.
+template <typename Node, Node *Node::*Next, typename Less>
+Node *tdi1_merge_sort(Node *const src, Less less) {
+  // Splits off the first 'count' nodes of 'in', returning the rest.
+  auto split_after = [](Node *const in, const std::size_t count) {
+    std::size_t i;
+    Node *rest, **prev;
+
+    for (i = 0, rest = in, prev = nullptr; rest && i < count;
+         ++i, prev = &(rest->*Next), rest = rest->*Next) { }
+
+    if (prev) {
+      *prev = nullptr;
+    }
+    return rest;
+  };
+
+  Node *rest = src, *in_head[2], *out_head, **out_tail;
+  std::size_t increment = 1, merge_src, size;
+
+  do {
+    out_head = nullptr;
+    out_tail = &out_head;
+    size = 0;
+
+    while (rest) {
+      in_head[0] = rest;
+      in_head[1] = split_after(in_head[0], increment);
+      rest = split_after(in_head[1], increment);
+
+      while (in_head[0] || in_head[1]) {
+        merge_src = !in_head[1] ||
+          (in_head[0] && !less(in_head[1], in_head[0])) ? 0 : 1;
+
+        *out_tail = in_head[merge_src];
+        in_head[merge_src] = in_head[merge_src]->*Next;
+
+        (*out_tail)->*Next = nullptr;
+        out_tail = &((*out_tail)->*Next);
+        ++size;
+      }
+    }
+
+    increment *= 2;
+    rest = out_head;
+  } while (increment < size);
+
+  return rest;
+}
+
+// Top-down iterative merge sort, merging while extracting.  See
+// tdi2_merge_sort.c.
+template <typename Node, Node *Node::*Next, typename Less>
+Node *tdi2_merge_sort(Node *const src, Less less) {
+  Node *rest, *out_head, **out_tail;
+  std::size_t increment = 1, size = 0;
+
+  // Scan once to find our size.
+  for (Node *n = src; n; n = n->*Next) {
+    size++;
+  }
+
+  rest = src;
+  while (increment < size) {
+    out_head = nullptr;
+    out_tail = &out_head;
+
+    while (rest) {
+      std::size_t ar = increment, br = increment;
+      Node *a = rest;
+      Node *b = a;
+
+      // Find the start of 'b'.
+      for (std::size_t i = 0; i < increment && b; ++i) {
+        b = b->*Next;
+      }
+
+      // If 'a' was shorter than increment, just append it and break out.
+      if (!b) {
+        rest = nullptr;
+        *out_tail = a;
+        break;
+      }
+
+      // Merge 'b' into 'a'.
+      while (ar && br && b) {
+        Node **const l = less(a, b) ? (--ar, &a) : (--br, &b);
+        *out_tail = *l;
+        out_tail = &((*out_tail)->*Next);
+        *l = (*l)->*Next;
+      }
+
+      // Push any remaining 'a' nodes.
+      while (ar) {
+        *out_tail = a;
+        out_tail = &(a->*Next);
+        a = a->*Next;
+        --ar;
+      }
+
+      // Push any remaining 'b' nodes. 'b' can end early.
+      while (br && b) {
+        *out_tail = b;
+        out_tail = &(b->*Next);
+        b = b->*Next;
+        --br;
+      }
+
+      // Terminate our partial list.
+      *out_tail = nullptr;
+
+      // The final advance on 'b' will make it point to 'rest'.
+      rest = b;
+    }
+
+    increment *= 2;
+    rest = out_head;
+  }
+
+  return rest;
+}
+
+// Naive pivot QuickSort.  See tdq1_quick_sort.c.
+template <typename Node, Node *Node::*Next, typename Less>
+Node *tdq1_quick_sort(Node *const head, Less less) {
+  if (!head) {
+    return head;
+  }
+  return internal::quick_sort_recurse<Node, Next>(head, less).head;
+}
+
+namespace internal {
+
+// Maps between a Node and the Hook embedded in it at 'Member'.  Node must be
+// a standard layout type, like the C list types.
+template <typename Node, typename Hook, Hook Node::*Member>
+struct HookLinks {
+  // Returns the hook's offset within the node.  It's a constant, so this
+  // folds away.
+  static std::size_t offset() {
+    const Node probe{};
+    return reinterpret_cast<const char *>(&(probe.*Member)) -
+           reinterpret_cast<const char *>(&probe);
+  }
+
+  static Hook *hook(Node *const node) {
+    return node ? &(node->*Member) : nullptr;
+  }
+
+  static Node *node(Hook *const hook) {
+    return hook ? reinterpret_cast<Node *>(
+                      reinterpret_cast<char *>(hook) - offset())
+                : nullptr;
+  }
+
+  static const Node *node(const Hook *const hook) {
+    return reinterpret_cast<const Node *>(
+        reinterpret_cast<const char *>(hook) - offset());
+  }
+};
+
+// Compares two hooks by comparing the nodes they're embedded in.
+template <typename Links, typename Less>
+struct HookLess {
+  Less less;
+
+  template <typename Hook>
+  bool operator()(const Hook *const a, const Hook *const b) const {
+    return less(Links::node(a), Links::node(b));
+  }
+};
+
+}  // namespace internal
+
+// Each sort above also works on Nodes that link through a Hook embedded in
+// them at 'Member', where Hook's 'Next' member points at the next node's
+// Hook.  That's how the C list types link, through the ListNode at their
+// start, but the hook can be anywhere in the node.  'less' compares Nodes:
+//
+//   Int64ListNode *sorted = list_sort::bui2_merge_sort<
+//       Int64ListNode, ListNode, &Int64ListNode::node, &ListNode::next>(
+//       head, Int64Less());
+#define LIST_SORT_HOOKED(algo)                                            \
+  template <typename Node, typename Hook, Hook Node::*Member,            \
+            Hook *Hook::*Next, typename Less>                             \
+  Node *algo(Node *const head, Less less) {                              \
+    using Links = internal::HookLinks<Node, Hook, Member>;               \
+    const internal::HookLess<Links, Less> hook_less{less};               \
+    return Links::node(algo<Hook, Next>(Links::hook(head), hook_less));  \
+  }
+
+LIST_SORT_HOOKED(bui1_merge_sort)
+LIST_SORT_HOOKED(bui2_merge_sort)
+LIST_SORT_HOOKED(tdr1_merge_sort)
+LIST_SORT_HOOKED(tdr2_merge_sort)
+LIST_SORT_HOOKED(tdr3_merge_sort)
+LIST_SORT_HOOKED(tdi1_merge_sort)
+LIST_SORT_HOOKED(tdi2_merge_sort)
+LIST_SORT_HOOKED(tdq1_quick_sort)
+
+#undef LIST_SORT_HOOKED
+
+}  // namespace list_sort
+
+#endif  // LIST_SORT_HPP_
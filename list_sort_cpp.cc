@@ -0,0 +1,110 @@
+// C-callable instantiations of the header-only C++ sorts in list_sort.hpp,
+// for Int64ListNode and CachelineListNode.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#include "list_sort_cpp.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#include "list_sort.hpp"
+
+extern "C" {
+#include "list_types.h"
+}
+
+namespace {
+
+// Compares two Int64ListNodes, like compare_int64_list_node, but inlinable.
+struct Int64Less {
+  bool operator()(const Int64ListNode *const a,
+                  const Int64ListNode *const b) const {
+    return a->value < b->value;
+  }
+};
+
+// Compares two CachelineListNodes, like compare_cacheline_list_node, but
+// inlinable.
+struct CachelineLess {
+  bool operator()(const CachelineListNode *const a,
+                  const CachelineListNode *const b) const {
+    for (std::size_t i = 0; i < kCachelineListNodeDataLen; ++i) {
+      if (a->data[i] < b->data[i]) {
+        return true;
+      }
+      if (a->data[i] > b->data[i]) {
+        return false;
+      }
+    }
+    return false;
+  }
+};
+
+// A node whose 'next' member comes after its value.  The benchmark doesn't
+// use it; the explicit instantiations below just keep the sorts honest about
+// not assuming 'next' is at offset 0.
+struct TrailingNextNode {
+  std::int64_t value;
+  TrailingNextNode *next;
+};
+
+struct TrailingNextLess {
+  bool operator()(const TrailingNextNode *const a,
+                  const TrailingNextNode *const b) const {
+    return a->value < b->value;
+  }
+};
+
+}  // namespace
+
+// Defines a C-callable wrapper around one instantiation.  Each list type
+// starts with its ListNode, so a ListNode pointer is also a pointer to its
+// node.
+#define CPP_SORT_WRAPPER(type, node_type, less, algo)                     \
+  ListNode *cpp_##type##_##algo(ListNode *const head,                     \
+                                ListNodeCompareFxn *const cmp) {          \
+    (void)cmp;                                                            \
+    node_type *const sorted =                                             \
+        list_sort::algo<node_type, ListNode, &node_type::node,            \
+                        &ListNode::next>(                                 \
+            reinterpret_cast<node_type *>(head), less());                 \
+    return sorted ? &sorted->node : nullptr;                              \
+  }
+
+CPP_SORT_WRAPPER(int64, Int64ListNode, Int64Less, bui1_merge_sort)
+CPP_SORT_WRAPPER(int64, Int64ListNode, Int64Less, bui2_merge_sort)
+CPP_SORT_WRAPPER(int64, Int64ListNode, Int64Less, tdr1_merge_sort)
+CPP_SORT_WRAPPER(int64, Int64ListNode, Int64Less, tdr2_merge_sort)
+CPP_SORT_WRAPPER(int64, Int64ListNode, Int64Less, tdr3_merge_sort)
+CPP_SORT_WRAPPER(int64, Int64ListNode, Int64Less, tdq1_quick_sort)
+CPP_SORT_WRAPPER(int64, Int64ListNode, Int64Less, tdi1_merge_sort)
+CPP_SORT_WRAPPER(int64, Int64ListNode, Int64Less, tdi2_merge_sort)
+
+CPP_SORT_WRAPPER(cacheline, CachelineListNode, CachelineLess, bui1_merge_sort)
+CPP_SORT_WRAPPER(cacheline, CachelineListNode, CachelineLess, bui2_merge_sort)
+CPP_SORT_WRAPPER(cacheline, CachelineListNode, CachelineLess, tdr1_merge_sort)
+CPP_SORT_WRAPPER(cacheline, CachelineListNode, CachelineLess, tdr2_merge_sort)
+CPP_SORT_WRAPPER(cacheline, CachelineListNode, CachelineLess, tdr3_merge_sort)
+CPP_SORT_WRAPPER(cacheline, CachelineListNode, CachelineLess, tdq1_quick_sort)
+CPP_SORT_WRAPPER(cacheline, CachelineListNode, CachelineLess, tdi1_merge_sort)
+CPP_SORT_WRAPPER(cacheline, CachelineListNode, CachelineLess, tdi2_merge_sort)
+
+#undef CPP_SORT_WRAPPER
+
+// Instantiates each sort for TrailingNextNode.
+#define CPP_SORT_INSTANTIATE(algo)                                        \
+  template TrailingNextNode *list_sort::algo<                            \
+      TrailingNextNode, &TrailingNextNode::next, TrailingNextLess>(      \
+      TrailingNextNode *, TrailingNextLess);
+
+CPP_SORT_INSTANTIATE(bui1_merge_sort)
+CPP_SORT_INSTANTIATE(bui2_merge_sort)
+CPP_SORT_INSTANTIATE(tdr1_merge_sort)
+CPP_SORT_INSTANTIATE(tdr2_merge_sort)
+CPP_SORT_INSTANTIATE(tdr3_merge_sort)
+CPP_SORT_INSTANTIATE(tdq1_quick_sort)
+CPP_SORT_INSTANTIATE(tdi1_merge_sort)
+CPP_SORT_INSTANTIATE(tdi2_merge_sort)
+
+#undef CPP_SORT_INSTANTIATE
@@ -0,0 +1,49 @@
+// C-callable instantiations of the header-only C++ sorts in list_sort.hpp,
+// for Int64ListNode and CachelineListNode.  Each has the same signature as the
+// C sorts, but ignores 'cmp' in favor of an inlined comparison.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#ifndef LIST_SORT_CPP_H_
+#define LIST_SORT_CPP_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "list_node.h"
+#include "list_sort.h"
+
+// Sorts Int64ListNodes.
+ListNode *cpp_int64_bui1_merge_sort(ListNode *head, ListNodeCompareFxn *cmp);
+ListNode *cpp_int64_bui2_merge_sort(ListNode *head, ListNodeCompareFxn *cmp);
+ListNode *cpp_int64_tdr1_merge_sort(ListNode *head, ListNodeCompareFxn *cmp);
+ListNode *cpp_int64_tdr2_merge_sort(ListNode *head, ListNodeCompareFxn *cmp);
+ListNode *cpp_int64_tdr3_merge_sort(ListNode *head, ListNodeCompareFxn *cmp);
+ListNode *cpp_int64_tdq1_quick_sort(ListNode *head, ListNodeCompareFxn *cmp);
+ListNode *cpp_int64_tdi1_merge_sort(ListNode *head, ListNodeCompareFxn *cmp);
+ListNode *cpp_int64_tdi2_merge_sort(ListNode *head, ListNodeCompareFxn *cmp);
+
+// Sorts CachelineListNodes.
+ListNode *cpp_cacheline_bui1_merge_sort(ListNode *head,
+                                        ListNodeCompareFxn *cmp);
+ListNode *cpp_cacheline_bui2_merge_sort(ListNode *head,
+                                        ListNodeCompareFxn *cmp);
+ListNode *cpp_cacheline_tdr1_merge_sort(ListNode *head,
+                                        ListNodeCompareFxn *cmp);
+ListNode *cpp_cacheline_tdr2_merge_sort(ListNode *head,
+                                        ListNodeCompareFxn *cmp);
+ListNode *cpp_cacheline_tdr3_merge_sort(ListNode *head,
+                                        ListNodeCompareFxn *cmp);
+ListNode *cpp_cacheline_tdq1_quick_sort(ListNode *head,
+                                        ListNodeCompareFxn *cmp);
+ListNode *cpp_cacheline_tdi1_merge_sort(ListNode *head,
+                                        ListNodeCompareFxn *cmp);
+ListNode *cpp_cacheline_tdi2_merge_sort(ListNode *head,
+                                        ListNodeCompareFxn *cmp);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // LIST_SORT_CPP_H_
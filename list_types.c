@@ -4,10 +4,14 @@
 // SPDX-License-Identifier:  CC-BY-SA-4.0
 #include <stddef.h>
 
+#include "cbi2_merge_sort.h"
+#include "cti2_merge_sort.h"
 #include "list_node.h"
 #include "list_sort.h"
+#include "list_sort_cpp.h"
 #include "list_types.h"
-#include "mt64.h"
+#include "lsd1_radix_sort.h"
+#include "msd1_radix_sort.h"
 
 // Compares two Int64ListNodes, returning true if the first is less than the
 // second.
@@ -36,6 +40,39 @@ bool compare_cacheline_list_node(
   return false;
 }
 
+// Returns a sort key for an Int64ListNode.  Flips the sign bit, so that
+// unsigned key comparisons order values the same way signed comparisons do.
+uint64_t key_int64_list_node(const ListNode *const node) {
+  const Int64ListNode *const int64_node = (const Int64ListNode *)node;
+
+  return (uint64_t)int64_node->value ^ (UINT64_C(1) << 63);
+}
+
+// Returns a sort key for a CachelineListNode.  The upper half comes from the
+// first data element.  The lower half orders the rest of the array:  arrays
+// whose middle elements are all zero, as the benchmark's are, go by their last
+// element, between the arrays whose first nonzero middle element is negative
+// and those where it's positive.  Nodes whose keys match still need a full
+// comparison.
+uint64_t key_cacheline_list_node(const ListNode *const node) {
+  const int last = kCachelineListNodeDataLen - 1;
+  const CachelineListNode *const cacheline_node =
+      (const CachelineListNode *)node;
+  const uint32_t hi = (uint32_t)cacheline_node->data[0] ^ (UINT32_C(1) << 31);
+  uint32_t lo = (uint32_t)cacheline_node->data[last] ^ (UINT32_C(1) << 31);
+
+  // Keep 0 and UINT32_MAX for the arrays with nonzero middles.
+  lo = lo < 1 ? 1 : lo > UINT32_MAX - 1 ? UINT32_MAX - 1 : lo;
+  for (int i = 1; i < last; ++i) {
+    if (cacheline_node->data[i]) {
+      lo = cacheline_node->data[i] < 0 ? 0 : UINT32_MAX;
+      break;
+    }
+  }
+
+  return ((uint64_t)hi << 32) | lo;
+}
+
 // Benchmarking interface functions.
 
 // Returns an Int64ListNode at the specified index.
@@ -44,9 +81,10 @@ static ListNode *get_int64_list_node(void *const buf, const size_t index) {
 }
 
 // Randomizes an Int64ListNode, given a ListNode* to the node.
-static void randomize_int64_list_node(ListNode *const node) {
+static void randomize_int64_list_node(ListNode *const node,
+                                      const uint64_t random) {
   Int64ListNode *const int64_node = (Int64ListNode *)node;
-  int64_node->value = genrand64_int64();
+  int64_node->value = random;
 }
 
 // Returns an index-sensitive checksum for an Int64ListNode.
@@ -64,6 +102,58 @@ static bool validate_int64_list_node(const ListNode *const node) {
   return true;
 }
 
+// Sorts Int64ListNodes with lsd1_radix_sort.
+static ListNode *lsd1_radix_sort_int64(ListNode *const head,
+                                       ListNodeCompareFxn *const cmp) {
+  return lsd1_radix_sort(head, offsetof(Int64ListNode, value), cmp);
+}
+
+// Sorts Int64ListNodes with msd1_radix_sort.
+static ListNode *msd1_radix_sort_int64(ListNode *const head,
+                                       ListNodeCompareFxn *const cmp) {
+  return msd1_radix_sort(head, offsetof(Int64ListNode, value), cmp);
+}
+
+// Sorts Int64ListNodes with cbi2_merge_sort, comparing values inline.  Never
+// calls 'cmp'.
+static ListNode *cbi2_merge_sort_int64_node(ListNode *const head,
+                                            ListNodeCompareFxn *const cmp) {
+  (void)cmp;
+  return cbi2_merge_sort_int64(head, offsetof(Int64ListNode, value));
+}
+
+// Sorts Int64ListNodes with cti2_merge_sort, comparing values inline.  Never
+// calls 'cmp'.
+static ListNode *cti2_merge_sort_int64_node(ListNode *const head,
+                                            ListNodeCompareFxn *const cmp) {
+  (void)cmp;
+  return cti2_merge_sort_int64(head, offsetof(Int64ListNode, value));
+}
+
+// Sorts that only know how to sort Int64ListNodes.
+static const SortRegistryEntry int64_sort_registry_entry[] = {
+  { "LSD Radix Sort 1", lsd1_radix_sort_int64, false },
+  { "MSD Radix Sort 1", msd1_radix_sort_int64, false },
+  { "C++ Bottom-Up Iter. MergeSort 1", cpp_int64_bui1_merge_sort, false },
+  { "C++ Bottom-Up Iter. MergeSort 2", cpp_int64_bui2_merge_sort, false },
+  { "C++ Top-Down Rec. MergeSort 1",  cpp_int64_tdr1_merge_sort, false },
+  { "C++ Top-Down Rec. MergeSort 2",  cpp_int64_tdr2_merge_sort, false },
+  { "C++ Top-Down Rec. MergeSort 3",  cpp_int64_tdr3_merge_sort, false },
+  { "C++ Top-Down Rec. QuickSort 1",  cpp_int64_tdq1_quick_sort, true },
+  { "C++ Top-Down Iter. MergeSort 1", cpp_int64_tdi1_merge_sort, false },
+  { "C++ Top-Down Iter. MergeSort 2", cpp_int64_tdi2_merge_sort, false },
+  { "Branchless Int64 Bottom-Up Iter. MergeSort 2",
+    cbi2_merge_sort_int64_node, false },
+  { "Branchless Int64 Top-Down Iter. MergeSort 2",
+    cti2_merge_sort_int64_node, false },
+};
+
+static const SortRegistry int64_sort_registry = {
+  .length = sizeof(int64_sort_registry_entry) /
+            sizeof(int64_sort_registry_entry[0]),
+  .entry = int64_sort_registry_entry
+};
+
 // List node operations for an Int64List.
 const ListNodeBenchOps list_node_bench_ops_int64 = {
   .size = sizeof(Int64ListNode),
@@ -71,7 +161,9 @@ const ListNodeBenchOps list_node_bench_ops_int64 = {
   .randomize = randomize_int64_list_node,
   .compare = compare_int64_list_node,
   .checksum = checksum_int64_list_node,
-  .validate = validate_int64_list_node
+  .validate = validate_int64_list_node,
+  .key = key_int64_list_node,
+  .typed_sorts = &int64_sort_registry
 };
 
 
@@ -81,14 +173,15 @@ static ListNode *get_cacheline_list_node(void *const buf, const size_t index) {
 }
 
 // Randomizes a CachelineListNode, given a ListNode* to the node.
-static void randomize_cacheline_list_node(ListNode *const node) {
+static void randomize_cacheline_list_node(ListNode *const node,
+                                          const uint64_t random) {
   const int last = kCachelineListNodeDataLen - 1;
   CachelineListNode *const cacheline_node = (CachelineListNode *)node;
 
   for (size_t i = 0; i < last; ++i) {
     cacheline_node->data[i] = 0;
   }
-  cacheline_node->data[last] = genrand64_int64() % INT32_MAX;
+  cacheline_node->data[last] = random % INT32_MAX;
 }
 
 // Returns an index-sensitive checksum for a CachelineListNode.
@@ -113,6 +206,24 @@ static bool validate_cacheline_list_node(const ListNode *const node) {
   return true;
 }
 
+// Sorts that only know how to sort CachelineListNodes.
+static const SortRegistryEntry cacheline_sort_registry_entry[] = {
+  { "C++ Bottom-Up Iter. MergeSort 1", cpp_cacheline_bui1_merge_sort, false },
+  { "C++ Bottom-Up Iter. MergeSort 2", cpp_cacheline_bui2_merge_sort, false },
+  { "C++ Top-Down Rec. MergeSort 1",  cpp_cacheline_tdr1_merge_sort, false },
+  { "C++ Top-Down Rec. MergeSort 2",  cpp_cacheline_tdr2_merge_sort, false },
+  { "C++ Top-Down Rec. MergeSort 3",  cpp_cacheline_tdr3_merge_sort, false },
+  { "C++ Top-Down Rec. QuickSort 1",  cpp_cacheline_tdq1_quick_sort, true },
+  { "C++ Top-Down Iter. MergeSort 1", cpp_cacheline_tdi1_merge_sort, false },
+  { "C++ Top-Down Iter. MergeSort 2", cpp_cacheline_tdi2_merge_sort, false },
+};
+
+static const SortRegistry cacheline_sort_registry = {
+  .length = sizeof(cacheline_sort_registry_entry) /
+            sizeof(cacheline_sort_registry_entry[0]),
+  .entry = cacheline_sort_registry_entry
+};
+
 // List node operations for an Int64List.
 const ListNodeBenchOps list_node_bench_ops_cacheline = {
   .size = sizeof(CachelineListNode),
@@ -120,5 +231,7 @@ const ListNodeBenchOps list_node_bench_ops_cacheline = {
   .randomize = randomize_cacheline_list_node,
   .compare = compare_cacheline_list_node,
   .checksum = checksum_cacheline_list_node,
-  .validate = validate_cacheline_list_node
+  .validate = validate_cacheline_list_node,
+  .key = key_cacheline_list_node,
+  .typed_sorts = &cacheline_sort_registry
 };
@@ -32,6 +32,13 @@ typedef struct cacheline_list_node {
 extern bool compare_int64_list_node(const ListNode*, const ListNode*);
 extern bool compare_cacheline_list_node(const ListNode*, const ListNode*);
 
+// Sort key extraction functions for Int64Node and CachelineNode.  The
+// Int64Node key captures the entire value.  The CachelineNode key captures
+// the first and last elements of the data array, when the ones in between are
+// zero, so equal keys need a full comparison.
+extern uint64_t key_int64_list_node(const ListNode*);
+extern uint64_t key_cacheline_list_node(const ListNode*);
+
 // Benchmarking interfaces.
 extern const ListNodeBenchOps list_node_bench_ops_int64;
 extern const ListNodeBenchOps list_node_bench_ops_cacheline;
@@ -0,0 +1,85 @@
+// Least-significant-digit first radix sort for integer-keyed list nodes.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#include "lsd1_radix_sort.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "list_instrument.h"
+
+#define RADIX_BITS (8)
+#define RADIX (1 << RADIX_BITS)
+#define RADIX_MASK (RADIX - 1)
+
+// Reads the signed key at key_offset, and flips its sign bit so that unsigned
+// comparisons order keys the same way signed comparisons would.
+static inline uint64_t read_key(const ListNode *const node,
+                                const size_t key_offset) {
+  int64_t key;
+  memcpy(&key, (const char *)node + key_offset, sizeof(key));
+  return (uint64_t)key ^ (UINT64_C(1) << 63);
+}
+
+// Sorts a singly linked list of nodes that each hold a signed int64_t key
+// 'key_offset' bytes from the start of the node.  Makes one stable pass per
+// 8-bit digit, distributing nodes into 256 bucket lists by relinking their
+// 'next' pointers.  Skips digits that are the same across every key.
+ListNode *lsd1_radix_sort(ListNode *const head, const size_t key_offset,
+                          ListNodeCompareFxn *const cmp) {
+  (void)cmp;
+
+  // Degenerate list: return as-is.
+  if (!head || !LIST_VISIT_NEXT(head)) {
+    return head;
+  }
+
+  // Scan once to find which bits differ between keys.
+  uint64_t key_and = ~UINT64_C(0), key_or = 0;
+  for (ListNode *node = head; node; node = node->next) {
+    const uint64_t key = read_key(node, key_offset);
+    key_and &= key;
+    key_or |= key;
+    LIST_COUNT_VISIT();
+  }
+  const uint64_t key_diff = key_and ^ key_or;
+
+  ListNode *list = head;
+  ListNode *bucket_head[RADIX];
+  ListNode **bucket_tail[RADIX];
+
+  for (int shift = 0; shift < 64; shift += RADIX_BITS) {
+    // Every key has the same digit here, so this pass wouldn't move anything.
+    if (!((key_diff >> shift) & RADIX_MASK)) {
+      continue;
+    }
+
+    for (int i = 0; i < RADIX; ++i) {
+      bucket_tail[i] = &bucket_head[i];
+    }
+
+    // Distribute, appending to each bucket's tail to keep things stable.
+    for (ListNode *node = list; node; node = node->next) {
+      const int digit = (read_key(node, key_offset) >> shift) & RADIX_MASK;
+      *bucket_tail[digit] = node;
+      bucket_tail[digit] = &node->next;
+      LIST_COUNT_LINK();
+      LIST_COUNT_VISIT();
+    }
+
+    // Collect the buckets back into one list.
+    ListNode **pnext = &list;
+    for (int i = 0; i < RADIX; ++i) {
+      if (bucket_tail[i] != &bucket_head[i]) {
+        *pnext = bucket_head[i];
+        pnext = bucket_tail[i];
+        LIST_COUNT_LINK();
+      }
+    }
+    *pnext = NULL;
+    LIST_COUNT_LINK();
+  }
+
+  return list;
+}
@@ -0,0 +1,21 @@
+// Least-significant-digit first radix sort for integer-keyed list nodes.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#ifndef LSD1_RADIX_SORT_H_
+#define LSD1_RADIX_SORT_H_
+
+#include <stddef.h>
+
+#include "list_node.h"
+#include "list_sort.h"
+
+// Sorts a singly linked list of nodes that each hold a signed int64_t key
+// 'key_offset' bytes from the start of the node.  Makes one stable pass per
+// 8-bit digit, distributing nodes into 256 bucket lists by relinking their
+// 'next' pointers.  Skips digits that are the same across every key.  Never
+// calls 'cmp'; it's accepted so this matches the other sorts.
+ListNode *lsd1_radix_sort(ListNode *head, size_t key_offset,
+                          ListNodeCompareFxn *cmp);
+
+#endif  // LSD1_RADIX_SORT_H_
@@ -0,0 +1,120 @@
+// Top-down Iterative Merge Sort with O(1) auxillary storage, sorting short
+// leaves with a sorting network or insertion sort before the merge passes.
+//
+// Author:  agent <agent@local>
+// Based on tdi2_merge_sort.c by Drew Eckhardt and Joe Zbiciak.
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#include "lti2_merge_sort.h"
+
+#include <stddef.h>
+
+#include "list_instrument.h"
+
+static ListLeaf lti2_leaf = {
+  .kind = LIST_LEAF_DEFAULT_KIND,
+  .size = LIST_LEAF_DEFAULT_SIZE
+};
+
+// Sets the leaf sort lti2_merge_sort uses.
+void lti2_merge_sort_set_leaf(const ListLeaf leaf) {
+  lti2_leaf = list_leaf_clamp(leaf);
+}
+
+// Implements tdi2_merge_sort with leaves of leaf.size nodes.  The leaf pass
+// also counts the nodes, so it replaces tdi2_merge_sort's scan for the size.
+ListNode *lti2_merge_sort_leaf(ListNode *const src,
+                               ListNodeCompareFxn *const cmp,
+                               ListLeaf leaf) {
+  ListNode *rest, *out_head, **out_tail;
+  size_t size = 0;
+
+  leaf = list_leaf_clamp(leaf);
+
+  // Cut the list into leaves, sort each one, and string them back together.
+  out_head = NULL;
+  out_tail = &out_head;
+  rest = src;
+  while (rest) {
+    ListNode *nodes[LIST_LEAF_MAX_SIZE];
+    const int count = list_leaf_gather(nodes, &rest, leaf.size);
+    list_leaf_sort(nodes, count, cmp, leaf.kind);
+    out_tail = list_leaf_link(nodes, count, out_tail);
+    size += count;
+  }
+  *out_tail = NULL;
+  LIST_COUNT_LINK();
+
+  size_t increment = leaf.size;
+  rest = out_head;
+  while (increment < size) {
+    out_head = NULL;
+    out_tail = &out_head;
+
+    while (rest) {
+      size_t ar = increment, br = increment;
+      ListNode *a = rest;
+      ListNode *b = a;
+
+      // Find the start of 'b'.
+      for (size_t i = 0; i < increment && b; ++i) {
+        b = b->next;
+        LIST_COUNT_VISIT();
+      }
+
+      // If 'a' was shorter than increment, just append it and break out.
+      if (!b) {
+        rest = NULL;
+        *out_tail = a;
+        LIST_COUNT_LINK();
+        break;
+      }
+
+      // Merge 'b' into 'a'.  Ties go to 'a', so equal nodes keep their order.
+      while (ar && br && b) {
+        ListNode **l = cmp(b, a) ? (--br, &b) : (--ar, &a);
+        *out_tail = *l;
+        out_tail = &(*out_tail)->next;
+        *l = (*l)->next;
+        LIST_COUNT_LINK();
+        LIST_COUNT_VISIT();
+      }
+
+      // Push any remaining 'a' nodes.
+      while (ar) {
+        *out_tail = a;
+        out_tail = &a->next;
+        a = a->next;
+        --ar;
+        LIST_COUNT_LINK();
+        LIST_COUNT_VISIT();
+      }
+
+      // Push any remaining 'b' nodes. 'b' can end early.
+      while (br && b) {
+        *out_tail = b;
+        out_tail = &b->next;
+        b = b->next;
+        --br;
+        LIST_COUNT_LINK();
+        LIST_COUNT_VISIT();
+      }
+
+      // Terminate our partial list.
+      *out_tail = NULL;
+      LIST_COUNT_LINK();
+
+      // The final advance on 'b' will make it point to 'rest'.
+      rest = b;
+    }
+
+    increment *= 2;
+    rest = out_head;
+  }
+
+  return rest;
+}
+
+// Same as above, using the leaf sort set by lti2_merge_sort_set_leaf.
+ListNode *lti2_merge_sort(ListNode *const src, ListNodeCompareFxn *const cmp) {
+  return lti2_merge_sort_leaf(src, cmp, lti2_leaf);
+}
@@ -0,0 +1,27 @@
+// Top-down Iterative Merge Sort with O(1) auxillary storage, sorting short
+// leaves with a sorting network or insertion sort before the merge passes.
+//
+// Author:  agent <agent@local>
+// Based on tdi2_merge_sort.c by Drew Eckhardt and Joe Zbiciak.
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#ifndef LTI2_MERGE_SORT_H_
+#define LTI2_MERGE_SORT_H_
+
+#include "list_leaf.h"
+#include "list_node.h"
+#include "list_sort.h"
+
+// Sets the leaf sort lti2_merge_sort uses.  The default is a sorting network
+// on LIST_LEAF_DEFAULT_SIZE nodes.
+void lti2_merge_sort_set_leaf(ListLeaf leaf);
+
+// Implements tdi2_merge_sort, with a first pass that cuts the list into
+// leaves of leaf.size nodes and sorts each with the leaf sort.  The merge
+// passes then start from sub-lists of leaf.size nodes instead of 1.
+ListNode *lti2_merge_sort_leaf(ListNode *src, ListNodeCompareFxn *cmp,
+                               ListLeaf leaf);
+
+// Same as above, using the leaf sort set by lti2_merge_sort_set_leaf.
+ListNode *lti2_merge_sort(ListNode *src, ListNodeCompareFxn *cmp);
+
+#endif  // LTI2_MERGE_SORT_H_
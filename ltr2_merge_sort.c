@@ -0,0 +1,95 @@
+// Top-down Recursive Merge Sort, measuring list length up front, and sorting
+// short leaves with a sorting network or insertion sort.
+//
+// Author:  agent <agent@local>
+// Based on tdr2_merge_sort.c by Joe Zbiciak.
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#include "ltr2_merge_sort.h"
+
+#include <stddef.h>
+
+#include "list_instrument.h"
+
+static ListLeaf ltr2_leaf = {
+  .kind = LIST_LEAF_DEFAULT_KIND,
+  .size = LIST_LEAF_DEFAULT_SIZE
+};
+
+// Sets the leaf sort ltr2_merge_sort uses.
+void ltr2_merge_sort_set_leaf(const ListLeaf leaf) {
+  ltr2_leaf = list_leaf_clamp(leaf);
+}
+
+// Implements the recursive portion of the top-down recursive sort.  Sub-lists
+// of up to leaf.size nodes go to the leaf sort.
+static ListNode *ltr2_merge_sort_internal(
+    ListNode *head,
+    ListNodeCompareFxn *const cmp,
+    const size_t length,
+    const ListLeaf leaf
+) {
+  // Leaf:  sort and return.
+  if (length <= (size_t)leaf.size) {
+    int count;
+    return list_leaf_take(&head, leaf, cmp, &count);
+  }
+
+  // Find midpoint and cut into two lists.
+  const size_t len_a = length / 2, len_b = length - len_a;
+  ListNode *pmid = head;
+
+  for (size_t i = 1; i < len_a; ++i) {
+    pmid = pmid->next;
+    LIST_COUNT_VISIT();
+  }
+
+  ListNode *const mid = pmid->next;
+  pmid->next = NULL;
+  LIST_COUNT_VISIT();
+  LIST_COUNT_LINK();
+
+  // Recursively sort the halves.
+  ListNode *a = ltr2_merge_sort_internal(head, cmp, len_a, leaf);
+  ListNode *b = ltr2_merge_sort_internal(mid, cmp, len_b, leaf);
+  ListNode *merged = NULL, **pnext = &merged;
+
+  // Take the smallest from a or b, as long as both lists are non-empty.
+  // Ties go to 'a', so equal nodes keep their order.
+  while (a && b) {
+    ListNode **const l = cmp(b, a) ? &b : &a;
+    *pnext = *l;
+    pnext = &(*pnext)->next;
+    *l = (*l)->next;
+    LIST_COUNT_LINK();
+    LIST_COUNT_VISIT();
+  }
+
+  // Once we exhaust one list, append the other as-is to the merged list.
+  *pnext = a ? a : b;
+  LIST_COUNT_LINK();
+
+  // Return the final merged result.
+  return merged;
+}
+
+// Implements tdr2_merge_sort with leaves of up to leaf.size nodes.
+ListNode *ltr2_merge_sort_leaf(ListNode *const head,
+                               ListNodeCompareFxn *const cmp,
+                               const ListLeaf leaf) {
+  size_t length = 0;
+  ListNode *node = head;
+
+  // Measure length of the list once up-front.
+  while (node) {
+    length++;
+    node = node->next;
+    LIST_COUNT_VISIT();
+  }
+
+  return ltr2_merge_sort_internal(head, cmp, length, list_leaf_clamp(leaf));
+}
+
+// Same as above, using the leaf sort set by ltr2_merge_sort_set_leaf.
+ListNode *ltr2_merge_sort(ListNode *const head, ListNodeCompareFxn *const cmp) {
+  return ltr2_merge_sort_leaf(head, cmp, ltr2_leaf);
+}
@@ -0,0 +1,26 @@
+// Top-down Recursive Merge Sort, measuring list length up front, and sorting
+// short leaves with a sorting network or insertion sort.
+//
+// Author:  agent <agent@local>
+// Based on tdr2_merge_sort.c by Joe Zbiciak.
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#ifndef LTR2_MERGE_SORT_H_
+#define LTR2_MERGE_SORT_H_
+
+#include "list_leaf.h"
+#include "list_node.h"
+#include "list_sort.h"
+
+// Sets the leaf sort ltr2_merge_sort uses.  The default is a sorting network
+// on LIST_LEAF_DEFAULT_SIZE nodes.
+void ltr2_merge_sort_set_leaf(ListLeaf leaf);
+
+// Implements tdr2_merge_sort, stopping the recursion at sub-lists of up to
+// leaf.size nodes and sorting those with the leaf sort.
+ListNode *ltr2_merge_sort_leaf(ListNode *head, ListNodeCompareFxn *cmp,
+                               ListLeaf leaf);
+
+// Same as above, using the leaf sort set by ltr2_merge_sort_set_leaf.
+ListNode *ltr2_merge_sort(ListNode *head, ListNodeCompareFxn *cmp);
+
+#endif  // LTR2_MERGE_SORT_H_
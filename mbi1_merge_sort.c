@@ -0,0 +1,266 @@
+// Sorts many short lists in one call, interleaving their merges so that their
+// cache misses overlap.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#include "mbi1_merge_sort.h"
+
+#include <stdbool.h>
+
+#include "list_instrument.h"
+#include "list_leaf.h"
+
+// The number of nodes in a leaf.  The merge passes start from sorted runs of
+// this length.
+#define LEAF_SIZE (3)
+
+static int mbi1_width = 16;
+
+// Sets the number of lists mbi1_merge_sort_many works on at once.
+void mbi1_merge_sort_set_width(const int width) {
+  mbi1_width = width < 1 ? 1
+             : width > MBI1_MAX_WIDTH ? MBI1_MAX_WIDTH : width;
+}
+
+// The states of one list's sort.  After SORT_LEAF, these follow the loops in
+// tdi2_merge_sort, as in ami1_merge_sort.  Only the states that touch a node
+// end a step; the others fall through to the next state right away.
+typedef enum {
+  SORT_LEAF,     // Add the next node to the current leaf.
+  SORT_PASS,     // Start the next pass over the list, if it needs one.
+  SORT_PAIR,     // Start the next pair of sub-lists in this pass.
+  SORT_FIND_B,   // Walk across 'a' to find the start of 'b'.
+  SORT_MERGE,    // Merge 'b' into 'a'.
+  SORT_DRAIN_A,  // Push the remaining 'a' nodes.
+  SORT_DRAIN_B,  // Push the remaining 'b' nodes.
+  SORT_DONE      // The sorted list is in 'rest'.
+} SortState;
+
+// The state of one list's sort.  'index' is its position in 'heads'.  The
+// fields from 'increment' on are tdi2_merge_sort's local variables.
+typedef struct {
+  SortState state;
+  size_t index, size;
+  ListNode *leaf[LEAF_SIZE];
+  int leaf_len;
+  size_t increment;
+  ListNode *rest, *out_head, **out_tail;
+  ListNode *a, *b;
+  size_t ar, br, i;
+} SortLane;
+
+// Sorts the lane's current leaf, and appends it to the lane's output.  The
+// leaves use binary insertion sort, since the networks aren't stable.
+static inline void flush_leaf(SortLane *const l,
+                              ListNodeCompareFxn *const cmp) {
+  list_leaf_sort(l->leaf, l->leaf_len, cmp, LIST_LEAF_INSERTION);
+  l->out_tail = list_leaf_link(l->leaf, l->leaf_len, l->out_tail);
+  l->size += l->leaf_len;
+  l->leaf_len = 0;
+}
+
+// Takes the node at the head of 'src', appends it to the output, and
+// prefetches the node after it.
+static inline void take_node(ListNode **const src, ListNode ***const out_tail) {
+  ListNode *const node = *src;
+  **out_tail = node;
+  *out_tail = &node->next;
+  *src = node->next;
+  __builtin_prefetch(*src);
+  LIST_COUNT_LINK();
+  LIST_COUNT_VISIT();
+}
+
+// Advances a list's sort by one node.  Returns false once the list is sorted.
+static inline bool sort_step(SortLane *const l,
+                             ListNodeCompareFxn *const cmp) {
+  for (;;) {
+    switch (l->state) {
+      case SORT_LEAF:
+        if (l->rest) {
+          ListNode *const node = l->rest;
+          l->leaf[l->leaf_len++] = node;
+          l->rest = node->next;
+          __builtin_prefetch(l->rest);
+          LIST_COUNT_VISIT();
+          if (l->leaf_len == LEAF_SIZE) {
+            flush_leaf(l, cmp);
+          }
+          return true;
+        }
+        // That was the last node.  The merge passes start from the leaves.
+        if (l->leaf_len) {
+          flush_leaf(l, cmp);
+        }
+        *l->out_tail = NULL;
+        LIST_COUNT_LINK();
+        l->rest = l->out_head;
+        l->increment = LEAF_SIZE;
+        l->state = SORT_PASS;
+        break;
+
+      case SORT_PASS:
+        if (l->increment >= l->size) {
+          l->state = SORT_DONE;
+          return false;
+        }
+        l->out_head = NULL;
+        l->out_tail = &l->out_head;
+        l->state = SORT_PAIR;
+        break;
+
+      case SORT_PAIR:
+        // End of the pass?  Start the next one.
+        if (!l->rest) {
+          l->increment *= 2;
+          l->rest = l->out_head;
+          l->state = SORT_PASS;
+          break;
+        }
+        l->a = l->b = l->rest;
+        l->ar = l->br = l->increment;
+        l->i = 0;
+        l->state = SORT_FIND_B;
+        break;
+
+      case SORT_FIND_B:
+        if (l->i < l->increment && l->b) {
+          l->b = l->b->next;
+          l->i++;
+          __builtin_prefetch(l->b);
+          LIST_COUNT_VISIT();
+          return true;
+        }
+        // If 'a' was shorter than increment, just append it.  That ends the
+        // pass.
+        if (!l->b) {
+          *l->out_tail = l->a;
+          l->rest = NULL;
+          LIST_COUNT_LINK();
+          l->state = SORT_PAIR;
+          break;
+        }
+        l->state = SORT_MERGE;
+        break;
+
+      case SORT_MERGE:
+        if (l->ar && l->br && l->b) {
+          if (cmp(l->b, l->a)) {
+            --l->br;
+            take_node(&l->b, &l->out_tail);
+          } else {
+            --l->ar;
+            take_node(&l->a, &l->out_tail);
+          }
+          return true;
+        }
+        l->state = SORT_DRAIN_A;
+        break;
+
+      case SORT_DRAIN_A:
+        if (l->ar) {
+          --l->ar;
+          take_node(&l->a, &l->out_tail);
+          return true;
+        }
+        l->state = SORT_DRAIN_B;
+        break;
+
+      case SORT_DRAIN_B:
+        // 'b' can end early.
+        if (l->br && l->b) {
+          --l->br;
+          take_node(&l->b, &l->out_tail);
+          return true;
+        }
+        // Terminate our partial list.  The final advance on 'b' left it
+        // pointing to the rest of the pass.
+        *l->out_tail = NULL;
+        l->rest = l->b;
+        LIST_COUNT_LINK();
+        l->state = SORT_PAIR;
+        break;
+
+      case SORT_DONE:
+        return false;
+    }
+  }
+}
+
+// Starts a lane on the next list in 'heads' that needs one, sorting any lists
+// of up to LEAF_SIZE nodes along the way with just the leaf sort.  Returns
+// false if there are no lists left.
+static bool start_lane(SortLane *const l, ListNode **const heads,
+                       const size_t count, size_t *const next,
+                       ListNodeCompareFxn *const cmp) {
+  while (*next < count) {
+    const size_t index = (*next)++;
+    ListNode *rest = heads[index];
+
+    // Gather the first LEAF_SIZE nodes.  If that's the whole list, sort it
+    // right here.  Otherwise, they're the lane's first leaf.
+    const int len = list_leaf_gather(l->leaf, &rest, LEAF_SIZE);
+    if (!rest) {
+      if (len > 1) {
+        list_leaf_sort(l->leaf, len, cmp, LIST_LEAF_INSERTION);
+        *list_leaf_link(l->leaf, len, &heads[index]) = NULL;
+        LIST_COUNT_LINK();
+      }
+      continue;
+    }
+
+    l->state = SORT_LEAF;
+    l->index = index;
+    l->size = 0;
+    l->leaf_len = len;
+    l->out_head = NULL;
+    l->out_tail = &l->out_head;
+    flush_leaf(l, cmp);
+    l->rest = rest;
+    __builtin_prefetch(l->rest);
+    return true;
+  }
+  return false;
+}
+
+// Sorts many lists at once.  See the header for details.
+void mbi1_merge_sort_many_width(ListNode **const heads, const size_t count,
+                                ListNodeCompareFxn *const cmp, int width) {
+  width = width < 1 ? 1 : width > MBI1_MAX_WIDTH ? MBI1_MAX_WIDTH : width;
+
+  // The lanes stay put, since a lane's 'out_tail' can point at its own
+  // 'out_head'.  'live' lists the ones still working.
+  SortLane lane[MBI1_MAX_WIDTH];
+  int live[MBI1_MAX_WIDTH];
+  int num_live = 0;
+  size_t next = 0;
+  while (num_live < width &&
+         start_lane(&lane[num_live], heads, count, &next, cmp)) {
+    live[num_live] = num_live;
+    num_live++;
+  }
+
+  // Step each lane in turn.  When a lane finishes its list, it moves on to
+  // the next one, until there are none left.
+  while (num_live) {
+    for (int k = 0; k < num_live; ) {
+      SortLane *const l = &lane[live[k]];
+      if (sort_step(l, cmp)) {
+        k++;
+        continue;
+      }
+      heads[l->index] = l->rest;
+      if (start_lane(l, heads, count, &next, cmp)) {
+        k++;
+      } else {
+        live[k] = live[--num_live];
+      }
+    }
+  }
+}
+
+// Same as above, using the width set by mbi1_merge_sort_set_width.
+void mbi1_merge_sort_many(ListNode **const heads, const size_t count,
+                          ListNodeCompareFxn *const cmp) {
+  mbi1_merge_sort_many_width(heads, count, cmp, mbi1_width);
+}
@@ -0,0 +1,36 @@
+// Sorts many short lists in one call, interleaving their merges so that their
+// cache misses overlap.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#ifndef MBI1_MERGE_SORT_H_
+#define MBI1_MERGE_SORT_H_
+
+#include <stddef.h>
+
+#include "list_node.h"
+#include "list_sort.h"
+
+// The most lists mbi1_merge_sort_many works on at once.
+#define MBI1_MAX_WIDTH (64)
+
+// Sets the number of lists mbi1_merge_sort_many works on at once.  Clamped to
+// [1, MBI1_MAX_WIDTH].  The default is 16.
+void mbi1_merge_sort_set_width(int width);
+
+// Sorts each of the 'count' lists in 'heads', replacing each with its new
+// head.  It works on 'width' lists at a time, each with its own state machine
+// that advances one node per step, and steps them round-robin, prefetching
+// each one's next node.  When a list finishes, the next unsorted list takes
+// its place.  Each list first gets cut into 3-node leaves, sorted with
+// list_leaf_sort's binary insertion sort, and then goes through
+// tdi2_merge_sort-style bottom-up merge passes.  Lists of up to 3 nodes just
+// get the leaf sort.  The sort is stable.
+void mbi1_merge_sort_many_width(ListNode **heads, size_t count,
+                                ListNodeCompareFxn *cmp, int width);
+
+// Same as above, using the width set by mbi1_merge_sort_set_width.
+void mbi1_merge_sort_many(ListNode **heads, size_t count,
+                          ListNodeCompareFxn *cmp);
+
+#endif  // MBI1_MERGE_SORT_H_
@@ -0,0 +1,149 @@
+// Most-significant-digit first radix sort for integer-keyed list nodes.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#include "msd1_radix_sort.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "bui2_merge_sort.h"
+#include "list_instrument.h"
+
+#define RADIX_BITS (8)
+#define RADIX (1 << RADIX_BITS)
+#define RADIX_MASK (RADIX - 1)
+
+// Buckets with at most this many nodes get a comparison sort instead of
+// another distribution pass.  A pass costs a 256-entry bucket sweep no matter
+// how few nodes there are.
+#define SMALL_BUCKET (64)
+
+typedef struct {
+  ListNode *head;
+  ListNode **tail_next;
+} RadixRet;
+
+// Reads the signed key at key_offset, and flips its sign bit so that unsigned
+// comparisons order keys the same way signed comparisons would.
+static inline uint64_t read_key(const ListNode *const node,
+                                const size_t key_offset) {
+  int64_t key;
+  memcpy(&key, (const char *)node + key_offset, sizeof(key));
+  return (uint64_t)key ^ (UINT64_C(1) << 63);
+}
+
+// Sorts a list with a comparison sort, and finds its tail's 'next' pointer.
+static RadixRet small_sort(ListNode *const head,
+                           ListNodeCompareFxn *const cmp) {
+  RadixRet ret = {
+    .head = bui2_merge_sort_part(head, cmp),
+    .tail_next = NULL
+  };
+  for (ListNode *node = ret.head; node; node = node->next) {
+    ret.tail_next = &node->next;
+    LIST_COUNT_VISIT();
+  }
+  return ret;
+}
+
+// Sorts a non-empty list of 'length' nodes whose keys all agree above bit
+// 'shift + RADIX_BITS', on the digit at 'shift' and every digit below it.
+static RadixRet msd_recurse(
+    ListNode *const head,
+    const size_t length,
+    const int shift,
+    const size_t key_offset,
+    ListNodeCompareFxn *const cmp
+) {
+  ListNode *bucket_head[RADIX];
+  ListNode **bucket_tail[RADIX];
+  size_t bucket_len[RADIX];
+
+  for (int i = 0; i < RADIX; ++i) {
+    bucket_tail[i] = &bucket_head[i];
+    bucket_len[i] = 0;
+  }
+
+  // Distribute, appending to each bucket's tail.
+  for (ListNode *node = head; node; node = node->next) {
+    const int digit = (read_key(node, key_offset) >> shift) & RADIX_MASK;
+    *bucket_tail[digit] = node;
+    bucket_tail[digit] = &node->next;
+    bucket_len[digit]++;
+    LIST_COUNT_LINK();
+    LIST_COUNT_VISIT();
+  }
+
+  // Finish each bucket, and string them together.
+  RadixRet ret = { .head = NULL, .tail_next = NULL };
+  ListNode **pnext = &ret.head;
+
+  for (int i = 0; i < RADIX; ++i) {
+    if (!bucket_len[i]) {
+      continue;
+    }
+    *bucket_tail[i] = NULL;
+    LIST_COUNT_LINK();
+
+    RadixRet sub;
+    if (bucket_len[i] == 1 || shift == 0) {
+      // Every key in this bucket is equal.  Nothing left to do.
+      sub.head = bucket_head[i];
+      sub.tail_next = bucket_tail[i];
+    } else if (bucket_len[i] <= SMALL_BUCKET) {
+      sub = small_sort(bucket_head[i], cmp);
+    } else if (bucket_len[i] == length) {
+      // Every node landed in one bucket; move on to the next digit directly.
+      return msd_recurse(bucket_head[i], length, shift - RADIX_BITS,
+                         key_offset, cmp);
+    } else {
+      sub = msd_recurse(bucket_head[i], bucket_len[i], shift - RADIX_BITS,
+                        key_offset, cmp);
+    }
+
+    *pnext = sub.head;
+    pnext = sub.tail_next;
+    LIST_COUNT_LINK();
+    ret.tail_next = sub.tail_next;
+  }
+
+  return ret;
+}
+
+// Sorts a singly linked list of nodes that each hold a signed int64_t key
+// 'key_offset' bytes from the start of the node.  Distributes nodes into 256
+// bucket lists on the most significant 8-bit digit that varies, by relinking
+// their 'next' pointers, and then recurses into each bucket on the next digit.
+// Buckets that get small enough are finished with a comparison sort.
+ListNode *msd1_radix_sort(ListNode *const head, const size_t key_offset,
+                          ListNodeCompareFxn *const cmp) {
+  // Scan once to find the list length, and which bits differ between keys.
+  uint64_t key_and = ~UINT64_C(0), key_or = 0;
+  size_t length = 0;
+  for (ListNode *node = head; node; node = node->next) {
+    const uint64_t key = read_key(node, key_offset);
+    key_and &= key;
+    key_or |= key;
+    length++;
+    LIST_COUNT_VISIT();
+  }
+
+  // Nothing to do if there are fewer than two distinct keys.
+  const uint64_t key_diff = key_and ^ key_or;
+  if (!key_diff) {
+    return head;
+  }
+
+  if (length <= SMALL_BUCKET) {
+    return bui2_merge_sort_part(head, cmp);
+  }
+
+  // Start at the most significant digit that has any variation.
+  int shift = 64 - RADIX_BITS;
+  while (!((key_diff >> shift) & RADIX_MASK)) {
+    shift -= RADIX_BITS;
+  }
+
+  return msd_recurse(head, length, shift, key_offset, cmp).head;
+}
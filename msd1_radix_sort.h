@@ -0,0 +1,22 @@
+// Most-significant-digit first radix sort for integer-keyed list nodes.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#ifndef MSD1_RADIX_SORT_H_
+#define MSD1_RADIX_SORT_H_
+
+#include <stddef.h>
+
+#include "list_node.h"
+#include "list_sort.h"
+
+// Sorts a singly linked list of nodes that each hold a signed int64_t key
+// 'key_offset' bytes from the start of the node.  Distributes nodes into 256
+// bucket lists on the most significant 8-bit digit that varies, by relinking
+// their 'next' pointers, and then recurses into each bucket on the next digit.
+// Buckets that get small enough are finished with a comparison sort using
+// 'cmp', which must order nodes the same way as their keys.
+ListNode *msd1_radix_sort(ListNode *head, size_t key_offset,
+                          ListNodeCompareFxn *cmp);
+
+#endif  // MSD1_RADIX_SORT_H_
@@ -57,35 +57,43 @@
 #include <stdio.h>
 #include "mt64.h"
 
-#define NN 312
+#define NN MT64_NN
 #define MM 156
 #define MATRIX_A UINT64_C(0xB5026F5AA96619E9)
 #define UM UINT64_C(0xFFFFFFFF80000000) /* Most significant 33 bits */
 #define LM UINT64_C(0x7FFFFFFF) /* Least significant 31 bits */
 
 
-/* The array for the state vector */
-static uint64_t mt[NN]; 
+/* The state vector behind the non-reentrant functions */
 /* mti==NN+1 means mt[NN] is not initialized */
-static int mti=NN+1; 
+static mt64_state global_state = { .mti = NN+1 };
 
 /* initializes mt[NN] with a seed */
-void init_genrand64(uint64_t seed)
+void init_genrand64_r(mt64_state *state, uint64_t seed)
 {
+    uint64_t *const mt = state->mt;
+    int mti;
     mt[0] = seed;
     for (mti=1; mti<NN; mti++) 
         mt[mti] =  (UINT64_C(6364136223846793005) * (mt[mti-1] ^ (mt[mti-1] >> 62)) + mti);
+    state->mti = mti;
+}
+
+void init_genrand64(uint64_t seed)
+{
+    init_genrand64_r(&global_state, seed);
 }
 
 /* initialize by an array with array-length */
 /* init_key is the array for initializing keys */
 /* key_length is its length */
-void init_by_array64(uint64_t init_key[],
+void init_by_array64_r(mt64_state *state, uint64_t init_key[],
                                     uint64_t key_length)
 {
+    uint64_t *const mt = state->mt;
     unsigned int i, j;
     uint64_t k;
-    init_genrand64(UINT64_C(19650218));
+    init_genrand64_r(state, UINT64_C(19650218));
     i=1; j=0;
     k = (NN>key_length ? NN : key_length);
     for (; k; k--) {
@@ -105,19 +113,26 @@ void init_by_array64(uint64_t init_key[],
     mt[0] = UINT64_C(1) << 63; /* MSB is 1; assuring non-zero initial array */ 
 }
 
+void init_by_array64(uint64_t init_key[],
+                                    uint64_t key_length)
+{
+    init_by_array64_r(&global_state, init_key, key_length);
+}
+
 /* generates a random number on [0, 2^64-1]-interval */
-uint64_t genrand64_int64(void)
+uint64_t genrand64_int64_r(mt64_state *state)
 {
+    uint64_t *const mt = state->mt;
     int i;
     uint64_t x;
-    static uint64_t mag01[2]={UINT64_C(0), MATRIX_A};
+    static const uint64_t mag01[2]={UINT64_C(0), MATRIX_A};
 
-    if (mti >= NN) { /* generate NN words at one time */
+    if (state->mti >= NN) { /* generate NN words at one time */
 
         /* if init_genrand64() has not been called, */
         /* a default initial seed is used     */
-        if (mti == NN+1) 
-            init_genrand64(UINT64_C(5489)); 
+        if (state->mti == NN+1) 
+            init_genrand64_r(state, UINT64_C(5489)); 
 
         for (i=0;i<NN-MM;i++) {
             x = (mt[i]&UM)|(mt[i+1]&LM);
@@ -130,10 +145,10 @@ uint64_t genrand64_int64(void)
         x = (mt[NN-1]&UM)|(mt[0]&LM);
         mt[NN-1] = mt[MM-1] ^ (x>>1) ^ mag01[(int)(x&UINT64_C(1))];
 
-        mti = 0;
+        state->mti = 0;
     }
   
-    x = mt[mti++];
+    x = mt[state->mti++];
 
     x ^= (x >> 29) & UINT64_C(0x5555555555555555);
     x ^= (x << 17) & UINT64_C(0x71D67FFFEDA60000);
@@ -143,6 +158,11 @@ uint64_t genrand64_int64(void)
     return x;
 }
 
+uint64_t genrand64_int64(void)
+{
+    return genrand64_int64_r(&global_state);
+}
+
 /* generates a random number on [0, 2^63-1]-interval */
 int64_t genrand64_int63(void)
 {
@@ -156,9 +176,14 @@ double genrand64_real1(void)
 }
 
 /* generates a random number on [0,1)-real-interval */
+double genrand64_real2_r(mt64_state *state)
+{
+    return (genrand64_int64_r(state) >> 11) * (1.0/9007199254740992.0);
+}
+
 double genrand64_real2(void)
 {
-    return (genrand64_int64() >> 11) * (1.0/9007199254740992.0);
+    return genrand64_real2_r(&global_state);
 }
 
 /* generates a random number on (0,1)-real-interval */
@@ -53,19 +53,36 @@
    email: m-mat @ math.sci.hiroshima-u.ac.jp (remove spaces)
 */
 
+#ifndef MT64_H_
+#define MT64_H_
+
 #include <inttypes.h>
 
+#define MT64_NN 312
+
+/* The generator's state.  The functions without the _r suffix share one */
+/* global state, and so aren't reentrant.  The _r variants take an explicit */
+/* state, which lets each thread run its own generator. */
+typedef struct {
+    uint64_t mt[MT64_NN];
+    int mti;
+} mt64_state;
+
 /* initializes mt[NN] with a seed */
 void init_genrand64(uint64_t seed);
+void init_genrand64_r(mt64_state *state, uint64_t seed);
 
 /* initialize by an array with array-length */
 /* init_key is the array for initializing keys */
 /* key_length is its length */
 void init_by_array64(uint64_t init_key[], 
                                     uint64_t key_length);
+void init_by_array64_r(mt64_state *state, uint64_t init_key[],
+                                    uint64_t key_length);
 
 /* generates a random number on [0, 2^64-1]-interval */
 uint64_t genrand64_int64(void);
+uint64_t genrand64_int64_r(mt64_state *state);
 
 
 /* generates a random number on [0, 2^63-1]-interval */
@@ -76,6 +93,9 @@ double genrand64_real1(void);
 
 /* generates a random number on [0,1)-real-interval */
 double genrand64_real2(void);
+double genrand64_real2_r(mt64_state *state);
 
 /* generates a random number on (0,1)-real-interval */
 double genrand64_real3(void);
+
+#endif /* MT64_H_ */
@@ -0,0 +1,350 @@
+// Implements a natural (run-adaptive) bottom-up merge sort on a linked list.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#include "nbi1_merge_sort.h"
+
+#include <stddef.h>
+
+#include "list_instrument.h"
+
+// TimSort's balance rules make run lengths grow at least as fast as the
+// Fibonacci numbers going down the stack, so this covers any 64-bit length.
+#define MAX_STACK (128)
+
+// Runs shorter than this get extended with insertion sort, so random inputs
+// don't degenerate into a flood of tiny merges.
+#define MIN_RUN (8)
+
+// Number of consecutive wins from one side before a merge starts galloping.
+#define MIN_GALLOP (7)
+
+typedef struct {
+  size_t length;
+  ListNode *head;
+  ListNode *tail;
+} Run;
+
+typedef struct {
+  int top;
+  size_t min_gallop;  // Adapts to how well galloping is paying off.
+  Run run[MAX_STACK];
+} Stack;
+
+// Extracts the next run from the rest of the list, reversing it if it's
+// strictly descending, and extending it to MIN_RUN nodes if it's short.
+// Returns the rest of the list.
+static inline ListNode *next_run(
+    Run *const restrict run,
+    ListNode *const first,
+    ListNodeCompareFxn *const cmp
+) {
+  ListNode *head = first, *tail = first;
+  ListNode *node = first->next;
+  size_t length = 1;
+  LIST_COUNT_VISIT();
+
+  if (node && cmp(node, first)) {
+    // Strictly descending: reverse it as we go.  It must be strictly
+    // descending, or the reversal would break stability.
+    first->next = NULL;
+    LIST_COUNT_LINK();
+    while (node && cmp(node, head)) {
+      ListNode *const next = node->next;
+      node->next = head;
+      head = node;
+      node = next;
+      length++;
+      LIST_COUNT_VISIT();
+      LIST_COUNT_LINK();
+    }
+  } else {
+    // Ascending (non-descending).
+    while (node && !cmp(node, tail)) {
+      tail = node;
+      node = node->next;
+      length++;
+      LIST_COUNT_VISIT();
+    }
+  }
+
+  // Extend short runs with a straight insertion sort.  Insert each node after
+  // every node it's not less than, to keep things stable.
+  while (length < MIN_RUN && node) {
+    ListNode *const ins = node;
+    node = node->next;
+    length++;
+    LIST_COUNT_VISIT();
+
+    if (!cmp(ins, tail)) {
+      tail->next = ins;
+      tail = ins;
+      LIST_COUNT_LINK();
+    } else if (cmp(ins, head)) {
+      ins->next = head;
+      head = ins;
+      LIST_COUNT_LINK();
+    } else {
+      ListNode *prev = head;
+      while (!cmp(ins, prev->next)) {
+        prev = prev->next;
+        LIST_COUNT_VISIT();
+      }
+      ins->next = prev->next;
+      prev->next = ins;
+      LIST_COUNT_LINK();
+      LIST_COUNT_LINK();
+    }
+  }
+
+  tail->next = NULL;
+  LIST_COUNT_LINK();
+  run->length = length;
+  run->head = head;
+  run->tail = tail;
+  return node;
+}
+
+// Gallops along a sorted list starting at 'first', returning the last node of
+// the longest prefix whose nodes all belong ahead of 'key'.  For nodes from
+// the earlier run ('from_a' true), that means not greater than 'key';
+// otherwise it means strictly less than 'key', so ties go to the earlier run.
+// The caller guarantees 'first' itself belongs ahead of 'key'.
+//
+// Probes at exponentially growing distances, then binary searches the last
+// gap.  We still walk every node, but only compare O(log k) of them.
+static inline ListNode *gallop(
+    ListNode *const first,
+    const ListNode *const key,
+    const bool from_a,
+    ListNodeCompareFxn *const cmp,
+    size_t *const count
+) {
+#define AHEAD(n) (from_a ? !cmp(key, (n)) : cmp((n), key))
+  ListNode *good = first;
+  size_t good_count = 1;
+  size_t step = 1;
+
+  for (;;) {
+    ListNode *probe = good;
+    size_t i = 0;
+    while (i < step && probe->next) {
+      probe = probe->next;
+      i++;
+      LIST_COUNT_VISIT();
+    }
+
+    // Hit the end of the list without a failed probe.
+    if (!i) {
+      break;
+    }
+
+    if (!AHEAD(probe)) {
+      // The answer lies strictly between 'good' and 'probe'.
+      size_t span = i - 1;
+      while (span) {
+        const size_t half = (span + 1) / 2;
+        ListNode *mid = good;
+        for (size_t j = 0; j < half; ++j) {
+          mid = mid->next;
+          LIST_COUNT_VISIT();
+        }
+        if (AHEAD(mid)) {
+          good = mid;
+          good_count += half;
+          span -= half;
+        } else {
+          span = half - 1;
+        }
+      }
+      break;
+    }
+
+    good = probe;
+    good_count += i;
+    step *= 2;
+  }
+
+  *count = good_count;
+  return good;
+#undef AHEAD
+}
+
+// Merges run 'b' into run 'a', where 'a' precedes 'b' in the original list.
+// Ties go to 'a' to keep things stable.
+static inline void merge_runs(
+    Run *const restrict a,
+    const Run *const restrict b,
+    size_t *const restrict min_gallop,
+    ListNodeCompareFxn *const cmp
+) {
+  const size_t length = a->length + b->length;
+
+  // Already in order?  This is what makes sorted input O(n).
+  if (!cmp(b->head, a->tail)) {
+    a->tail->next = b->head;
+    a->tail = b->tail;
+    LIST_COUNT_LINK();
+    a->length = length;
+    return;
+  }
+
+  // Entirely in reverse order?
+  if (cmp(b->tail, a->head)) {
+    b->tail->next = a->head;
+    a->head = b->head;
+    LIST_COUNT_LINK();
+    a->length = length;
+    return;
+  }
+
+  ListNode *pa = a->head, *pb = b->head;
+  ListNode *merged = NULL, **pnext = &merged;
+
+  for (;;) {
+    // One node at a time, until one side wins min_gallop times in a row.
+    size_t wins_a = 0, wins_b = 0;
+    while (wins_a < *min_gallop && wins_b < *min_gallop) {
+      if (cmp(pb, pa)) {
+        *pnext = pb;
+        pnext = &pb->next;
+        pb = pb->next;
+        wins_b++;
+        wins_a = 0;
+        LIST_COUNT_LINK();
+        LIST_COUNT_VISIT();
+        if (!pb) {
+          goto done;
+        }
+      } else {
+        *pnext = pa;
+        pnext = &pa->next;
+        pa = pa->next;
+        wins_a++;
+        wins_b = 0;
+        LIST_COUNT_LINK();
+        LIST_COUNT_VISIT();
+        if (!pa) {
+          goto done;
+        }
+      }
+    }
+
+    // Gallop, splicing whole blocks at a time, for as long as it pays off.
+    size_t count_a, count_b;
+    do {
+      count_a = count_b = 0;
+
+      if (!cmp(pb, pa)) {
+        ListNode *const last = gallop(pa, pb, true, cmp, &count_a);
+        *pnext = pa;
+        pnext = &last->next;
+        pa = last->next;
+        LIST_COUNT_LINK();
+        LIST_COUNT_VISIT();
+        if (!pa) {
+          goto done;
+        }
+      }
+
+      if (cmp(pb, pa)) {
+        ListNode *const last = gallop(pb, pa, false, cmp, &count_b);
+        *pnext = pb;
+        pnext = &last->next;
+        pb = last->next;
+        LIST_COUNT_LINK();
+        LIST_COUNT_VISIT();
+        if (!pb) {
+          goto done;
+        }
+      }
+
+      if (*min_gallop > 1) {
+        --*min_gallop;
+      }
+    } while (count_a >= MIN_GALLOP || count_b >= MIN_GALLOP);
+
+    // Galloping stopped paying off; make it harder to get back into.
+    *min_gallop += 2;
+  }
+
+done:
+  // Once we exhaust one list, append the other as-is to the merged list.
+  *pnext = pa ? pa : pb;
+  LIST_COUNT_LINK();
+  a->head = merged;
+  a->tail = pa ? a->tail : b->tail;
+  a->length = length;
+}
+
+// Merges the runs at stack positions i and i + 1.
+static inline void merge_at(Stack *const restrict stk, const int i,
+                            ListNodeCompareFxn *const cmp) {
+  merge_runs(&stk->run[i], &stk->run[i + 1], &stk->min_gallop, cmp);
+
+  // If we merged the 2nd and 3rd from the top, slide the top down.
+  if (i == stk->top - 3) {
+    stk->run[i + 1] = stk->run[i + 2];
+  }
+  stk->top--;
+}
+
+// Returns the length of the run at stack position i.
+static inline size_t len_at(const Stack *const restrict stk, const int i) {
+  return stk->run[i].length;
+}
+
+// Merges runs until the stack satisfies TimSort's invariants:
+//   len[i - 2] > len[i - 1] + len[i] and len[i - 1] > len[i]
+// This includes the fix for the invariant violation found by de Gouw et al.
+static inline void collapse(Stack *const restrict stk,
+                            ListNodeCompareFxn *const cmp) {
+  while (stk->top > 1) {
+    int n = stk->top - 2;
+    if ((n > 0 && len_at(stk, n - 1) <= len_at(stk, n) + len_at(stk, n + 1)) ||
+        (n > 1 && len_at(stk, n - 2) <= len_at(stk, n - 1) + len_at(stk, n))) {
+      if (len_at(stk, n - 1) < len_at(stk, n + 1)) {
+        n--;
+      }
+    } else if (len_at(stk, n) > len_at(stk, n + 1)) {
+      break;
+    }
+    merge_at(stk, n, cmp);
+  }
+}
+
+// Implements a stable natural merge sort on a singly linked list.  It splits
+// the input into its existing ascending and strictly descending runs
+// (reversing the latter), and merges them on a bui2_merge_sort-style stack
+// kept balanced with TimSort's rules.  Merges switch to galloping when one
+// side keeps winning.  Runs in O(n) time on already-sorted input.
+ListNode *nbi1_merge_sort(ListNode *const first,
+                          ListNodeCompareFxn *const cmp) {
+  // Handle degenerate cases of an empty list or a single-node list.
+  if (!first || !LIST_VISIT_NEXT(first)) {
+    return first;
+  }
+
+  // Our stack of runs.  Only need to initialize top and min_gallop.
+  Stack stk;
+  stk.top = 0;
+  stk.min_gallop = MIN_GALLOP;
+
+  // Push each run, restoring the stack invariants after each one.
+  ListNode *rest = first;
+  while (rest) {
+    rest = next_run(&stk.run[stk.top++], rest, cmp);
+    collapse(&stk, cmp);
+  }
+
+  // Merge everything that's left, smaller neighbors first.
+  while (stk.top > 1) {
+    int n = stk.top - 2;
+    if (n > 0 && len_at(&stk, n - 1) < len_at(&stk, n + 1)) {
+      n--;
+    }
+    merge_at(&stk, n, cmp);
+  }
+
+  return stk.run[0].head;
+}
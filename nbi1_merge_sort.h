@@ -0,0 +1,18 @@
+// Implements a natural (run-adaptive) bottom-up merge sort on a linked list.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#ifndef NBI1_MERGE_SORT_H_
+#define NBI1_MERGE_SORT_H_
+
+#include "list_node.h"
+#include "list_sort.h"
+
+// Implements a stable natural merge sort on a singly linked list.  It splits
+// the input into its existing ascending and strictly descending runs
+// (reversing the latter), and merges them on a bui2_merge_sort-style stack
+// kept balanced with TimSort's rules.  Merges switch to galloping when one
+// side keeps winning.  Runs in O(n) time on already-sorted input.
+ListNode *nbi1_merge_sort(ListNode *first, ListNodeCompareFxn *cmp);
+
+#endif  // NBI1_MERGE_SORT_H_
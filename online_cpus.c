@@ -0,0 +1,22 @@
+// Looks up how many CPUs are online, for the sorts and generators that start
+// one thread per CPU.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#include "online_cpus.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+static pthread_once_t online_cpus_once = PTHREAD_ONCE_INIT;
+static int online_cpus_count = 1;
+
+static void count_online_cpus(void) {
+  const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  online_cpus_count = cpus < 1 ? 1 : (int)cpus;
+}
+
+int online_cpus(void) {
+  pthread_once(&online_cpus_once, count_online_cpus);
+  return online_cpus_count;
+}
@@ -0,0 +1,14 @@
+// Looks up how many CPUs are online, for the sorts and generators that start
+// one thread per CPU.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#ifndef ONLINE_CPUS_H_
+#define ONLINE_CPUS_H_
+
+// Returns the number of online CPUs, and at least 1 if sysconf can't tell.
+// It asks sysconf once, on the first call, and returns the same count after.
+// Safe to call from any thread.
+int online_cpus(void);
+
+#endif  // ONLINE_CPUS_H_
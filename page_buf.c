@@ -0,0 +1,172 @@
+// Allocates large buffers backed by a chosen page size, and reports which page
+// size they actually got.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#define _GNU_SOURCE
+#include "page_buf.h"
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// The huge page size we align to for PAGE_BUF_THP and round up to for
+// PAGE_BUF_HUGETLB.  This is the default huge page size on x86-64.
+#define HUGE_PAGE_BYTES (2u << 20)
+
+static const char *const kind_names[] = {
+  [PAGE_BUF_MALLOC] = "malloc",
+  [PAGE_BUF_4K] = "4k",
+  [PAGE_BUF_THP] = "thp",
+  [PAGE_BUF_HUGETLB] = "hugetlb"
+};
+
+// Parses a page kind.
+bool page_buf_parse_kind(const char *const name, PageBufKind *const kind) {
+  for (size_t i = 0; i < sizeof(kind_names) / sizeof(kind_names[0]); ++i) {
+    if (!strcmp(name, kind_names[i])) {
+      *kind = (PageBufKind)i;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns the name of a page kind.
+const char *page_buf_kind_name(const PageBufKind kind) {
+  return kind_names[kind];
+}
+
+// Rounds 'bytes' up to a multiple of 'align', which must be a power of 2.
+static size_t round_up(const size_t bytes, const size_t align) {
+  return (bytes + align - 1) & -align;
+}
+
+// Maps anonymous memory, returning NULL on failure.
+static void *map_anon(const size_t bytes, const int extra_flags) {
+  void *const map = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | extra_flags, -1, 0);
+  return map == MAP_FAILED ? NULL : map;
+}
+
+// Allocates a page-backed buffer.
+bool page_buf_alloc(PageBuf *const buf, const size_t bytes,
+                    const PageBufKind kind) {
+  memset(buf, 0, sizeof(*buf));
+  buf->bytes = bytes;
+  buf->kind = kind;
+
+  switch (kind) {
+    case PAGE_BUF_MALLOC:
+      buf->ptr = malloc(bytes);
+      break;
+
+    case PAGE_BUF_4K:
+      buf->map_bytes = bytes;
+      buf->map = map_anon(bytes, 0);
+      if (buf->map) {
+        madvise(buf->map, bytes, MADV_NOHUGEPAGE);
+      }
+      buf->ptr = buf->map;
+      break;
+
+    case PAGE_BUF_HUGETLB:
+      buf->map_bytes = round_up(bytes, HUGE_PAGE_BYTES);
+      buf->map = map_anon(buf->map_bytes, MAP_HUGETLB);
+      buf->ptr = buf->map;
+      if (buf->map) {
+        break;
+      }
+      fprintf(stderr, "MAP_HUGETLB failed; are huge pages reserved in "
+              "/proc/sys/vm/nr_hugepages?  Using thp instead.\n");
+      buf->kind = PAGE_BUF_THP;
+      // Fall through.
+
+    case PAGE_BUF_THP: {
+      // Over-allocate, so that the buffer can start on a huge page boundary.
+      buf->map_bytes = round_up(bytes, HUGE_PAGE_BYTES) + HUGE_PAGE_BYTES;
+      buf->map = map_anon(buf->map_bytes, 0);
+      if (buf->map) {
+        const uintptr_t start =
+            round_up((uintptr_t)buf->map, HUGE_PAGE_BYTES);
+        buf->ptr = (void *)start;
+        madvise(buf->ptr, round_up(bytes, HUGE_PAGE_BYTES), MADV_HUGEPAGE);
+      }
+      break;
+    }
+  }
+
+  if (!buf->ptr) {
+    return false;
+  }
+
+  // Touch every page, so the kernel picks page sizes now, and page faults
+  // stay out of the timed sorts.
+  memset(buf->ptr, 0, bytes);
+  return true;
+}
+
+// Frees a page-backed buffer.
+void page_buf_free(PageBuf *const buf) {
+  if (buf->map) {
+    munmap(buf->map, buf->map_bytes);
+  } else {
+    free(buf->ptr);
+  }
+  memset(buf, 0, sizeof(*buf));
+}
+
+// Returns the bytes of the buffer the kernel backs with huge pages.  Sums the
+// huge page lines for every mapping that overlaps the buffer.  A mapping can
+// extend past the buffer, so it caps the total at the buffer's size.
+size_t page_buf_huge_bytes(const PageBuf *const buf) {
+  FILE *const smaps = fopen("/proc/self/smaps", "r");
+  if (!smaps) {
+    return 0;
+  }
+
+  const uintptr_t lo = (uintptr_t)buf->ptr;
+  const uintptr_t hi = lo + buf->bytes;
+  bool overlaps = false;
+  size_t huge_kb = 0;
+  char line[512];
+
+  while (fgets(line, sizeof(line), smaps)) {
+    uintptr_t start, end;
+    size_t kb;
+    if (sscanf(line, "%" SCNxPTR "-%" SCNxPTR " ", &start, &end) == 2) {
+      overlaps = start < hi && end > lo;
+    } else if (overlaps &&
+               (sscanf(line, "AnonHugePages: %zu kB", &kb) == 1 ||
+                sscanf(line, "Private_Hugetlb: %zu kB", &kb) == 1 ||
+                sscanf(line, "Shared_Hugetlb: %zu kB", &kb) == 1)) {
+      huge_kb += kb;
+    }
+  }
+
+  fclose(smaps);
+  return huge_kb * 1024 < buf->bytes ? huge_kb * 1024 : buf->bytes;
+}
+
+// Returns the memory available for new allocations.
+size_t page_buf_available_bytes(void) {
+  FILE *const meminfo = fopen("/proc/meminfo", "r");
+  if (!meminfo) {
+    return 0;
+  }
+
+  size_t avail_kb = 0;
+  char line[256];
+  while (fgets(line, sizeof(line), meminfo)) {
+    if (sscanf(line, "MemAvailable: %zu kB", &avail_kb) == 1) {
+      break;
+    }
+  }
+
+  fclose(meminfo);
+  return avail_kb * 1024;
+}
@@ -0,0 +1,54 @@
+// Allocates large buffers backed by a chosen page size, and reports which page
+// size they actually got.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#ifndef PAGE_BUF_H_
+#define PAGE_BUF_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Selects how a buffer gets its memory.
+typedef enum {
+  PAGE_BUF_MALLOC,   // Plain malloc.  The kernel may or may not use huge pages.
+  PAGE_BUF_4K,       // mmap, with transparent huge pages turned off.
+  PAGE_BUF_THP,      // mmap, aligned, with madvise(MADV_HUGEPAGE).
+  PAGE_BUF_HUGETLB   // mmap with MAP_HUGETLB, from the reserved huge pages.
+} PageBufKind;
+
+// A buffer, and the mapping behind it.
+typedef struct {
+  void *ptr;
+  size_t bytes;
+  PageBufKind kind;  // What we asked for, after any fallback.
+  void *map;         // The whole mapping, for munmap.  NULL for malloc.
+  size_t map_bytes;
+} PageBuf;
+
+// Parses a page kind ("malloc", "4k", "thp" or "hugetlb").  Returns false if
+// it doesn't recognize the name.
+bool page_buf_parse_kind(const char *name, PageBufKind *kind);
+
+// Returns the name of a page kind.
+const char *page_buf_kind_name(PageBufKind kind);
+
+// Allocates a buffer of 'bytes' bytes, and touches every page so that the
+// kernel backs it right away.  If MAP_HUGETLB fails, because no huge pages
+// are reserved, it warns on stderr and falls back to PAGE_BUF_THP.  Returns
+// false if it can't allocate the buffer at all.
+bool page_buf_alloc(PageBuf *buf, size_t bytes, PageBufKind kind);
+
+// Frees a buffer from page_buf_alloc.
+void page_buf_free(PageBuf *buf);
+
+// Returns how many bytes of the buffer the kernel backs with huge pages, from
+// the AnonHugePages and Hugetlb lines in /proc/self/smaps.  Returns 0 if it
+// can't tell.
+size_t page_buf_huge_bytes(const PageBuf *buf);
+
+// Returns the memory available for new allocations without swapping, from
+// MemAvailable in /proc/meminfo.  Returns 0 if it can't tell.
+size_t page_buf_available_bytes(void);
+
+#endif  // PAGE_BUF_H_
@@ -0,0 +1,166 @@
+// Implements a parallel bottom-up iterative merge sort on a linked list.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#include "pbi1_merge_sort.h"
+
+#include <pthread.h>
+#include <stddef.h>
+
+#include "bui2_merge_sort.h"
+#include "list_instrument.h"
+#include "online_cpus.h"
+
+#define MAX_THREADS (256)
+
+// Below this many nodes per thread, thread startup costs more than it saves.
+#define MIN_NODES_PER_THREAD (16384)
+
+static int pbi1_threads = 0;
+
+// Sets the number of threads pbi1_merge_sort uses.  Zero means "one thread
+// per online CPU."
+void pbi1_merge_sort_set_threads(const int threads) {
+  pbi1_threads = threads < 0 ? 0 : threads;
+}
+
+// Describes a contiguous range of segments [lo, hi) that one thread is
+// responsible for sorting and merging down into seg[lo].
+typedef struct {
+  ListNode **seg;
+  ListNodeCompareFxn *cmp;
+  int lo, hi;
+} MergeTreeTask;
+
+// Merges two sorted lists, returning the head of the merged list.
+static inline ListNode *merge(ListNode *a, ListNode *b,
+                              ListNodeCompareFxn *const cmp) {
+  ListNode *merged = NULL;
+  ListNode **pnext = &merged;
+
+  // Take the smallest from a or b, as long as both lists are non-empty.
+  // Ties go to 'a', which holds the earlier segment, so the merge tree keeps
+  // equal nodes in segment order.  bui2_merge_sort doesn't, so the sort isn't
+  // stable.
+  while (a && b) {
+    ListNode **l = cmp(b, a) ? &b : &a;
+    *pnext = *l;
+    pnext = &(*pnext)->next;
+    *l = (*l)->next;
+    LIST_COUNT_LINK();
+    LIST_COUNT_VISIT();
+  }
+
+  // Once we exhaust one list, append the other as-is to the merged list.
+  *pnext = a ? a : b;
+  LIST_COUNT_LINK();
+
+  return merged;
+}
+
+// Sorts the segments in [lo, hi) and merges them into seg[lo].  Hands the
+// upper half of the range to a new thread and works on the lower half itself,
+// so the merges at each level of the tree proceed in parallel.
+static void *merge_tree(void *const arg) {
+  const MergeTreeTask *const task = (const MergeTreeTask *)arg;
+  ListNode **const seg = task->seg;
+
+  if (task->hi - task->lo == 1) {
+    seg[task->lo] = bui2_merge_sort_part(seg[task->lo], task->cmp);
+    return NULL;
+  }
+
+  const int mid = task->lo + (task->hi - task->lo) / 2;
+  MergeTreeTask lower = { .seg = seg, .cmp = task->cmp,
+                          .lo = task->lo, .hi = mid };
+  MergeTreeTask upper = { .seg = seg, .cmp = task->cmp,
+                          .lo = mid, .hi = task->hi };
+
+  // If we can't get a thread, just do the work ourselves.
+  pthread_t thread;
+  const bool spawned = !pthread_create(&thread, NULL, merge_tree, &upper);
+  if (!spawned) {
+    merge_tree(&upper);
+  }
+
+  merge_tree(&lower);
+
+  if (spawned) {
+    pthread_join(thread, NULL);
+  }
+
+  seg[task->lo] = merge(seg[task->lo], seg[mid], task->cmp);
+  return NULL;
+}
+
+// Implements a parallel merge sort on a singly linked list.  It cuts the list
+// into one segment per thread, sorts each segment with bui2_merge_sort, and
+// then merges the sorted segments pairwise in a parallel merge tree.
+ListNode *pbi1_merge_sort_threads(ListNode *const first,
+                                  ListNodeCompareFxn *const cmp,
+                                  int threads) {
+  // Handle degenerate cases of an empty list or a single-node list.
+  if (!first || !LIST_VISIT_NEXT(first)) {
+    return first;
+  }
+
+  // Measure length of the list once up-front, so we can cut it evenly.
+  size_t length = 0;
+  for (ListNode *node = first; node; node = node->next) {
+    length++;
+    LIST_COUNT_VISIT();
+  }
+
+  // Short lists don't need to know how many CPUs there are.
+  if (length < 2 * MIN_NODES_PER_THREAD) {
+    return bui2_merge_sort_part(first, cmp);
+  }
+
+  if (threads <= 0) {
+    threads = online_cpus();
+  }
+  if (threads > MAX_THREADS) {
+    threads = MAX_THREADS;
+  }
+  if ((size_t)threads > length / MIN_NODES_PER_THREAD) {
+    threads = (int)(length / MIN_NODES_PER_THREAD);
+  }
+
+  if (threads < 2) {
+    return bui2_merge_sort_part(first, cmp);
+  }
+
+  // Cut the list into one segment per thread.  The first 'extra' segments
+  // get one additional node each.
+  ListNode *seg[MAX_THREADS];
+  const size_t seg_len = length / threads;
+  const size_t extra = length % threads;
+  ListNode *node = first;
+
+  for (int i = 0; i < threads; ++i) {
+    const size_t len = seg_len + ((size_t)i < extra);
+    seg[i] = node;
+
+    for (size_t j = 1; j < len; ++j) {
+      node = node->next;
+      LIST_COUNT_VISIT();
+    }
+
+    ListNode *const rest = node->next;
+    node->next = NULL;
+    node = rest;
+    LIST_COUNT_VISIT();
+    LIST_COUNT_LINK();
+  }
+
+  MergeTreeTask root = { .seg = seg, .cmp = cmp, .lo = 0, .hi = threads };
+  merge_tree(&root);
+
+  return seg[0];
+}
+
+// Same as above, using the thread count set by pbi1_merge_sort_set_threads.
+ListNode *pbi1_merge_sort(ListNode *const first,
+                          ListNodeCompareFxn *const cmp) {
+  return pbi1_merge_sort_threads(first, cmp, pbi1_threads);
+}
@@ -0,0 +1,26 @@
+// Implements a parallel bottom-up iterative merge sort on a linked list.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#ifndef PBI1_MERGE_SORT_H_
+#define PBI1_MERGE_SORT_H_
+
+#include "list_node.h"
+#include "list_sort.h"
+
+// Sets the number of threads pbi1_merge_sort uses.  Zero (the default) means
+// "one thread per online CPU."
+void pbi1_merge_sort_set_threads(int threads);
+
+// Implements a parallel merge sort on a singly linked list.  It cuts the list
+// into one segment per thread, sorts each segment with bui2_merge_sort, and
+// then merges the sorted segments pairwise in a parallel merge tree.  The
+// merge tree keeps equal nodes in segment order, but bui2_merge_sort doesn't,
+// so the sort isn't stable.
+ListNode *pbi1_merge_sort_threads(ListNode *first, ListNodeCompareFxn *cmp,
+                                  int threads);
+
+// Same as above, using the thread count set by pbi1_merge_sort_set_threads.
+ListNode *pbi1_merge_sort(ListNode *first, ListNodeCompareFxn *cmp);
+
+#endif  // PBI1_MERGE_SORT_H_
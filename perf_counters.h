@@ -0,0 +1,57 @@
+// Reads hardware performance counters around a block of code, through Linux's
+// perf_event_open.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#ifndef PERF_COUNTERS_H_
+#define PERF_COUNTERS_H_
+
+#include <stdbool.h>
+
+// The events we count.
+typedef enum {
+  PERF_COUNTER_CYCLES,
+  PERF_COUNTER_INSTRUCTIONS,
+  PERF_COUNTER_L1D_MISSES,
+  PERF_COUNTER_LLC_MISSES,
+  PERF_COUNTER_DTLB_MISSES,
+  PERF_COUNTER_BRANCH_MISSES,
+  PERF_COUNTER_COUNT
+} PerfCounterEvent;
+
+// One set of counters, for the calling thread and any threads it creates while
+// counting.  'fd' is -1 for each event the kernel or CPU doesn't support.
+typedef struct {
+  int fd[PERF_COUNTER_COUNT];
+} PerfCounters;
+
+// The counts from one measurement.  A count is negative if its event isn't
+// available.
+typedef struct {
+  double count[PERF_COUNTER_COUNT];
+} PerfCounts;
+
+// Returns the name of an event, for CSV column headings.
+const char *perf_counters_event_name(PerfCounterEvent event);
+
+// Opens the counters for the calling thread.  Returns false if none of the
+// events are available, for example because there's no PMU in a VM, or
+// /proc/sys/kernel/perf_event_paranoid forbids it.  Either way, the other
+// functions are safe to call.
+bool perf_counters_open(PerfCounters *counters);
+
+// Closes the counters.
+void perf_counters_close(PerfCounters *counters);
+
+// Returns true if the counters can count 'event'.
+bool perf_counters_has(const PerfCounters *counters, PerfCounterEvent event);
+
+// Zeroes and starts the counters.
+void perf_counters_start(PerfCounters *counters);
+
+// Stops the counters and reads them into 'counts'.  If the kernel had to
+// multiplex the counters, the counts are scaled up to estimates over the whole
+// time they were enabled.
+void perf_counters_stop(PerfCounters *counters, PerfCounts *counts);
+
+#endif  // PERF_COUNTERS_H_
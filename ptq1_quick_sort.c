@@ -0,0 +1,377 @@
+// Parallel linked-list QuickSort, using per-thread work-stealing deques.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#include "ptq1_quick_sort.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "list_instrument.h"
+#include "online_cpus.h"
+#include "tdq1_quick_sort.h"
+
+#define MAX_THREADS (256)
+
+// Deque capacity per thread.  Must be a power of 2.  If a deque fills up, its
+// owner just sorts the partition it wanted to push itself.
+#define DEQUE_CAP (1024)
+
+// Partitions at or below this many nodes get sorted serially.
+#define SERIAL_CUTOFF (8192)
+
+// Lists shorter than this don't bother starting any threads.
+#define PARALLEL_THRESHOLD (4 * SERIAL_CUTOFF)
+
+static int ptq1_threads = 0;
+
+// Sets the number of threads ptq1_quick_sort uses.  Zero means "one thread
+// per online CPU."
+void ptq1_quick_sort_set_threads(const int threads) {
+  ptq1_threads = threads < 0 ? 0 : threads;
+}
+
+// An unsorted partition.  Once sorted, its head goes into *link_in, and its
+// tail's 'next' pointer gets 'follow', which is the node that comes right
+// after this partition in the final sorted order.  This lets each partition
+// stitch itself into the result without waiting on anyone else.
+typedef struct {
+  ListNode *head;
+  size_t length;
+  ListNode **link_in;
+  ListNode *follow;
+} Task;
+
+// A deque slot.  Thieves may read a slot while its owner refills it; the
+// thief then loses the race on 'top' and discards what it read.  The fields
+// are atomic so that race stays well defined.
+typedef struct {
+  _Atomic(ListNode *) head;
+  atomic_size_t length;
+  _Atomic(ListNode **) link_in;
+  _Atomic(ListNode *) follow;
+} TaskSlot;
+
+// A fixed-capacity Chase-Lev work-stealing deque.  The owner pushes and takes
+// at the bottom; thieves steal from the top.  Uses the C11 formulation from
+// Le, Pop, Cohen and Zappa Nardelli, "Correct and Efficient Work-Stealing for
+// Weak Memory Models," PPoPP 2013.
+typedef struct {
+  _Alignas(64) atomic_ptrdiff_t top;
+  _Alignas(64) atomic_ptrdiff_t bottom;
+  TaskSlot slot[DEQUE_CAP];
+} Deque;
+
+// State shared by all the threads participating in one sort.
+typedef struct {
+  ListNodeCompareFxn *cmp;
+  int threads;
+  Deque *deque;  // One per thread.
+  _Alignas(64) atomic_size_t pending;  // Tasks pushed but not yet finished.
+} SortContext;
+
+// Per-thread state.
+typedef struct {
+  SortContext *ctx;
+  int id;
+  uint64_t rng;  // For picking steal victims.
+} Worker;
+
+static void write_slot(TaskSlot *const slot, const Task *const task) {
+  atomic_store_explicit(&slot->head, task->head, memory_order_relaxed);
+  atomic_store_explicit(&slot->length, task->length, memory_order_relaxed);
+  atomic_store_explicit(&slot->link_in, task->link_in, memory_order_relaxed);
+  atomic_store_explicit(&slot->follow, task->follow, memory_order_relaxed);
+}
+
+static Task read_slot(TaskSlot *const slot) {
+  const Task task = {
+    .head = atomic_load_explicit(&slot->head, memory_order_relaxed),
+    .length = atomic_load_explicit(&slot->length, memory_order_relaxed),
+    .link_in = atomic_load_explicit(&slot->link_in, memory_order_relaxed),
+    .follow = atomic_load_explicit(&slot->follow, memory_order_relaxed)
+  };
+  return task;
+}
+
+// Pushes a task onto the bottom of the owner's deque.  Returns false if the
+// deque is full.
+static bool deque_push(Deque *const dq, const Task *const task) {
+  const ptrdiff_t b = atomic_load_explicit(&dq->bottom, memory_order_relaxed);
+  const ptrdiff_t t = atomic_load_explicit(&dq->top, memory_order_acquire);
+
+  if (b - t >= DEQUE_CAP) {
+    return false;
+  }
+
+  write_slot(&dq->slot[b & (DEQUE_CAP - 1)], task);
+  atomic_store_explicit(&dq->bottom, b + 1, memory_order_release);
+  return true;
+}
+
+// Takes a task from the bottom of the owner's deque.  Returns false if the
+// deque is empty.
+static bool deque_take(Deque *const dq, Task *const task) {
+  const ptrdiff_t b =
+      atomic_load_explicit(&dq->bottom, memory_order_relaxed) - 1;
+  atomic_store_explicit(&dq->bottom, b, memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);
+  ptrdiff_t t = atomic_load_explicit(&dq->top, memory_order_relaxed);
+
+  if (t > b) {
+    atomic_store_explicit(&dq->bottom, b + 1, memory_order_relaxed);
+    return false;
+  }
+
+  *task = read_slot(&dq->slot[b & (DEQUE_CAP - 1)]);
+
+  // Last task in the deque:  race any thieves for it.
+  bool ok = true;
+  if (t == b) {
+    ok = atomic_compare_exchange_strong_explicit(
+        &dq->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed);
+    atomic_store_explicit(&dq->bottom, b + 1, memory_order_relaxed);
+  }
+  return ok;
+}
+
+// Steals a task from the top of another thread's deque.  Returns false if the
+// deque was empty, or if another thread beat us to it.
+static bool deque_steal(Deque *const dq, Task *const task) {
+  ptrdiff_t t = atomic_load_explicit(&dq->top, memory_order_acquire);
+  atomic_thread_fence(memory_order_seq_cst);
+  const ptrdiff_t b = atomic_load_explicit(&dq->bottom, memory_order_acquire);
+
+  if (t >= b) {
+    return false;
+  }
+
+  *task = read_slot(&dq->slot[t & (DEQUE_CAP - 1)]);
+  return atomic_compare_exchange_strong_explicit(
+      &dq->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed);
+}
+
+// Tries each other thread's deque once, starting at a random victim.
+static bool steal_any(Worker *const w, Task *const task) {
+  SortContext *const ctx = w->ctx;
+
+  w->rng ^= w->rng << 13;
+  w->rng ^= w->rng >> 7;
+  w->rng ^= w->rng << 17;
+
+  const int start = (int)(w->rng % ctx->threads);
+  for (int i = 0; i < ctx->threads; ++i) {
+    const int victim = (start + i) % ctx->threads;
+    if (victim != w->id && deque_steal(&ctx->deque[victim], task)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Sorts one task's partition, stitching the result into place.  Partitions
+// above the cutoff get split around their head; we push the larger side for
+// others to steal and keep working on the smaller side.
+static void run_task(Worker *const w, Task task) {
+  SortContext *const ctx = w->ctx;
+  ListNodeCompareFxn *const cmp = ctx->cmp;
+
+  while (task.length > SERIAL_CUTOFF) {
+    ListNode *const pivot = task.head;
+    ListNode *node = pivot->next;
+    LIST_COUNT_VISIT();
+
+    // Partition the elements around the pivot.  Pull as large of a sublist as
+    // we can, to minimize the number of cachelines we dirty.
+    ListNode *less = NULL, *more = NULL;
+    size_t less_len = 0, more_len = 0;
+
+    while (node) {
+      ListNode *const tmp1 = node;
+      ListNode *tmp2 = node->next;
+      ListNode *ptm2 = tmp1;
+      size_t run = 1;
+      LIST_COUNT_VISIT();
+      if (cmp(tmp1, pivot)) {
+        // Pull as large a sublist as we can into less.
+        while (tmp2 && cmp(tmp2, pivot)) {
+          ptm2 = tmp2;
+          tmp2 = tmp2->next;
+          run++;
+          LIST_COUNT_VISIT();
+        }
+        ptm2->next = less;
+        less = tmp1;
+        LIST_COUNT_LINK();
+        less_len += run;
+      } else {
+        // Pull as large a sublist as we can into more.
+        while (tmp2 && !cmp(tmp2, pivot)) {
+          ptm2 = tmp2;
+          tmp2 = tmp2->next;
+          run++;
+          LIST_COUNT_VISIT();
+        }
+        ptm2->next = more;
+        more = tmp1;
+        LIST_COUNT_LINK();
+        more_len += run;
+      }
+      node = tmp2;
+    }
+
+    // The pivot sits between the two sides.  Link it in directly wherever a
+    // side came up empty.
+    Task lt = { .head = less, .length = less_len,
+                .link_in = task.link_in, .follow = pivot };
+    Task mt = { .head = more, .length = more_len,
+                .link_in = &pivot->next, .follow = task.follow };
+
+    if (!less) {
+      *task.link_in = pivot;
+      LIST_COUNT_LINK();
+    }
+    if (!more) {
+      pivot->next = task.follow;
+      LIST_COUNT_LINK();
+    }
+
+    if (!less || !more) {
+      task = less ? lt : mt;
+      if (!task.head) {
+        break;
+      }
+      continue;
+    }
+
+    Task *const small = less_len < more_len ? &lt : &mt;
+    Task *const large = less_len < more_len ? &mt : &lt;
+
+    if (large->length <= SERIAL_CUTOFF) {
+      // Both sides are small; sort them both right here.
+      run_task(w, *large);
+    } else {
+      atomic_fetch_add_explicit(&ctx->pending, 1, memory_order_relaxed);
+      if (!deque_push(&ctx->deque[w->id], large)) {
+        atomic_fetch_sub_explicit(&ctx->pending, 1, memory_order_relaxed);
+        run_task(w, *large);
+      }
+    }
+    task = *small;
+  }
+
+  // Small enough:  sort it serially and stitch it in.
+  if (task.head) {
+    const QuickSortRet qsr = tdq1_quick_sort_recurse(task.head, cmp);
+    *task.link_in = qsr.head;
+    *qsr.tail_next = task.follow;
+    LIST_COUNT_LINK();
+    LIST_COUNT_LINK();
+  }
+}
+
+// Runs tasks from our own deque, stealing from others when it runs dry, until
+// every pushed task has finished.
+static void *worker_loop(void *const arg) {
+  Worker *const w = (Worker *)arg;
+  SortContext *const ctx = w->ctx;
+  Task task;
+
+  while (atomic_load_explicit(&ctx->pending, memory_order_acquire)) {
+    if (deque_take(&ctx->deque[w->id], &task) || steal_any(w, &task)) {
+      run_task(w, task);
+      atomic_fetch_sub_explicit(&ctx->pending, 1, memory_order_release);
+    } else {
+      sched_yield();
+    }
+  }
+  return NULL;
+}
+
+// Sorts a singly linked list with a parallel naive pivot QuickSort.  Large
+// partitions go onto per-thread work-stealing deques, while partitions below
+// a size cutoff get sorted serially with tdq1_quick_sort_recurse.
+ListNode *ptq1_quick_sort_threads(ListNode *const head,
+                                  ListNodeCompareFxn *const cmp,
+                                  int threads) {
+  if (!head) {
+    return head;
+  }
+
+  // Only go parallel if the list is long enough to be worth it.  We don't
+  // need the exact length, so stop counting once we know.
+  size_t length = 0;
+  for (ListNode *node = head; node && length < PARALLEL_THRESHOLD;
+       node = node->next) {
+    length++;
+    LIST_COUNT_VISIT();
+  }
+  if (length < PARALLEL_THRESHOLD) {
+    return tdq1_quick_sort_recurse(head, cmp).head;
+  }
+
+  if (threads <= 0) {
+    threads = online_cpus();
+  }
+  if (threads > MAX_THREADS) {
+    threads = MAX_THREADS;
+  }
+  if (threads < 2) {
+    return tdq1_quick_sort_recurse(head, cmp).head;
+  }
+
+  // The deques are too big for the stack.  If we can't get them, sort
+  // serially.
+  Deque *const deque = aligned_alloc(_Alignof(Deque), sizeof(Deque) * threads);
+  if (!deque) {
+    return tdq1_quick_sort_recurse(head, cmp).head;
+  }
+
+  SortContext context = { .cmp = cmp, .threads = threads, .deque = deque };
+  SortContext *const ctx = &context;
+  for (int i = 0; i < threads; ++i) {
+    atomic_init(&deque[i].top, 0);
+    atomic_init(&deque[i].bottom, 0);
+  }
+
+  // The root task's true length is unknown, but it's definitely big.
+  ListNode *sorted = NULL;
+  const Task root = { .head = head, .length = SIZE_MAX,
+                      .link_in = &sorted, .follow = NULL };
+  atomic_store_explicit(&ctx->pending, 1, memory_order_relaxed);
+  deque_push(&ctx->deque[0], &root);
+
+  Worker worker[MAX_THREADS];
+  pthread_t thread[MAX_THREADS];
+  bool spawned[MAX_THREADS] = { false };
+
+  for (int i = 0; i < threads; ++i) {
+    worker[i].ctx = ctx;
+    worker[i].id = i;
+    worker[i].rng = 0x9E3779B97F4A7C15ull * (i + 1);
+  }
+
+  for (int i = 1; i < threads; ++i) {
+    spawned[i] = !pthread_create(&thread[i], NULL, worker_loop, &worker[i]);
+  }
+
+  worker_loop(&worker[0]);
+
+  for (int i = 1; i < threads; ++i) {
+    if (spawned[i]) {
+      pthread_join(thread[i], NULL);
+    }
+  }
+
+  free(deque);
+  return sorted;
+}
+
+// Same as above, using the thread count set by ptq1_quick_sort_set_threads.
+ListNode *ptq1_quick_sort(ListNode *const head, ListNodeCompareFxn *const cmp) {
+  return ptq1_quick_sort_threads(head, cmp, ptq1_threads);
+}
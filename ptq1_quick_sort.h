@@ -0,0 +1,24 @@
+// Parallel linked-list QuickSort, using per-thread work-stealing deques.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#ifndef PTQ1_QUICK_SORT_H_
+#define PTQ1_QUICK_SORT_H_
+
+#include "list_node.h"
+#include "list_sort.h"
+
+// Sets the number of threads ptq1_quick_sort uses.  Zero (the default) means
+// "one thread per online CPU."
+void ptq1_quick_sort_set_threads(int threads);
+
+// Sorts a singly linked list with a parallel naive pivot QuickSort.  Large
+// partitions go onto per-thread work-stealing deques, while partitions below
+// a size cutoff get sorted serially with tdq1_quick_sort_recurse.
+ListNode *ptq1_quick_sort_threads(ListNode *head, ListNodeCompareFxn *cmp,
+                                  int threads);
+
+// Same as above, using the thread count set by ptq1_quick_sort_set_threads.
+ListNode *ptq1_quick_sort(ListNode *head, ListNodeCompareFxn *cmp);
+
+#endif // PTQ1_QUICK_SORT_H_
@@ -0,0 +1,579 @@
+// Vectorized sorting-network and merge kernels for arrays of 64-bit keys.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#include "simd_sort.h"
+
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_SORT_X86 (1)
+#include <immintrin.h>
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+
+// The vector kernels all follow the same plan.  A register holds 'lanes'
+// keys, and a second register holds their payloads.  Every compare-exchange
+// computes a mask from the keys, and applies it to both.
+//
+// Sorting a register is a bitonic sorting network across its lanes.  Sorting
+// several registers sorts each one, and then repeatedly merges pairs of
+// sorted groups:  reversing the second group makes the pair bitonic, and a
+// bitonic merge cleans it up, first across registers, then across lanes.
+//
+// Merging two sorted blocks streams them through a pair of registers.  Each
+// step merges the registers with the same bitonic network, stores the low
+// half, and refills it from whichever block has the smaller next key.
+
+// Returns the lanes of a bitonic sorting step that keep the smaller key.
+// Step 'd' compares lane i with lane i ^ d, within sorted runs of 'k' lanes
+// that alternate ascending and descending.  When 'k' is at least the number
+// of lanes, everything is ascending.
+static inline unsigned take_min_lanes(const int lanes, const int k,
+                                      const int d) {
+  unsigned bits = 0;
+  for (int i = 0; i < lanes; ++i) {
+    if (!(i & d) == !(i & k)) {
+      bits |= 1u << i;
+    }
+  }
+  return bits;
+}
+
+// -------------------------------------------------------------------------
+//  Scalar kernels.
+// -------------------------------------------------------------------------
+
+// Sorts a block with a straight insertion sort.
+static void scalar_sort_network(int64_t *const key, uintptr_t *const val,
+                                const size_t length) {
+  for (size_t i = 1; i < length; ++i) {
+    const int64_t ins_key = key[i];
+    const uintptr_t ins_val = val[i];
+    size_t j = i;
+    while (j > 0 && ins_key < key[j - 1]) {
+      key[j] = key[j - 1];
+      val[j] = val[j - 1];
+      j--;
+    }
+    key[j] = ins_key;
+    val[j] = ins_val;
+  }
+}
+
+// Merges two sorted blocks with a plain two-finger merge.
+static void scalar_merge(const int64_t *const key_a,
+                         const uintptr_t *const val_a, const size_t length_a,
+                         const int64_t *const key_b,
+                         const uintptr_t *const val_b, const size_t length_b,
+                         int64_t *const key_out, uintptr_t *const val_out) {
+  size_t ia = 0, ib = 0, io = 0;
+  while (ia < length_a && ib < length_b) {
+    if (key_b[ib] < key_a[ia]) {
+      key_out[io] = key_b[ib];
+      val_out[io++] = val_b[ib++];
+    } else {
+      key_out[io] = key_a[ia];
+      val_out[io++] = val_a[ia++];
+    }
+  }
+  while (ia < length_a) {
+    key_out[io] = key_a[ia];
+    val_out[io++] = val_a[ia++];
+  }
+  while (ib < length_b) {
+    key_out[io] = key_b[ib];
+    val_out[io++] = val_b[ib++];
+  }
+}
+
+#ifdef SIMD_SORT_X86
+// -------------------------------------------------------------------------
+//  AVX2 kernels:  4 keys per register.
+// -------------------------------------------------------------------------
+
+// Returns a mask with all-ones in the lanes selected by 'bits'.
+TARGET_AVX2 static inline __m256i avx2_lane_mask(const unsigned bits) {
+  return _mm256_setr_epi64x(-(int64_t)(bits & 1), -(int64_t)(bits >> 1 & 1),
+                            -(int64_t)(bits >> 2 & 1),
+                            -(int64_t)(bits >> 3 & 1));
+}
+
+// Returns the register with lane i moved to lane i ^ d.  AVX2 only permutes
+// 64-bit lanes by an immediate, so permute 32-bit halves instead.
+TARGET_AVX2 static inline __m256i avx2_xor_lanes(const __m256i x,
+                                                 const int d) {
+  const __m256i perm = _mm256_xor_si256(_mm256_setr_epi32(0, 1, 2, 3,
+                                                          4, 5, 6, 7),
+                                        _mm256_set1_epi32(2 * d));
+  return _mm256_permutevar8x32_epi32(x, perm);
+}
+
+// Compare-exchanges lane i with lane i ^ d.  Lanes in 'take_min' keep the
+// smaller key; the others keep the larger.
+TARGET_AVX2 static inline void avx2_lane_cx(__m256i *const k,
+                                            __m256i *const v,
+                                            const int d,
+                                            const unsigned take_min) {
+  const __m256i pk = avx2_xor_lanes(*k, d);
+  const __m256i pv = avx2_xor_lanes(*v, d);
+  const __m256i gt = _mm256_cmpgt_epi64(*k, pk);
+  const __m256i lt = _mm256_cmpgt_epi64(pk, *k);
+  const __m256i swap = _mm256_blendv_epi8(lt, gt, avx2_lane_mask(take_min));
+  *k = _mm256_blendv_epi8(*k, pk, swap);
+  *v = _mm256_blendv_epi8(*v, pv, swap);
+}
+
+// Sorts the lanes of one register.
+TARGET_AVX2 static inline void avx2_sort_reg(__m256i *const k,
+                                             __m256i *const v) {
+  for (int kk = 2; kk <= 4; kk *= 2) {
+    for (int d = kk / 2; d > 0; d /= 2) {
+      avx2_lane_cx(k, v, d, take_min_lanes(4, kk, d));
+    }
+  }
+}
+
+// Sorts the lanes of a bitonic register.
+TARGET_AVX2 static inline void avx2_cleanup(__m256i *const k,
+                                            __m256i *const v) {
+  for (int d = 2; d > 0; d /= 2) {
+    avx2_lane_cx(k, v, d, take_min_lanes(4, 4, d));
+  }
+}
+
+// Compare-exchanges two registers lane by lane.  'lo' gets the smaller keys.
+TARGET_AVX2 static inline void avx2_reg_cx(__m256i *const lo_k,
+                                           __m256i *const lo_v,
+                                           __m256i *const hi_k,
+                                           __m256i *const hi_v) {
+  const __m256i gt = _mm256_cmpgt_epi64(*lo_k, *hi_k);
+  const __m256i k = *lo_k, v = *lo_v;
+  *lo_k = _mm256_blendv_epi8(k, *hi_k, gt);
+  *lo_v = _mm256_blendv_epi8(v, *hi_v, gt);
+  *hi_k = _mm256_blendv_epi8(*hi_k, k, gt);
+  *hi_v = _mm256_blendv_epi8(*hi_v, v, gt);
+}
+
+// Reverses a group of 'regs' registers, lanes and all.
+TARGET_AVX2 static inline void avx2_reverse(__m256i *const k,
+                                            __m256i *const v,
+                                            const size_t regs) {
+  for (size_t i = 0; i < regs / 2; ++i) {
+    const __m256i tk = k[i], tv = v[i];
+    k[i] = k[regs - 1 - i];
+    v[i] = v[regs - 1 - i];
+    k[regs - 1 - i] = tk;
+    v[regs - 1 - i] = tv;
+  }
+  for (size_t i = 0; i < regs; ++i) {
+    k[i] = avx2_xor_lanes(k[i], 3);
+    v[i] = avx2_xor_lanes(v[i], 3);
+  }
+}
+
+// Sorts 'regs' registers as one sequence.
+TARGET_AVX2 static inline void avx2_sort_regs(__m256i *const k,
+                                              __m256i *const v,
+                                              const size_t regs) {
+  for (size_t r = 0; r < regs; ++r) {
+    avx2_sort_reg(&k[r], &v[r]);
+  }
+  for (size_t s = 1; s < regs; s *= 2) {
+    for (size_t base = 0; base < regs; base += 2 * s) {
+      avx2_reverse(k + base + s, v + base + s, s);
+      for (size_t h = s; h > 0; h /= 2) {
+        for (size_t j = base; j < base + 2 * s; ++j) {
+          if (!((j - base) & h)) {
+            avx2_reg_cx(&k[j], &v[j], &k[j + h], &v[j + h]);
+          }
+        }
+      }
+      for (size_t j = base; j < base + 2 * s; ++j) {
+        avx2_cleanup(&k[j], &v[j]);
+      }
+    }
+  }
+}
+
+// Sorts 'regs' registers' worth of keys in memory.
+TARGET_AVX2 static inline void avx2_network_regs(int64_t *const key,
+                                                 uintptr_t *const val,
+                                                 const size_t regs) {
+  __m256i k[SIMD_SORT_BLOCK / 4], v[SIMD_SORT_BLOCK / 4];
+  for (size_t r = 0; r < regs; ++r) {
+    k[r] = _mm256_loadu_si256((const __m256i *)(key + 4 * r));
+    v[r] = _mm256_loadu_si256((const __m256i *)(val + 4 * r));
+  }
+  avx2_sort_regs(k, v, regs);
+  for (size_t r = 0; r < regs; ++r) {
+    _mm256_storeu_si256((__m256i *)(key + 4 * r), k[r]);
+    _mm256_storeu_si256((__m256i *)(val + 4 * r), v[r]);
+  }
+}
+
+// Sorts 8, 16 or 32 keys.  Spell out each size, so the compiler can unroll
+// the network and keep it in registers.
+TARGET_AVX2 static void avx2_sort_network(int64_t *const key,
+                                          uintptr_t *const val,
+                                          const size_t length) {
+  switch (length) {
+    case 8:  avx2_network_regs(key, val, 2); break;
+    case 16: avx2_network_regs(key, val, 4); break;
+    case 32: avx2_network_regs(key, val, 8); break;
+    default: scalar_sort_network(key, val, length); break;
+  }
+}
+
+// Merges two sorted blocks.  See the comment at the top.
+TARGET_AVX2 static void avx2_merge(const int64_t *const key_a,
+                                   const uintptr_t *const val_a,
+                                   const size_t length_a,
+                                   const int64_t *const key_b,
+                                   const uintptr_t *const val_b,
+                                   const size_t length_b,
+                                   int64_t *key_out, uintptr_t *val_out) {
+  __m256i lo_k = _mm256_loadu_si256((const __m256i *)key_a);
+  __m256i lo_v = _mm256_loadu_si256((const __m256i *)val_a);
+  __m256i hi_k = _mm256_loadu_si256((const __m256i *)key_b);
+  __m256i hi_v = _mm256_loadu_si256((const __m256i *)val_b);
+  size_t ia = 4, ib = 4;
+
+  for (;;) {
+    avx2_reverse(&hi_k, &hi_v, 1);
+    avx2_reg_cx(&lo_k, &lo_v, &hi_k, &hi_v);
+    avx2_cleanup(&lo_k, &lo_v);
+    avx2_cleanup(&hi_k, &hi_v);
+    _mm256_storeu_si256((__m256i *)key_out, lo_k);
+    _mm256_storeu_si256((__m256i *)val_out, lo_v);
+    key_out += 4;
+    val_out += 4;
+
+    if (ia < length_a && (ib == length_b || key_a[ia] <= key_b[ib])) {
+      lo_k = _mm256_loadu_si256((const __m256i *)(key_a + ia));
+      lo_v = _mm256_loadu_si256((const __m256i *)(val_a + ia));
+      ia += 4;
+    } else if (ib < length_b) {
+      lo_k = _mm256_loadu_si256((const __m256i *)(key_b + ib));
+      lo_v = _mm256_loadu_si256((const __m256i *)(val_b + ib));
+      ib += 4;
+    } else {
+      break;
+    }
+  }
+
+  _mm256_storeu_si256((__m256i *)key_out, hi_k);
+  _mm256_storeu_si256((__m256i *)val_out, hi_v);
+}
+
+// -------------------------------------------------------------------------
+//  AVX-512 kernels:  8 keys per register.
+// -------------------------------------------------------------------------
+
+// Returns the register with lane i moved to lane i ^ d.
+TARGET_AVX512 static inline __m512i avx512_xor_lanes(const __m512i x,
+                                                     const int d) {
+  const __m512i perm = _mm512_xor_si512(_mm512_set_epi64(7, 6, 5, 4,
+                                                         3, 2, 1, 0),
+                                        _mm512_set1_epi64(d));
+  return _mm512_permutexvar_epi64(perm, x);
+}
+
+// Compare-exchanges lane i with lane i ^ d.  Lanes in 'take_min' keep the
+// smaller key; the others keep the larger.
+TARGET_AVX512 static inline void avx512_lane_cx(__m512i *const k,
+                                                __m512i *const v,
+                                                const int d,
+                                                const unsigned take_min) {
+  const __m512i pk = avx512_xor_lanes(*k, d);
+  const __m512i pv = avx512_xor_lanes(*v, d);
+  const __mmask8 gt = _mm512_cmpgt_epi64_mask(*k, pk);
+  const __mmask8 lt = _mm512_cmplt_epi64_mask(*k, pk);
+  const __mmask8 swap = (gt & take_min) | (lt & ~take_min);
+  *k = _mm512_mask_blend_epi64(swap, *k, pk);
+  *v = _mm512_mask_blend_epi64(swap, *v, pv);
+}
+
+// Sorts the lanes of one register.
+TARGET_AVX512 static inline void avx512_sort_reg(__m512i *const k,
+                                                 __m512i *const v) {
+  for (int kk = 2; kk <= 8; kk *= 2) {
+    for (int d = kk / 2; d > 0; d /= 2) {
+      avx512_lane_cx(k, v, d, take_min_lanes(8, kk, d));
+    }
+  }
+}
+
+// Sorts the lanes of a bitonic register.
+TARGET_AVX512 static inline void avx512_cleanup(__m512i *const k,
+                                                __m512i *const v) {
+  for (int d = 4; d > 0; d /= 2) {
+    avx512_lane_cx(k, v, d, take_min_lanes(8, 8, d));
+  }
+}
+
+// Compare-exchanges two registers lane by lane.  'lo' gets the smaller keys.
+TARGET_AVX512 static inline void avx512_reg_cx(__m512i *const lo_k,
+                                               __m512i *const lo_v,
+                                               __m512i *const hi_k,
+                                               __m512i *const hi_v) {
+  const __mmask8 gt = _mm512_cmpgt_epi64_mask(*lo_k, *hi_k);
+  const __m512i k = *lo_k, v = *lo_v;
+  *lo_k = _mm512_mask_blend_epi64(gt, k, *hi_k);
+  *lo_v = _mm512_mask_blend_epi64(gt, v, *hi_v);
+  *hi_k = _mm512_mask_blend_epi64(gt, *hi_k, k);
+  *hi_v = _mm512_mask_blend_epi64(gt, *hi_v, v);
+}
+
+// Reverses a group of 'regs' registers, lanes and all.
+TARGET_AVX512 static inline void avx512_reverse(__m512i *const k,
+                                                __m512i *const v,
+                                                const size_t regs) {
+  for (size_t i = 0; i < regs / 2; ++i) {
+    const __m512i tk = k[i], tv = v[i];
+    k[i] = k[regs - 1 - i];
+    v[i] = v[regs - 1 - i];
+    k[regs - 1 - i] = tk;
+    v[regs - 1 - i] = tv;
+  }
+  for (size_t i = 0; i < regs; ++i) {
+    k[i] = avx512_xor_lanes(k[i], 7);
+    v[i] = avx512_xor_lanes(v[i], 7);
+  }
+}
+
+// Sorts 'regs' registers as one sequence.
+TARGET_AVX512 static inline void avx512_sort_regs(__m512i *const k,
+                                                  __m512i *const v,
+                                                  const size_t regs) {
+  for (size_t r = 0; r < regs; ++r) {
+    avx512_sort_reg(&k[r], &v[r]);
+  }
+  for (size_t s = 1; s < regs; s *= 2) {
+    for (size_t base = 0; base < regs; base += 2 * s) {
+      avx512_reverse(k + base + s, v + base + s, s);
+      for (size_t h = s; h > 0; h /= 2) {
+        for (size_t j = base; j < base + 2 * s; ++j) {
+          if (!((j - base) & h)) {
+            avx512_reg_cx(&k[j], &v[j], &k[j + h], &v[j + h]);
+          }
+        }
+      }
+      for (size_t j = base; j < base + 2 * s; ++j) {
+        avx512_cleanup(&k[j], &v[j]);
+      }
+    }
+  }
+}
+
+// Sorts 'regs' registers' worth of keys in memory.
+TARGET_AVX512 static inline void avx512_network_regs(int64_t *const key,
+                                                     uintptr_t *const val,
+                                                     const size_t regs) {
+  __m512i k[SIMD_SORT_BLOCK / 8], v[SIMD_SORT_BLOCK / 8];
+  for (size_t r = 0; r < regs; ++r) {
+    k[r] = _mm512_loadu_si512(key + 8 * r);
+    v[r] = _mm512_loadu_si512(val + 8 * r);
+  }
+  avx512_sort_regs(k, v, regs);
+  for (size_t r = 0; r < regs; ++r) {
+    _mm512_storeu_si512(key + 8 * r, k[r]);
+    _mm512_storeu_si512(val + 8 * r, v[r]);
+  }
+}
+
+// Sorts 8, 16 or 32 keys.  Spell out each size, so the compiler can unroll
+// the network and keep it in registers.
+TARGET_AVX512 static void avx512_sort_network(int64_t *const key,
+                                              uintptr_t *const val,
+                                              const size_t length) {
+  switch (length) {
+    case 8:  avx512_network_regs(key, val, 1); break;
+    case 16: avx512_network_regs(key, val, 2); break;
+    case 32: avx512_network_regs(key, val, 4); break;
+    default: scalar_sort_network(key, val, length); break;
+  }
+}
+
+// Merges two sorted blocks.  See the comment at the top.
+TARGET_AVX512 static void avx512_merge(const int64_t *const key_a,
+                                       const uintptr_t *const val_a,
+                                       const size_t length_a,
+                                       const int64_t *const key_b,
+                                       const uintptr_t *const val_b,
+                                       const size_t length_b,
+                                       int64_t *key_out, uintptr_t *val_out) {
+  __m512i lo_k = _mm512_loadu_si512(key_a);
+  __m512i lo_v = _mm512_loadu_si512(val_a);
+  __m512i hi_k = _mm512_loadu_si512(key_b);
+  __m512i hi_v = _mm512_loadu_si512(val_b);
+  size_t ia = 8, ib = 8;
+
+  for (;;) {
+    avx512_reverse(&hi_k, &hi_v, 1);
+    avx512_reg_cx(&lo_k, &lo_v, &hi_k, &hi_v);
+    avx512_cleanup(&lo_k, &lo_v);
+    avx512_cleanup(&hi_k, &hi_v);
+    _mm512_storeu_si512(key_out, lo_k);
+    _mm512_storeu_si512(val_out, lo_v);
+    key_out += 8;
+    val_out += 8;
+
+    if (ia < length_a && (ib == length_b || key_a[ia] <= key_b[ib])) {
+      lo_k = _mm512_loadu_si512(key_a + ia);
+      lo_v = _mm512_loadu_si512(val_a + ia);
+      ia += 8;
+    } else if (ib < length_b) {
+      lo_k = _mm512_loadu_si512(key_b + ib);
+      lo_v = _mm512_loadu_si512(val_b + ib);
+      ib += 8;
+    } else {
+      break;
+    }
+  }
+
+  _mm512_storeu_si512(key_out, hi_k);
+  _mm512_storeu_si512(val_out, hi_v);
+}
+#endif  // SIMD_SORT_X86
+
+// -------------------------------------------------------------------------
+//  Dispatch.
+// -------------------------------------------------------------------------
+
+typedef void SortNetworkFxn(int64_t *, uintptr_t *, size_t);
+typedef void MergeFxn(const int64_t *, const uintptr_t *, size_t,
+                      const int64_t *, const uintptr_t *, size_t,
+                      int64_t *, uintptr_t *);
+
+typedef struct {
+  const char *name;
+  SortNetworkFxn *sort_network;
+  MergeFxn *merge;
+} SimdKernels;
+
+static const SimdKernels simd_kernels[] = {
+  [SIMD_ISA_SCALAR] = { "scalar", scalar_sort_network, scalar_merge },
+#ifdef SIMD_SORT_X86
+  [SIMD_ISA_AVX2]   = { "avx2",   avx2_sort_network,   avx2_merge   },
+  [SIMD_ISA_AVX512] = { "avx512", avx512_sort_network, avx512_merge },
+#else
+  [SIMD_ISA_AVX2]   = { "avx2",   scalar_sort_network, scalar_merge },
+  [SIMD_ISA_AVX512] = { "avx512", scalar_sort_network, scalar_merge },
+#endif
+};
+
+// The kernels selected by simd_sort_set_isa, or -1 until simd_sort_isa picks
+// the best available.
+static int simd_isa_selected = -1;
+
+// Returns the best instruction set this CPU supports.
+SimdIsa simd_sort_best_isa(void) {
+#ifdef SIMD_SORT_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    return SIMD_ISA_AVX512;
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    return SIMD_ISA_AVX2;
+  }
+#endif
+  return SIMD_ISA_SCALAR;
+}
+
+// Selects the kernels to use, if the CPU supports them.
+bool simd_sort_set_isa(const SimdIsa isa) {
+  if (isa > simd_sort_best_isa()) {
+    return false;
+  }
+  simd_isa_selected = isa;
+  return true;
+}
+
+// Returns the instruction set of the kernels currently in use.  The first
+// call picks the best available if simd_sort_set_isa hasn't picked one, so
+// the sorts don't redo the CPU detection on every call.
+SimdIsa simd_sort_isa(void) {
+  if (simd_isa_selected < 0) {
+    simd_isa_selected = simd_sort_best_isa();
+  }
+  return (SimdIsa)simd_isa_selected;
+}
+
+// Returns a printable name for 'isa'.
+const char *simd_sort_isa_name(const SimdIsa isa) {
+  return simd_kernels[isa].name;
+}
+
+// Parses an instruction set name.
+bool simd_sort_parse_isa(const char *const name, SimdIsa *const isa) {
+  for (size_t i = 0; i < sizeof(simd_kernels) / sizeof(simd_kernels[0]);
+       ++i) {
+    if (!strcmp(name, simd_kernels[i].name)) {
+      *isa = (SimdIsa)i;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Sorts 8, 16 or 32 keys with the current kernels.
+void simd_sort_network(int64_t *const key, uintptr_t *const val,
+                       const size_t length) {
+  simd_kernels[simd_sort_isa()].sort_network(key, val, length);
+}
+
+// Merges two sorted blocks with the current kernels.
+void simd_merge(const int64_t *const key_a, const uintptr_t *const val_a,
+                const size_t length_a,
+                const int64_t *const key_b, const uintptr_t *const val_b,
+                const size_t length_b,
+                int64_t *const key_out, uintptr_t *const val_out) {
+  simd_kernels[simd_sort_isa()].merge(key_a, val_a, length_a,
+                                      key_b, val_b, length_b,
+                                      key_out, val_out);
+}
+
+// Sorts an array of keys and payloads.  See the header for details.
+bool simd_sort_pairs(int64_t *const key, uintptr_t *const val,
+                     int64_t *const key_tmp, uintptr_t *const val_tmp,
+                     const size_t length) {
+  const SimdKernels *const kernels = &simd_kernels[simd_sort_isa()];
+
+  // Initial runs.
+  for (size_t i = 0; i < length; i += SIMD_SORT_BLOCK) {
+    kernels->sort_network(key + i, val + i, SIMD_SORT_BLOCK);
+  }
+
+  // Bottom-up merge passes.  An odd run out at the end of a pass just gets
+  // copied across.
+  int64_t *src_key = key, *dst_key = key_tmp;
+  uintptr_t *src_val = val, *dst_val = val_tmp;
+  bool in_tmp = false;
+  for (size_t width = SIMD_SORT_BLOCK; width < length; width *= 2) {
+    for (size_t i = 0; i < length; i += 2 * width) {
+      const size_t length_a = length - i < width ? length - i : width;
+      const size_t rest = length - i - length_a;
+      const size_t length_b = rest < width ? rest : width;
+      if (length_b == 0) {
+        memcpy(dst_key + i, src_key + i, length_a * sizeof(*dst_key));
+        memcpy(dst_val + i, src_val + i, length_a * sizeof(*dst_val));
+      } else {
+        kernels->merge(src_key + i, src_val + i, length_a,
+                       src_key + i + length_a, src_val + i + length_a,
+                       length_b, dst_key + i, dst_val + i);
+      }
+    }
+
+    int64_t *const t_key = src_key;
+    uintptr_t *const t_val = src_val;
+    src_key = dst_key;
+    src_val = dst_val;
+    dst_key = t_key;
+    dst_val = t_val;
+    in_tmp = !in_tmp;
+  }
+
+  return in_tmp;
+}
@@ -0,0 +1,66 @@
+// Vectorized sorting-network and merge kernels for arrays of 64-bit keys.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#ifndef SIMD_SORT_H_
+#define SIMD_SORT_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// The kernels sort signed 64-bit keys.  Each key carries a pointer-sized
+// payload in a parallel array, which moves with it.  Equal keys may come out
+// in any order.
+
+// The instruction sets the kernels come in.  One binary carries all of them,
+// and picks one at run time.
+typedef enum {
+  SIMD_ISA_SCALAR,
+  SIMD_ISA_AVX2,
+  SIMD_ISA_AVX512,
+} SimdIsa;
+
+// The largest block the sorting networks sort.  simd_sort_pairs requires
+// lengths that are a multiple of this.
+#define SIMD_SORT_BLOCK (32)
+
+// Returns the best instruction set this CPU supports.
+SimdIsa simd_sort_best_isa(void);
+
+// Selects the kernels to use.  Returns false, changing nothing, if the CPU
+// doesn't support 'isa'.  The default is simd_sort_best_isa().
+bool simd_sort_set_isa(SimdIsa isa);
+
+// Returns the instruction set of the kernels currently in use.
+SimdIsa simd_sort_isa(void);
+
+// Returns a printable name for 'isa'.  Also the name simd_sort_parse_isa
+// accepts.
+const char *simd_sort_isa_name(SimdIsa isa);
+
+// Parses an instruction set name.  Returns false if 'name' isn't one.
+bool simd_sort_parse_isa(const char *name, SimdIsa *isa);
+
+// Sorts 'length' keys and their payloads in place with an in-register
+// sorting network.  'length' must be 8, 16 or 32.
+void simd_sort_network(int64_t *key, uintptr_t *val, size_t length);
+
+// Merges two sorted blocks into 'key_out' and 'val_out', with a bitonic
+// merge network.  'length_a' and 'length_b' must be nonzero multiples of 8.
+// The output must not overlap either input.
+void simd_merge(const int64_t *key_a, const uintptr_t *val_a,
+                size_t length_a,
+                const int64_t *key_b, const uintptr_t *val_b,
+                size_t length_b,
+                int64_t *key_out, uintptr_t *val_out);
+
+// Sorts 'length' keys and their payloads.  Forms sorted runs of
+// SIMD_SORT_BLOCK keys with the sorting networks, then merges them in
+// bottom-up passes, ping-ponging between the arrays and the 'tmp' arrays.
+// 'length' must be a multiple of SIMD_SORT_BLOCK.  Returns true if the sorted
+// result ended up in the 'tmp' arrays.
+bool simd_sort_pairs(int64_t *key, uintptr_t *val,
+                     int64_t *key_tmp, uintptr_t *val_tmp, size_t length);
+
+#endif  // SIMD_SORT_H_
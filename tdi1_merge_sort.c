@@ -6,6 +6,8 @@
 
 #include <stddef.h>
 
+#include "list_instrument.h"
+
 // Implements a top-down iterative list merge sort with O(1) auxillary storage,
 // from Drew Eckhardt's post here:
 // https://www.quora.com/What-is-the-best-way-to-sort-an-unsorted-linked-list/answers/3873494
@@ -18,10 +20,13 @@ static ListNode *split_after(ListNode *in, size_t count) {
   ListNode *rest, **prev;
 
   for (i = 0, rest = in, prev = NULL; rest && i < count;
-      ++i, prev = &rest->next, rest = rest->next) { }
+      ++i, prev = &rest->next, rest = rest->next) {
+    LIST_COUNT_VISIT();
+  }
 
   if (prev) {
     *prev = NULL;
+    LIST_COUNT_LINK();
   }
 
   return rest;
@@ -53,6 +58,9 @@ ListNode *tdi1_merge_sort(ListNode *const src, ListNodeCompareFxn *cmp) {
         (*out_tail)->next = NULL;
         out_tail = &(*out_tail)->next;
         ++size;
+        LIST_COUNT_VISIT();
+        LIST_COUNT_LINK();
+        LIST_COUNT_LINK();
       }
     }
 
@@ -9,6 +9,8 @@
 
 #include <stddef.h>
 
+#include "list_instrument.h"
+
 // Implements a top-down iterative list merge sort with O(1) auxillary storage,
 // from Drew Eckhardt's post here:
 // https://www.quora.com/What-is-the-best-way-to-sort-an-unsorted-linked-list/answers/3873494
@@ -23,12 +25,15 @@ ListNode *tdi2_merge_sort(ListNode *const src, ListNodeCompareFxn *const cmp) {
   // Scan once to find our size.
   for (ListNode *n = src; n; n = n->next) {
     size++;
+    LIST_COUNT_VISIT();
   }
+  LIST_COUNT_PASS();
 
   rest = src;
   while (increment < size) {
     out_head = NULL;
     out_tail = &out_head;
+    LIST_COUNT_PASS();
 
     while (rest) {
       size_t ar = increment, br = increment;
@@ -38,12 +43,14 @@ ListNode *tdi2_merge_sort(ListNode *const src, ListNodeCompareFxn *const cmp) {
       // Find the start of 'b'.
       for (size_t i = 0; i < increment && b; ++i) {
         b = b->next;
+        LIST_COUNT_VISIT();
       }
 
       // If 'a' was shorter than increment, just append it and break out.
       if (!b) {
         rest = NULL;
         *out_tail = a;
+        LIST_COUNT_LINK();
         break;
       }
 
@@ -53,6 +60,8 @@ ListNode *tdi2_merge_sort(ListNode *const src, ListNodeCompareFxn *const cmp) {
         *out_tail = *l;
         out_tail = &(*out_tail)->next;
         *l = (*l)->next;
+        LIST_COUNT_LINK();
+        LIST_COUNT_VISIT();
       }
 
       // Push any remaining 'a' nodes.
@@ -61,6 +70,8 @@ ListNode *tdi2_merge_sort(ListNode *const src, ListNodeCompareFxn *const cmp) {
         out_tail = &a->next;
         a = a->next;
         --ar;
+        LIST_COUNT_LINK();
+        LIST_COUNT_VISIT();
       }
 
       // Push any remaining 'b' nodes. 'b' can end early.
@@ -69,10 +80,13 @@ ListNode *tdi2_merge_sort(ListNode *const src, ListNodeCompareFxn *const cmp) {
         out_tail = &b->next;
         b = b->next;
         --br;
+        LIST_COUNT_LINK();
+        LIST_COUNT_VISIT();
       }
 
       // Terminate our partial list.
       *out_tail = NULL;
+      LIST_COUNT_LINK();
 
       // The final advance on 'b' will make it point to 'rest'.
       rest = b;
@@ -7,14 +7,12 @@
 // Quicksort with naive pivot selection.
 #include <stddef.h>
 
+#include "list_instrument.h"
 #include "mt64.h"
 
-typedef struct {
-  ListNode *head;
-  ListNode **tail_next;
-} QuickSortRet;
-
-static QuickSortRet quick_sort_recurse(
+// Sorts a non-empty singly linked list with a naive pivot Quicksort, returning
+// its new head along with the address of its tail's 'next' pointer.
+QuickSortRet tdq1_quick_sort_recurse(
     ListNode *const head, ListNodeCompareFxn *const cmp
 ) {
 # define SORT(x,y)                  \
@@ -22,16 +20,23 @@ static QuickSortRet quick_sort_recurse(
     ListNode *t = x; x = y; y = t;  \
   } while (0)
 
-  const int len = !head->next ? 1
-                : !head->next->next ? 2 
-                : !head->next->next->next ? 3
+  // Look ahead up to 3 nodes, to catch the short lists.
+  ListNode *const second = head->next;
+  ListNode *const third = second ? second->next : NULL;
+  ListNode *const fourth = third ? third->next : NULL;
+  const int len = !second ? 1
+                : !third ? 2
+                : !fourth ? 3
                 : -1;  // "many"
+  for (int i = 0; i < (len < 0 ? 3 : len); ++i) {
+    LIST_COUNT_VISIT();
+  }
 
   // Sorting network for 3 nodes:
   if (len == 3) {
     ListNode *a = head;
-    ListNode *b = a->next;
-    ListNode *c = b->next;
+    ListNode *b = second;
+    ListNode *c = third;
 
     SORT(a, b);
     SORT(a, c);
@@ -40,6 +45,9 @@ static QuickSortRet quick_sort_recurse(
     a->next = b;
     b->next = c;
     c->next = NULL;
+    LIST_COUNT_LINK();
+    LIST_COUNT_LINK();
+    LIST_COUNT_LINK();
 
     const QuickSortRet qsr = { .head = a, .tail_next = &c->next };
     return qsr;
@@ -48,12 +56,14 @@ static QuickSortRet quick_sort_recurse(
   // If we're down to 2 nodes, swap them if needed, and return.
   if (len == 2) {
     ListNode *a = head;
-    ListNode *b = a->next;
+    ListNode *b = second;
 
     SORT(a, b);
 
     a->next = b;
     b->next = NULL;
+    LIST_COUNT_LINK();
+    LIST_COUNT_LINK();
 
     const QuickSortRet qsr = { .head = a, .tail_next = &b->next };
     return qsr;
@@ -67,7 +77,7 @@ static QuickSortRet quick_sort_recurse(
   }
 
   ListNode *const pivot = head;
-  ListNode *node = head->next;
+  ListNode *node = second;
 
   // Partition the elements around the pivot.  Pull as large of a sublist as
   // we can, to minimize the number of cachelines we dirty.
@@ -78,22 +88,27 @@ static QuickSortRet quick_sort_recurse(
     ListNode *const tmp1 = node;
     ListNode *tmp2 = node->next;
     ListNode *ptm2 = tmp1;
+    LIST_COUNT_VISIT();
     if (cmp(tmp1, pivot)) {
       // Pull as large a sublist as we can into less.
       while (tmp2 && cmp(tmp2, pivot)) {
         ptm2 = tmp2;
         tmp2 = tmp2->next;
+        LIST_COUNT_VISIT();
       }
       ptm2->next = less;
       less = tmp1;
+      LIST_COUNT_LINK();
     } else {
       // Pull as large a sublist as we can into more.
       while (tmp2 && !cmp(tmp2, pivot)) {
         ptm2 = tmp2;
         tmp2 = tmp2->next;
+        LIST_COUNT_VISIT();
       }
       ptm2->next = more;
       more = tmp1;
+      LIST_COUNT_LINK();
     }
     node = tmp2;
   }
@@ -102,12 +117,16 @@ static QuickSortRet quick_sort_recurse(
   const QuickSortRet qsm = { .head = NULL, .tail_next = &pivot->next };
   const QuickSortRet qsl = { .head = pivot, .tail_next = &node /* dummy */ };
 
-  const QuickSortRet more_ret = more ? quick_sort_recurse(more, cmp) : qsm;
-  const QuickSortRet less_ret = less ? quick_sort_recurse(less, cmp) : qsl;
+  const QuickSortRet more_ret =
+      more ? tdq1_quick_sort_recurse(more, cmp) : qsm;
+  const QuickSortRet less_ret =
+      less ? tdq1_quick_sort_recurse(less, cmp) : qsl;
 
   // Reconnect them, with the pivot in the middle.
   *less_ret.tail_next = pivot;
   pivot->next = more_ret.head;
+  LIST_COUNT_LINK();
+  LIST_COUNT_LINK();
 
   const QuickSortRet qsr = {
       .head = less_ret.head,
@@ -118,5 +137,5 @@ static QuickSortRet quick_sort_recurse(
 
 // Sorts a singly linked list with a naive pivot Quicksort.
 ListNode *tdq1_quick_sort(ListNode *const head, ListNodeCompareFxn *const cmp) {
-  return quick_sort_recurse(head, cmp).head;
+  return tdq1_quick_sort_recurse(head, cmp).head;
 }
@@ -8,6 +8,18 @@
 #include "list_node.h"
 #include "list_sort.h"
 
+// Holds a sorted list's head, along with the address of its tail's 'next'
+// pointer, so that callers can stitch sorted lists together without walking
+// them.
+typedef struct {
+  ListNode *head;
+  ListNode **tail_next;
+} QuickSortRet;
+
+// Sorts a non-empty singly linked list with a naive pivot Quicksort, returning
+// its new head along with the address of its tail's 'next' pointer.
+QuickSortRet tdq1_quick_sort_recurse(ListNode *head, ListNodeCompareFxn *cmp);
+
 // Sorts a singly linked list with a naive pivot Quicksort.
 ListNode *tdq1_quick_sort(ListNode *const head, ListNodeCompareFxn *const cmp);
 
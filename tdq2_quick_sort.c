@@ -0,0 +1,241 @@
+// Robust linked-list QuickSort.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#include "tdq2_quick_sort.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "bui2_merge_sort.h"
+#include "list_instrument.h"
+
+// Partitions at or below this length get an insertion sort.
+#define INSERTION_CUTOFF (8)
+
+// Partitions at least this long take the ninther of 9 samples, rather than
+// the median of 3.
+#define NINTHER_CUTOFF (128)
+
+// Pivot samples come from the first PREFIX_LENGTH nodes of each partition,
+// until a partition leaves more than all but 1/2^BAD_SPLIT_SHIFT of its nodes
+// on one side.  After that, they come from across each whole partition.
+#define PREFIX_LENGTH (256)
+#define BAD_SPLIT_SHIFT (4)
+
+// Returns the median of three nodes.
+static ListNode *median_of_3(ListNode *const a, ListNode *const b,
+                             ListNode *const c,
+                             ListNodeCompareFxn *const cmp) {
+  if (cmp(a, b)) {
+    return cmp(b, c) ? b : cmp(a, c) ? c : a;
+  } else {
+    return cmp(a, c) ? a : cmp(b, c) ? c : b;
+  }
+}
+
+// Picks a pivot from a list of 'length' nodes by sampling 3 or 9 nodes spread
+// evenly across its first 'span' nodes.
+static ListNode *pick_pivot(ListNode *const head, const size_t length,
+                            const size_t span, ListNodeCompareFxn *const cmp) {
+  const size_t samples = length < NINTHER_CUTOFF ? 3 : 9;
+  ListNode *sample[9];
+
+  ListNode *node = head;
+  size_t pos = 0;
+  for (size_t k = 0; k < samples; ++k) {
+    const size_t want = (2 * k + 1) * span / (2 * samples);
+    while (pos < want) {
+      node = node->next;
+      pos++;
+      LIST_COUNT_VISIT();
+    }
+    sample[k] = node;
+  }
+
+  if (samples == 3) {
+    return median_of_3(sample[0], sample[1], sample[2], cmp);
+  }
+  return median_of_3(median_of_3(sample[0], sample[1], sample[2], cmp),
+                     median_of_3(sample[3], sample[4], sample[5], cmp),
+                     median_of_3(sample[6], sample[7], sample[8], cmp), cmp);
+}
+
+// Sorts a short list by insertion, storing its head in '*link_in' and linking
+// its tail to 'follow'.
+static void insertion_sort(ListNode *node, ListNode **const link_in,
+                           ListNode *const follow,
+                           ListNodeCompareFxn *const cmp) {
+  ListNode *sorted = NULL, *tail = NULL;
+
+  while (node) {
+    ListNode *const next = node->next;
+    LIST_COUNT_VISIT();
+
+    // Appending to the tail is the common case for partly sorted input.
+    if (!tail || !cmp(node, tail)) {
+      node->next = NULL;
+      if (tail) {
+        tail->next = node;
+      } else {
+        sorted = node;
+      }
+      tail = node;
+    } else {
+      ListNode **pnext = &sorted;
+      while (!cmp(node, *pnext)) {
+        pnext = &(*pnext)->next;
+        LIST_COUNT_VISIT();
+      }
+      node->next = *pnext;
+      *pnext = node;
+      LIST_COUNT_LINK();
+    }
+    LIST_COUNT_LINK();
+
+    node = next;
+  }
+
+  *link_in = sorted;
+  tail->next = follow;
+  LIST_COUNT_LINK();
+  LIST_COUNT_LINK();
+}
+
+// Sorts a list of 'length' nodes, storing its head in '*link_in' and linking
+// its tail to 'follow'.  Each pass partitions the list three ways, recurses on
+// the shorter of 'less' and 'more', and loops on the longer.  Samples pivots
+// from each whole partition if 'sample_all' is set.
+static void quick_sort(ListNode *head, size_t length, ListNode **link_in,
+                       ListNode *follow, int depth_limit, bool sample_all,
+                       ListNodeCompareFxn *const cmp) {
+  for (;;) {
+    if (length == 0) {
+      *link_in = follow;
+      LIST_COUNT_LINK();
+      return;
+    }
+
+    if (length <= INSERTION_CUTOFF) {
+      insertion_sort(head, link_in, follow, cmp);
+      return;
+    }
+
+    // Too deep?  The pivots are going badly.  Merge sort what's left.
+    if (depth_limit-- == 0) {
+      ListNode *const sorted = bui2_merge_sort_part(head, cmp);
+      ListNode *tail = sorted;
+      while (tail->next) {
+        tail = tail->next;
+        LIST_COUNT_VISIT();
+      }
+      *link_in = sorted;
+      tail->next = follow;
+      LIST_COUNT_LINK();
+      LIST_COUNT_LINK();
+      return;
+    }
+
+    // Partition the elements three ways around the pivot, which lands in
+    // 'equal'.  Pull as large of a sublist as we can each time, to minimize
+    // the number of cachelines we dirty.
+    const size_t span =
+        sample_all || length < PREFIX_LENGTH ? length : PREFIX_LENGTH;
+    ListNode *const pivot = pick_pivot(head, length, span, cmp);
+    ListNode *less = NULL, *equal = NULL, *more = NULL;
+    ListNode *equal_tail = NULL;
+    size_t less_length = 0, more_length = 0;
+    ListNode *node = head;
+
+    while (node) {
+      ListNode *const tmp1 = node;
+      ListNode *tmp2 = node->next;
+      ListNode *ptm2 = tmp1;
+      LIST_COUNT_VISIT();
+      if (cmp(tmp1, pivot)) {
+        // Pull as large a sublist as we can into less.
+        less_length++;
+        while (tmp2 && cmp(tmp2, pivot)) {
+          ptm2 = tmp2;
+          tmp2 = tmp2->next;
+          LIST_COUNT_VISIT();
+          less_length++;
+        }
+        ptm2->next = less;
+        less = tmp1;
+        LIST_COUNT_LINK();
+      } else if (cmp(pivot, tmp1)) {
+        // Pull as large a sublist as we can into more.
+        more_length++;
+        while (tmp2 && cmp(pivot, tmp2)) {
+          ptm2 = tmp2;
+          tmp2 = tmp2->next;
+          LIST_COUNT_VISIT();
+          more_length++;
+        }
+        ptm2->next = more;
+        more = tmp1;
+        LIST_COUNT_LINK();
+      } else {
+        // Pull as large a sublist as we can into equal.  The first sublist
+        // pulled stays at the tail.
+        while (tmp2 && !cmp(tmp2, pivot) && !cmp(pivot, tmp2)) {
+          ptm2 = tmp2;
+          tmp2 = tmp2->next;
+          LIST_COUNT_VISIT();
+        }
+        if (!equal) {
+          equal_tail = ptm2;
+        }
+        ptm2->next = equal;
+        equal = tmp1;
+        LIST_COUNT_LINK();
+      }
+      node = tmp2;
+    }
+
+    // A prefix that lands the pivot near one end usually means the list is
+    // sorted or nearly so.  Sample the whole partition from here on.
+    const size_t longer = less_length > more_length ? less_length
+                                                    : more_length;
+    if (longer > length - (length >> BAD_SPLIT_SHIFT)) {
+      sample_all = true;
+    }
+
+    // Sort the shorter side now, and loop on the longer.  'equal' sits
+    // between them, already in place.
+    if (less_length < more_length) {
+      quick_sort(less, less_length, link_in, equal, depth_limit, sample_all,
+                 cmp);
+      head = more;
+      length = more_length;
+      link_in = &equal_tail->next;
+    } else {
+      quick_sort(more, more_length, &equal_tail->next, follow, depth_limit,
+                 sample_all, cmp);
+      head = less;
+      length = less_length;
+      follow = equal;
+    }
+  }
+}
+
+// Sorts a singly linked list with a robust Quicksort.  See the header for
+// details.
+ListNode *tdq2_quick_sort(ListNode *const head, ListNodeCompareFxn *const cmp) {
+  size_t length = 0;
+  for (ListNode *node = head; node; node = node->next) {
+    length++;
+    LIST_COUNT_VISIT();
+  }
+
+  // The depth limit is 2 * log2(length).
+  int depth_limit = 0;
+  for (size_t n = length; n > 1; n >>= 1) {
+    depth_limit += 2;
+  }
+
+  ListNode *sorted = NULL;
+  quick_sort(head, length, &sorted, NULL, depth_limit, false, cmp);
+  return sorted;
+}
@@ -0,0 +1,21 @@
+// Robust linked-list QuickSort.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#ifndef TDQ2_QUICK_SORT_H_
+#define TDQ2_QUICK_SORT_H_
+
+#include "list_node.h"
+#include "list_sort.h"
+
+// Sorts a singly linked list with an introsort-style Quicksort.  It picks
+// pivots by sampling a prefix of each partition (median-of-3, or Tukey's
+// ninther for longer partitions), or the whole partition once a prefix has
+// picked a pivot near one end.  It partitions three ways into less, equal
+// and more, pulling whole runs at a time like tdq1_quick_sort.  It recurses
+// into the smaller side and loops on the larger, so its stack depth is
+// O(log n).  Past a depth limit of 2 * log2(n), it finishes the partition with
+// bui2_merge_sort, which bounds the worst case at O(n log n).
+ListNode *tdq2_quick_sort(ListNode *head, ListNodeCompareFxn *cmp);
+
+#endif  // TDQ2_QUICK_SORT_H_
@@ -6,24 +6,29 @@
 
 #include <stddef.h>
 
+#include "list_instrument.h"
+
 // Implements a naive top-down recursive merge sort on a linked list.
 // This version does not try to measure the list length up front to take
 // advantage of it.  It scans the list looking for the midpoint, using
 // two pointers, once of which advances half as fast as the other.
 ListNode *tdr1_merge_sort(ListNode *const head, ListNodeCompareFxn *const cmp) {
   // Degenerate list: return as-is.
-  if (!head || !head->next) {
+  if (!head || !LIST_VISIT_NEXT(head)) {
     return head;
   }
 
   // Two-node list: sort and return.
-  if (!head->next->next) {
+  ListNode *const second = head->next;
+  if (!LIST_VISIT_NEXT(second)) {
     ListNode *const a = head;
-    ListNode *const b = head->next;
+    ListNode *const b = second;
     // Do we need to swap them?
     if (cmp(b, a)) {
       b->next = a;
       a->next = NULL;
+      LIST_COUNT_LINK();
+      LIST_COUNT_LINK();
       return b;
     }
     return head;
@@ -36,9 +41,15 @@ ListNode *tdr1_merge_sort(ListNode *const head, ListNodeCompareFxn *const cmp) {
     pmid = mid;
     mid = mid->next;
     tail = tail->next;
-    tail = tail ? tail->next : NULL;
+    LIST_COUNT_VISIT();
+    LIST_COUNT_VISIT();
+    if (tail) {
+      tail = tail->next;
+      LIST_COUNT_VISIT();
+    }
   }
   pmid->next = NULL;
+  LIST_COUNT_LINK();
 
   // Recursively sort the halves.
   ListNode *a = tdr1_merge_sort(head, cmp);
@@ -51,10 +62,13 @@ ListNode *tdr1_merge_sort(ListNode *const head, ListNodeCompareFxn *const cmp) {
     *pnext = *l;
     pnext = &(*pnext)->next;
     *l = (*l)->next;
+    LIST_COUNT_LINK();
+    LIST_COUNT_VISIT();
   }
 
   // Once we exhaust one list, append the other as-is to the merged list.
   *pnext = a ? a : b;
+  LIST_COUNT_LINK();
 
   // Return the final merged result.
   return merged;
@@ -6,6 +6,8 @@
 
 #include <stddef.h>
 
+#include "list_instrument.h"
+
 // Implements the recursive portion of the top-down recursive sort, taking
 // advantage of the length information computed up-front.
 static ListNode *tdr2_merge_sort_internal(
@@ -22,6 +24,7 @@ static ListNode *tdr2_merge_sort_internal(
   if (length == 2) {
     ListNode *const a = head;
     ListNode *const b = head->next;
+    LIST_COUNT_VISIT();
 
     // Do we need to swap them?
     if (cmp(a, b)) {
@@ -31,6 +34,8 @@ static ListNode *tdr2_merge_sort_internal(
     // Yes.
     b->next = a;
     a->next = NULL;
+    LIST_COUNT_LINK();
+    LIST_COUNT_LINK();
     return b;
   }
 
@@ -40,10 +45,13 @@ static ListNode *tdr2_merge_sort_internal(
 
   for (size_t i = 1; i < len_a; ++i) {
     pmid = pmid->next;
+    LIST_COUNT_VISIT();
   }
 
   ListNode *const mid = pmid->next;
   pmid->next = NULL;
+  LIST_COUNT_VISIT();
+  LIST_COUNT_LINK();
 
   // Recursively sort the halves.
   ListNode *a = tdr2_merge_sort_internal(head, cmp, len_a);
@@ -56,10 +64,13 @@ static ListNode *tdr2_merge_sort_internal(
     *pnext = *l;
     pnext = &(*pnext)->next;
     *l = (*l)->next;
+    LIST_COUNT_LINK();
+    LIST_COUNT_VISIT();
   }
 
   // Once we exhaust one list, append the other as-is to the merged list.
   *pnext = a ? a : b;
+  LIST_COUNT_LINK();
 
   // Return the final merged result.
   return merged;
@@ -76,6 +87,7 @@ ListNode *tdr2_merge_sort(ListNode *const head, ListNodeCompareFxn *const cmp) {
   while (node) {
     length++;
     node = node->next;
+    LIST_COUNT_VISIT();
   }
 
   return tdr2_merge_sort_internal(head, cmp, length);
@@ -8,6 +8,8 @@
 
 #include <stddef.h>
 
+#include "list_instrument.h"
+
 // Implements a naive top-down recursive merge sort on a linked list.
 // This version does not try to measure the list length up front to take
 // advantage of it.  Instead, it partitions nodes into "even/odd" lists,
@@ -16,18 +18,21 @@
 // https://www.quora.com/Which-is-the-best-the-most-efficient-sorting-algorithm-implemented-by-linked-list-Merge-sort-Insertion-sort-heap-sort-or-Quick-sort/answer/David-Vandevoorde?comment_id=217455001&comment_type=2
 ListNode *tdr3_merge_sort(ListNode *const head, ListNodeCompareFxn *const cmp) {
   // Degenerate list: return as-is.
-  if (!head || !head->next) {
+  if (!head || !LIST_VISIT_NEXT(head)) {
     return head;
   }
 
   // Two-node list: sort and return.
-  if (!head->next->next) {
+  ListNode *const second = head->next;
+  if (!LIST_VISIT_NEXT(second)) {
     ListNode *const a = head;
-    ListNode *const b = head->next;
+    ListNode *const b = second;
     // Do we need to swap them?
     if (cmp(b, a)) {
       b->next = a;
       a->next = NULL;
+      LIST_COUNT_LINK();
+      LIST_COUNT_LINK();
       return b;
     }
     return head;
@@ -43,6 +48,8 @@ ListNode *tdr3_merge_sort(ListNode *const head, ListNodeCompareFxn *const cmp) {
     node->next = a;
     a = node;
     node = temp;
+    LIST_COUNT_VISIT();
+    LIST_COUNT_LINK();
 
     if (!node) {
       break;
@@ -52,6 +59,8 @@ ListNode *tdr3_merge_sort(ListNode *const head, ListNodeCompareFxn *const cmp) {
     node->next = b;
     b = node;
     node = temp;
+    LIST_COUNT_VISIT();
+    LIST_COUNT_LINK();
   }
 
   // Recursively sort the halves.
@@ -65,10 +74,13 @@ ListNode *tdr3_merge_sort(ListNode *const head, ListNodeCompareFxn *const cmp) {
     *pnext = *l;
     pnext = &(*pnext)->next;
     *l = (*l)->next;
+    LIST_COUNT_LINK();
+    LIST_COUNT_VISIT();
   }
 
   // Once we exhaust one list, append the other as-is to the merged list.
   *pnext = a ? a : b;
+  LIST_COUNT_LINK();
 
   // Return the final merged result.
   return merged;
@@ -0,0 +1,265 @@
+// Implements a multiway bottom-up merge sort on a linked list, merging many
+// cache-sized runs at a time with a loser tree.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#include "wbi1_merge_sort.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bui2_merge_sort.h"
+#include "list_instrument.h"
+#include "list_prefetch.h"
+
+#define CACHE_LINE_BYTES (64)
+
+// Used when the system doesn't report its cache sizes.
+#define DEFAULT_L1D_BYTES (32 << 10)
+#define DEFAULT_L2_BYTES (256 << 10)
+
+// Most lists have few enough runs to track them on the stack.
+#define LOCAL_RUNS (256)
+
+static size_t wbi1_run_nodes = 4096;
+static int wbi1_ways = 16;
+static int wbi1_distance = LIST_PREFETCH_DEFAULT_DISTANCE;
+
+static int clamp_ways(const int ways) {
+  return ways < 2 ? 2 : ways > WBI1_MAX_WAYS ? WBI1_MAX_WAYS : ways;
+}
+
+// Picks the run length and ways for nodes of 'node_size' bytes.
+void wbi1_merge_sort_tune(const size_t node_size) {
+  const long l1d = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+  const long l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+  const size_t l1d_bytes = l1d > 0 ? (size_t)l1d : DEFAULT_L1D_BYTES;
+  const size_t l2_bytes = l2 > 0 ? (size_t)l2 : DEFAULT_L2_BYTES;
+  const size_t size = node_size ? node_size : 1;
+
+  const size_t run_nodes = l2_bytes / 2 / size;
+  wbi1_run_nodes = run_nodes < 2 ? 2 : run_nodes;
+
+  // Each way keeps its current node and its lookahead nodes in flight.  Leave
+  // half of the L1 for the loser tree, the output's tail and everything else.
+  const size_t node_lines = (size + CACHE_LINE_BYTES - 1) / CACHE_LINE_BYTES;
+  const size_t way_bytes =
+      ((size_t)wbi1_distance + 1) * node_lines * CACHE_LINE_BYTES;
+  int ways = 2;
+  while (ways < WBI1_MAX_WAYS && 2 * ways * way_bytes <= l1d_bytes / 2) {
+    ways *= 2;
+  }
+  wbi1_ways = ways;
+}
+
+// Sets the number of runs wbi1_merge_sort merges at once.
+void wbi1_merge_sort_set_ways(const int ways) {
+  wbi1_ways = clamp_ways(ways);
+}
+
+// Sets the prefetch distance wbi1_merge_sort uses.  Zero turns prefetching
+// off.
+void wbi1_merge_sort_set_distance(const int distance) {
+  wbi1_distance = distance < 0 ? 0 : distance;
+}
+
+size_t wbi1_merge_sort_run_nodes(void) {
+  return wbi1_run_nodes;
+}
+
+int wbi1_merge_sort_ways(void) {
+  return wbi1_ways;
+}
+
+// A tournament over the heads of up to WBI1_MAX_WAYS runs.  Leaf 'i' is run
+// 'i'.  Each internal node 't' remembers the run that lost the match there,
+// and internal node 1 is the root.  Leaves past the last run start out
+// finished.
+typedef struct {
+  int size;                        // The number of leaves, a power of 2.
+  ListNode *cur[WBI1_MAX_WAYS];    // Each run's head, or NULL once it's done.
+  ListNode *ahead[WBI1_MAX_WAYS];  // Each run's lookahead cursor.
+  int loser[WBI1_MAX_WAYS];        // The loser at each internal node.
+} LoserTree;
+
+// Returns true if run 'i's head goes out before run 'j's.  A finished run
+// loses to everything.  On equal keys, the earlier run wins, so the merge is
+// stable.
+static inline bool beats(const LoserTree *const t, const int i, const int j,
+                         ListNodeCompareFxn *const cmp) {
+  const ListNode *const a = t->cur[i];
+  const ListNode *const b = t->cur[j];
+  if (!b) {
+    return true;
+  }
+  if (!a) {
+    return false;
+  }
+  return i < j ? !cmp(b, a) : cmp(a, b);
+}
+
+// Plays the matches in the subtree under 'node', and returns its winner.
+static int build(LoserTree *const t, const int node,
+                 ListNodeCompareFxn *const cmp) {
+  if (node >= t->size) {
+    return node - t->size;
+  }
+  const int a = build(t, 2 * node, cmp);
+  const int b = build(t, 2 * node + 1, cmp);
+  if (beats(t, a, b, cmp)) {
+    t->loser[node] = b;
+    return a;
+  }
+  t->loser[node] = a;
+  return b;
+}
+
+// Merges 'count' sorted, NULL-terminated runs, 2 <= count <= WBI1_MAX_WAYS,
+// into one.  Each node out costs log2(ways) comparisons, replaying only the
+// matches on the winner's path to the root.
+static ListNode *merge_runs(ListNode *const *const runs, const int count,
+                            ListNodeCompareFxn *const cmp,
+                            const int distance) {
+  LoserTree t;
+  t.size = 2;
+  while (t.size < count) {
+    t.size *= 2;
+  }
+  for (int i = 0; i < t.size; ++i) {
+    t.cur[i] = i < count ? runs[i] : NULL;
+    t.ahead[i] = i < count && distance > 0
+               ? list_prefetch_ahead(runs[i], distance) : NULL;
+  }
+
+  int winner = build(&t, 1, cmp);
+  int live = count;
+  ListNode *head = NULL;
+  ListNode **tail = &head;
+
+  // Once only one run is left, it's already sorted and terminated, so just
+  // append it.
+  while (live > 1) {
+    ListNode *const node = t.cur[winner];
+    *tail = node;
+    tail = &node->next;
+    t.cur[winner] = node->next;
+    t.ahead[winner] = list_prefetch_advance(t.ahead[winner]);
+    LIST_COUNT_LINK();
+    LIST_COUNT_VISIT();
+    if (!t.cur[winner]) {
+      --live;
+    }
+
+    for (int n = (winner + t.size) / 2; n; n /= 2) {
+      const int loser = t.loser[n];
+      if (beats(&t, loser, winner, cmp)) {
+        t.loser[n] = winner;
+        winner = loser;
+      }
+    }
+  }
+  *tail = t.cur[winner];
+  LIST_COUNT_LINK();
+  return head;
+}
+
+// Chains 'count' sorted runs and the unsorted 'rest' back into one list, and
+// sorts it with bui2_merge_sort.  For when we can't grow the array of runs.
+static ListNode *fall_back(ListNode *const *const runs, const size_t count,
+                           ListNode *const rest,
+                           ListNodeCompareFxn *const cmp) {
+  ListNode *head = rest;
+  for (size_t i = count; i-- > 0; ) {
+    ListNode *tail = runs[i];
+    while (tail->next) {
+      tail = tail->next;
+      LIST_COUNT_VISIT();
+    }
+    tail->next = head;
+    head = runs[i];
+    LIST_COUNT_LINK();
+  }
+  return bui2_merge_sort_part(head, cmp);
+}
+
+// Sorts the list in passes of multiway merges.  See the header for details.
+ListNode *wbi1_merge_sort_params(ListNode *const head,
+                                 ListNodeCompareFxn *const cmp,
+                                 size_t run_nodes, int ways, int distance) {
+  if (!head || !LIST_VISIT_NEXT(head)) {
+    return head;
+  }
+  run_nodes = run_nodes < 2 ? 2 : run_nodes;
+  ways = clamp_ways(ways);
+  distance = distance < 0 ? 0 : distance;
+
+  // First pass:  cut the list into runs, and sort each one while it's still
+  // in cache.
+  ListNode *local_runs[LOCAL_RUNS];
+  ListNode **runs = local_runs;
+  size_t capacity = LOCAL_RUNS;
+  size_t count = 0;
+  ListNode *rest = head;
+  do {
+    ListNode *const run = rest;
+    ListNode *tail = run;
+    for (size_t i = 1; i < run_nodes && tail->next; ++i) {
+      tail = tail->next;
+      LIST_COUNT_VISIT();
+    }
+    rest = tail->next;
+    LIST_COUNT_VISIT();
+
+    if (count == capacity) {
+      ListNode **const grown =
+          runs == local_runs ? malloc(2 * capacity * sizeof(*runs))
+                             : realloc(runs, 2 * capacity * sizeof(*runs));
+      if (!grown) {
+        ListNode *const sorted = fall_back(runs, count, run, cmp);
+        if (runs != local_runs) {
+          free(runs);
+        }
+        return sorted;
+      }
+      if (runs == local_runs) {
+        memcpy(grown, local_runs, sizeof(local_runs));
+      }
+      runs = grown;
+      capacity *= 2;
+    }
+
+    tail->next = NULL;
+    LIST_COUNT_LINK();
+    runs[count++] = bui2_merge_sort_part(run, cmp);
+  } while (rest);
+  LIST_COUNT_PASS();
+
+  // Each pass after that merges groups of 'ways' runs, and packs the merged
+  // runs at the front of the array.
+  while (count > 1) {
+    size_t merged = 0;
+    for (size_t i = 0; i < count; i += ways) {
+      const size_t group = count - i < (size_t)ways ? count - i : (size_t)ways;
+      runs[merged++] = group > 1
+                     ? merge_runs(&runs[i], (int)group, cmp, distance)
+                     : runs[i];
+    }
+    count = merged;
+    LIST_COUNT_PASS();
+  }
+
+  ListNode *const sorted = runs[0];
+  if (runs != local_runs) {
+    free(runs);
+  }
+  return sorted;
+}
+
+// Same as above, using the settings from wbi1_merge_sort_tune and the setters.
+ListNode *wbi1_merge_sort(ListNode *const head,
+                          ListNodeCompareFxn *const cmp) {
+  return wbi1_merge_sort_params(head, cmp, wbi1_run_nodes, wbi1_ways,
+                                wbi1_distance);
+}
@@ -0,0 +1,51 @@
+// Implements a multiway bottom-up merge sort on a linked list, merging many
+// cache-sized runs at a time with a loser tree.
+//
+// Author:  agent <agent@local>
+// SPDX-License-Identifier:  CC-BY-SA-4.0
+#ifndef WBI1_MERGE_SORT_H_
+#define WBI1_MERGE_SORT_H_
+
+#include <stddef.h>
+
+#include "list_node.h"
+#include "list_sort.h"
+
+// The most runs wbi1_merge_sort merges at once.
+#define WBI1_MAX_WAYS (256)
+
+// Picks the run length and the number of ways for nodes of 'node_size' bytes,
+// from the cache sizes the system reports.  A run fills half the L2 cache.
+// The ways are the largest power of 2 that keeps each way's current node and
+// lookahead nodes in the L1 data cache.  Call it after setting the prefetch
+// distance.  Until then, runs are 4096 nodes and the merges are 16-way.
+void wbi1_merge_sort_tune(size_t node_size);
+
+// Sets the number of runs wbi1_merge_sort merges at once.  Clamped to
+// [2, WBI1_MAX_WAYS].
+void wbi1_merge_sort_set_ways(int ways);
+
+// Sets the prefetch distance, in nodes, wbi1_merge_sort's merges use.  Zero
+// turns prefetching off.  The default is LIST_PREFETCH_DEFAULT_DISTANCE.
+void wbi1_merge_sort_set_distance(int distance);
+
+// Returns the run length and number of ways wbi1_merge_sort uses.
+size_t wbi1_merge_sort_run_nodes(void);
+int wbi1_merge_sort_ways(void);
+
+// Sorts a singly linked list in passes.  The first pass cuts the list into
+// runs of 'run_nodes' nodes, and sorts each with bui2_merge_sort while it's
+// in cache.  Each pass after that merges groups of 'ways' runs with a loser
+// tree, running a lookahead cursor 'distance' nodes ahead along each run.
+// That takes 1 + ceil(log_ways(n / run_nodes)) passes over the list, rather
+// than about log2(n).  Lists of up to 'run_nodes' nodes just get
+// bui2_merge_sort.  The merges keep equal nodes in run order, but
+// bui2_merge_sort doesn't, so the sort isn't stable.  If it can't allocate its
+// array of runs, it falls back to bui2_merge_sort.
+ListNode *wbi1_merge_sort_params(ListNode *head, ListNodeCompareFxn *cmp,
+                                 size_t run_nodes, int ways, int distance);
+
+// Same as above, using the settings from the functions above.
+ListNode *wbi1_merge_sort(ListNode *head, ListNodeCompareFxn *cmp);
+
+#endif  // WBI1_MERGE_SORT_H_